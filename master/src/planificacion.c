@@ -86,6 +86,7 @@ void asignar_query(t_query_completa* query){
     query_ejecucion->archivo_query = strdup(query->archivo_query);
     query_ejecucion->id_query = query->id_query;
     query_ejecucion->program_counter = query->program_counter;
+    query_ejecucion->prioridad = query->prioridad; // Ya con el aging: el Worker la manda en cada operación a Storage
 
     t_buffer* buffer = serializar_query_ejecucion(query_ejecucion);
     t_paquete* paquete = empaquetar_buffer(PAQUETE_QUERY_EJECUCION, buffer);
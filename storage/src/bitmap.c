@@ -8,6 +8,7 @@
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <stdint.h>
 
 // Instancia global
 t_bitmap_storage bitmap_storage = {0};
@@ -123,6 +124,22 @@ int reservar_bloque_libre(void) {
     }
 }
 
+int reservar_rango_libre(int cantidad) {
+    int inicio = -1;
+    pthread_mutex_lock(&bitmap_storage.mutex);
+
+    // El bloque 0 nunca está libre, así que una corrida empieza siempre después de un ocupado
+    int libres_seguidos = 0;
+    for (int i = 0; i < bitmap_storage.cantidad_bloques && inicio == -1; i++) {
+        libres_seguidos = bitarray_test_bit(bitmap_storage.bitarray, i) ? 0 : libres_seguidos + 1;
+        if (libres_seguidos == cantidad) inicio = i - cantidad + 1;
+    }
+    for (int i = 0; inicio != -1 && i < cantidad; i++) bitarray_set_bit(bitmap_storage.bitarray, inicio + i);
+
+    pthread_mutex_unlock(&bitmap_storage.mutex);
+    return inicio;
+}
+
 void liberar_bloque(int bloque) {
     // Validaciones de rango
     if (bloque < 0 || bloque >= bitmap_storage.cantidad_bloques) {
@@ -142,6 +159,100 @@ void liberar_bloque(int bloque) {
     log_debug(logger_storage, "Bitmap: Bloque %d liberado.", bloque);
 }
 
+void liberar_bloques(int* bloques, int cantidad) {
+    // 1. Armar una máscara por palabra de 64 bits (con LSB_FIRST el bloque b es el bit b%8 del byte b/8)
+    size_t cantidad_palabras = (bitmap_storage.size_bytes + 7) / 8;
+    uint64_t* mascaras = calloc(cantidad_palabras, sizeof(uint64_t));
+
+    for (int i = 0; i < cantidad; i++) {
+        if (bloques[i] < 0 || bloques[i] >= bitmap_storage.cantidad_bloques) {
+            log_error(logger_storage, "Intento de liberar bloque inválido: %d", bloques[i]);
+            continue;
+        }
+        mascaras[bloques[i] / 64] |= (uint64_t) 1 << (bloques[i] % 64);
+    }
+
+    // 2. Aplicar las máscaras con un solo lock
+    pthread_mutex_lock(&bitmap_storage.mutex);
+    uint8_t* bytes = (uint8_t*) bitmap_storage.bitarray_data;
+    for (size_t p = 0; p < cantidad_palabras; p++) {
+        if (mascaras[p] == 0) continue;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if ((p + 1) * 8 <= bitmap_storage.size_bytes) {
+            uint64_t palabra;
+            memcpy(&palabra, bytes + p * 8, sizeof(palabra));
+            palabra &= ~mascaras[p];
+            memcpy(bytes + p * 8, &palabra, sizeof(palabra));
+            continue;
+        }
+#endif
+        // Última palabra incompleta (o big endian): de a bytes
+        for (size_t b = 0; b < 8 && p * 8 + b < bitmap_storage.size_bytes; b++) {
+            bytes[p * 8 + b] &= (uint8_t) ~(mascaras[p] >> (b * 8));
+        }
+    }
+    pthread_mutex_unlock(&bitmap_storage.mutex);
+
+    free(mascaras);
+    log_debug(logger_storage, "Bitmap: %d bloques liberados en lote.", cantidad);
+}
+
+bool agrandar_bitmap(int nueva_cantidad) {
+    size_t nuevo_size_bytes = (size_t)(nueva_cantidad + 7) / 8;
+    bool exito = false;
+
+    pthread_mutex_lock(&bitmap_storage.mutex);
+    if (nueva_cantidad <= bitmap_storage.cantidad_bloques) {
+        pthread_mutex_unlock(&bitmap_storage.mutex);
+        return nueva_cantidad == bitmap_storage.cantidad_bloques;
+    }
+
+    // 1. Bajar a disco lo que hay y agrandar el archivo (los bytes nuevos quedan en 0 = libres)
+    msync(bitmap_storage.bitarray_data, bitmap_storage.size_bytes, MS_SYNC);
+    if (ftruncate(bitmap_storage.fd_bitmap, nuevo_size_bytes) == -1) {
+        log_error(logger_storage, "Error agrandando bitmap.bin: %s", strerror(errno));
+        pthread_mutex_unlock(&bitmap_storage.mutex);
+        return false;
+    }
+
+    // 2. Mapear el archivo entero de nuevo antes de soltar el mapeo viejo
+    void* nuevo_mapeo = mmap(NULL, nuevo_size_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, bitmap_storage.fd_bitmap, 0);
+    if (nuevo_mapeo == MAP_FAILED) {
+        log_error(logger_storage, "Error en mmap del bitmap agrandado: %s", strerror(errno));
+        // El archivo más grande no molesta: el mapeo viejo sigue siendo válido
+    } else {
+        munmap(bitmap_storage.bitarray_data, bitmap_storage.size_bytes);
+        bitarray_destroy(bitmap_storage.bitarray);
+
+        // 3. Nuevo bitarray sobre el mapeo nuevo
+        bitmap_storage.bitarray_data = nuevo_mapeo;
+        bitmap_storage.size_bytes = nuevo_size_bytes;
+        bitmap_storage.cantidad_bloques = nueva_cantidad;
+        bitmap_storage.bitarray = bitarray_create_with_mode((char*) nuevo_mapeo, nuevo_size_bytes, LSB_FIRST);
+        msync(nuevo_mapeo, nuevo_size_bytes, MS_SYNC);
+        exito = true;
+    }
+    pthread_mutex_unlock(&bitmap_storage.mutex);
+
+    if (exito) log_info(logger_storage, "Bitmap agrandado: %d bloques, %ld bytes.", nueva_cantidad, nuevo_size_bytes);
+    return exito;
+}
+
+void marcar_bloque_ocupado(int bloque) {
+    if (bloque < 0 || bloque >= bitmap_storage.cantidad_bloques) return;
+
+    pthread_mutex_lock(&bitmap_storage.mutex);
+    bitarray_set_bit(bitmap_storage.bitarray, bloque);
+    pthread_mutex_unlock(&bitmap_storage.mutex);
+}
+
+void sincronizar_bitmap(void) {
+    pthread_mutex_lock(&bitmap_storage.mutex);
+    msync(bitmap_storage.bitarray_data, bitmap_storage.size_bytes, MS_SYNC);
+    pthread_mutex_unlock(&bitmap_storage.mutex);
+}
+
 bool bloque_esta_ocupado(int bloque) {
     if (bloque < 0 || bloque >= bitmap_storage.cantidad_bloques) return false;
 
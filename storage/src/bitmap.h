@@ -25,10 +25,17 @@ void destruir_bitmap(void);
 // Operaciones básicas
 int reservar_bloque_libre(void);
 int buscar_bloque_libre(void);
+// Busca y marca ocupados cantidad bloques libres consecutivos (el primero que entre). Devuelve el primero o -1
+int reservar_rango_libre(int cantidad);
 void marcar_bloque_ocupado(int bloque);
 void liberar_bloque(int bloque);
+// Libera varios bloques tomando el mutex una sola vez (limpia de a palabras de 64 bits)
+void liberar_bloques(int* bloques, int cantidad);
 bool bloque_esta_ocupado(int bloque);
 
+// Crecimiento en caliente: agranda bitmap.bin y lo vuelve a mapear (los bloques nuevos quedan libres)
+bool agrandar_bitmap(int nueva_cantidad);
+
 // Guardar cambios en disco
 void sincronizar_bitmap(void);
 
@@ -0,0 +1,490 @@
+#define _GNU_SOURCE // fallocate (FALLOC_FL_PUNCH_HOLE)
+#include "bloques_fisicos.h"
+#include "fresh_start.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/falloc.h>
+
+// Instancia global (única en el módulo Storage)
+static t_bloques_fisicos bloques_fisicos = { .fd_referencias = -1, .fd_largos = -1 };
+
+// --- Funciones auxiliares ---
+
+static char* path_bloque_archivo(int nro_bloque) {
+    return string_from_format("%s/physical_blocks/block%04d.dat", storage_configs.puntomontaje, nro_bloque);
+}
+
+static char* path_bloque_logico(const char* path_tag, int nro_bloque_logico) {
+    return string_from_format("%s/logical_blocks/%06d.dat", path_tag, nro_bloque_logico);
+}
+
+// Carpeta de segmentos del directorio de datos que le toca al segmento (round-robin)
+static char* path_dir_slabs(int segmento) {
+    char* base = storage_configs.cantidaddirectoriosdatos > 0
+                 ? storage_configs.directoriosdatos[segmento % storage_configs.cantidaddirectoriosdatos]
+                 : storage_configs.puntomontaje;
+    return string_from_format("%s/%s", base, DIR_SLABS);
+}
+
+static off_t offset_en_segmento(int nro_bloque) {
+    return (off_t) (nro_bloque % bloques_fisicos.bloques_por_segmento) * superblock_configs.blocksize;
+}
+
+/**
+ * @brief Si Storage se cayó en medio de un crecimiento, el superblock ya tiene el tamaño
+ * nuevo pero pueden faltar archivos de bloque. Se crean los que falten al final.
+ */
+static void completar_blocks_fisicos(int cantidad) {
+    int primero_faltante = cantidad;
+
+    // Los bloques se crean en orden, así que buscamos desde el final hacia atrás
+    while (primero_faltante > 0) {
+        char* path_bloque = path_bloque_archivo(primero_faltante - 1);
+        bool existe = access(path_bloque, F_OK) == 0;
+        free(path_bloque);
+        if (existe) break;
+        primero_faltante--;
+    }
+    if (primero_faltante < cantidad) {
+        log_warning(logger_storage, "Faltan los bloques físicos %d a %d (crecimiento interrumpido). Se crean.",
+                    primero_faltante, cantidad - 1);
+        if (!crear_blocks_fisicos_rango(primero_faltante, cantidad)) exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Abre (o crea) los segmentos que cubren los bloques [0, cantidad) y les da el
+ * tamaño justo. El último segmento puede quedar más chico. Se llama con el lock en
+ * escritura (o antes de que haya otros hilos).
+ */
+static bool abrir_segmentos(int cantidad) {
+    int bps = bloques_fisicos.bloques_por_segmento;
+    int cantidad_segmentos = (cantidad + bps - 1) / bps;
+
+    bloques_fisicos.fds_segmentos = realloc(bloques_fisicos.fds_segmentos, sizeof(int) * (cantidad_segmentos > 0 ? cantidad_segmentos : 1));
+    bool exito = true;
+
+    for (int s = 0; s < cantidad_segmentos && exito; s++) {
+        if (s >= bloques_fisicos.cantidad_segmentos) {
+            char* path_slabs = path_dir_slabs(s);
+            mkdir(path_slabs, 0777);
+            char* path_segmento = string_from_format("%s/segmento%04d.bin", path_slabs, s);
+            bloques_fisicos.fds_segmentos[s] = open(path_segmento, O_CREAT | O_RDWR, 0664);
+            free(path_segmento);
+            free(path_slabs);
+            if (bloques_fisicos.fds_segmentos[s] == -1) {
+                log_error(logger_storage, "No se pudo abrir el segmento %d: %s", s, strerror(errno));
+                exito = false;
+                break;
+            }
+            bloques_fisicos.cantidad_segmentos = s + 1;
+        }
+
+        // Bloques de este segmento (el último puede estar incompleto)
+        int bloques_en_segmento = cantidad - s * bps < bps ? cantidad - s * bps : bps;
+        off_t tamanio = (off_t) bloques_en_segmento * superblock_configs.blocksize;
+        struct stat st;
+        if (fstat(bloques_fisicos.fds_segmentos[s], &st) == 0 && st.st_size < tamanio) {
+            // Si el FS no soporta fallocate, alcanza con el tamaño
+            if (posix_fallocate(bloques_fisicos.fds_segmentos[s], 0, tamanio) != 0 &&
+                ftruncate(bloques_fisicos.fds_segmentos[s], tamanio) == -1) {
+                log_error(logger_storage, "No se pudo agrandar el segmento %d: %s", s, strerror(errno));
+                exito = false;
+            }
+        }
+    }
+    return exito;
+}
+
+/**
+ * @brief La cantidad de directorios de datos no puede cambiar sin formatear: el segmento s
+ * se busca en el directorio s % n. Al formatear se guarda en el superblock.
+ */
+static bool validar_directorios_datos(bool formatear) {
+    int configurados = storage_configs.cantidaddirectoriosdatos > 0 ? storage_configs.cantidaddirectoriosdatos : 1;
+
+    if (formatear && superblock_configs.cantidaddirectoriosdatos != configurados) {
+        char* cantidad = string_itoa(configurados);
+        config_set_value(superblock_tconfig, "CANTIDAD_DIRECTORIOS_DATOS", cantidad);
+        config_save(superblock_tconfig);
+        free(cantidad);
+        superblock_configs.cantidaddirectoriosdatos = configurados;
+    }
+    if (superblock_configs.cantidaddirectoriosdatos != configurados) {
+        log_error(logger_storage, "El FS se formateó con %d directorios de datos y DIRECTORIOS_DATOS tiene %d. Hay que volver a formatear.",
+                  superblock_configs.cantidaddirectoriosdatos, configurados);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Mapea una tabla uint32_t por bloque (referencias.bin, largos_bloques.bin) con
+ * lugar para cantidad bloques. Lo nuevo queda en cero. Se llama con el lock en escritura.
+ * @param es_nueva Se pone en true si el archivo no existía
+ */
+static bool mapear_tabla(const char* nombre, int* fd, uint32_t** tabla, int cantidad, bool* es_nueva) {
+    size_t tamanio = sizeof(uint32_t) * (cantidad > 0 ? cantidad : 1);
+
+    if (*fd == -1) {
+        char* path_tabla = string_from_format("%s/%s", storage_configs.puntomontaje, nombre);
+        if (es_nueva != NULL) *es_nueva = access(path_tabla, F_OK) != 0;
+        *fd = open(path_tabla, O_CREAT | O_RDWR, 0664);
+        free(path_tabla);
+        if (*fd == -1) return false;
+    }
+    if (ftruncate(*fd, tamanio) == -1) return false;
+
+    uint32_t* nuevo_mapeo = mmap(NULL, tamanio, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+    if (nuevo_mapeo == MAP_FAILED) return false;
+
+    if (*tabla != NULL) {
+        size_t tamanio_anterior = sizeof(uint32_t) * (bloques_fisicos.cantidad_bloques > 0 ? bloques_fisicos.cantidad_bloques : 1);
+        msync(*tabla, tamanio_anterior, MS_SYNC);
+        munmap(*tabla, tamanio_anterior);
+    }
+    *tabla = nuevo_mapeo;
+    return true;
+}
+
+static void desmapear_tabla(int* fd, uint32_t** tabla) {
+    if (*tabla != NULL) {
+        size_t tamanio = sizeof(uint32_t) * (bloques_fisicos.cantidad_bloques > 0 ? bloques_fisicos.cantidad_bloques : 1);
+        msync(*tabla, tamanio, MS_SYNC);
+        munmap(*tabla, tamanio);
+        *tabla = NULL;
+    }
+    if (*fd != -1) close(*fd);
+    *fd = -1;
+}
+
+static bool mapear_tablas(int cantidad, bool formatear) {
+    if (!mapear_tabla(NOMBRE_TABLA_REFERENCIAS, &bloques_fisicos.fd_referencias, &bloques_fisicos.referencias, cantidad, NULL)) {
+        return false;
+    }
+    if (!bloques_fisicos.comprimir) return true;
+
+    bool es_nueva = false;
+    bool primera_vez = bloques_fisicos.largos == NULL;
+    if (!mapear_tabla(NOMBRE_TABLA_LARGOS, &bloques_fisicos.fd_largos, &bloques_fisicos.largos, cantidad, &es_nueva)) {
+        return false;
+    }
+    // Se activó la compresión en un FS con datos: hasta que se reescriban, los bloques ocupan entero
+    if (primera_vez && es_nueva && !formatear) {
+        for (int i = 0; i < cantidad; i++) bloques_fisicos.largos[i] = superblock_configs.blocksize;
+    }
+    return true;
+}
+
+// Bytes a guardar de un bloque: hasta el último distinto de cero
+static int largo_sin_cola_de_ceros(char* bloque, int tamanio) {
+    int largo = tamanio;
+    while (largo > 0 && bloque[largo - 1] == 0) largo--;
+    return largo;
+}
+
+/**
+ * @brief Deja en cero [desde, hasta) del segmento. Si el FS lo soporta hace un agujero
+ * (las páginas enteras dejan de ocupar disco); si no, escribe ceros.
+ */
+static void poner_en_cero(int fd, off_t desde, off_t hasta) {
+    if (hasta <= desde) return;
+    if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, desde, hasta - desde) == 0) return;
+
+    char* ceros = calloc(1, hasta - desde);
+    pwrite(fd, ceros, hasta - desde, desde);
+    free(ceros);
+}
+
+// --- Funciones públicas ---
+
+t_formato_bloques formato_bloques_desde_string(char* formato) {
+    return formato != NULL && strcasecmp(formato, "SLAB") == 0 ? FORMATO_SLAB : FORMATO_ARCHIVOS;
+}
+
+bool compresion_desde_string(char* compresion) {
+    return compresion != NULL && strcasecmp(compresion, "COLA_CEROS") == 0;
+}
+
+t_formato_bloques formato_bloques_actual() {
+    return bloques_fisicos.formato;
+}
+
+void inicializar_bloques_fisicos(t_formato_bloques formato, int cantidad_bloques, bool formatear) {
+    pthread_rwlock_init(&bloques_fisicos.lock, NULL);
+    bloques_fisicos.formato = formato;
+    bloques_fisicos.comprimir = compresion_desde_string(superblock_configs.compresion);
+
+    if (formato == FORMATO_ARCHIVOS) {
+        if (storage_configs.cantidaddirectoriosdatos > 0) {
+            log_warning(logger_storage, "DIRECTORIOS_DATOS no se usa en el formato ARCHIVOS (los hard links no cruzan filesystems).");
+        }
+        if (formatear) {
+            if (!crear_blocks_fisicos_rango(0, cantidad_bloques)) exit(EXIT_FAILURE);
+        } else {
+            completar_blocks_fisicos(cantidad_bloques);
+        }
+        bloques_fisicos.cantidad_bloques = cantidad_bloques;
+        return;
+    }
+
+    // SLAB: al menos un bloque por segmento
+    int tamanio_segmento = superblock_configs.tamaniosegmento > 0 ? superblock_configs.tamaniosegmento : TAMANIO_SEGMENTO_DEFAULT;
+    bloques_fisicos.bloques_por_segmento = tamanio_segmento / superblock_configs.blocksize;
+    if (bloques_fisicos.bloques_por_segmento < 1) bloques_fisicos.bloques_por_segmento = 1;
+
+    if (!validar_directorios_datos(formatear)) exit(EXIT_FAILURE);
+
+    // Los segmentos faltantes o cortos (crecimiento interrumpido) se completan acá mismo
+    if (!abrir_segmentos(cantidad_bloques) || !mapear_tablas(cantidad_bloques, formatear)) {
+        log_error(logger_storage, "No se pudieron preparar los segmentos de bloques físicos.");
+        exit(EXIT_FAILURE);
+    }
+    bloques_fisicos.cantidad_bloques = cantidad_bloques;
+    if (formatear) {
+        memset(bloques_fisicos.referencias, 0, sizeof(uint32_t) * cantidad_bloques);
+        if (bloques_fisicos.comprimir) memset(bloques_fisicos.largos, 0, sizeof(uint32_t) * cantidad_bloques);
+    }
+
+    log_info(logger_storage, "Bloques físicos en formato SLAB: %d bloques en %d segmentos de %d bloques (%d directorios de datos).",
+             cantidad_bloques, bloques_fisicos.cantidad_segmentos, bloques_fisicos.bloques_por_segmento,
+             superblock_configs.cantidaddirectoriosdatos);
+    if (bloques_fisicos.comprimir) {
+        uint64_t bytes_guardados = 0;
+        for (int i = 0; i < cantidad_bloques; i++) bytes_guardados += bloques_fisicos.largos[i];
+        log_info(logger_storage, "Compresión de colas en cero: %lu de %lu bytes guardados.",
+                 (unsigned long) bytes_guardados, (unsigned long) cantidad_bloques * superblock_configs.blocksize);
+    }
+}
+
+void destruir_bloques_fisicos() {
+    pthread_rwlock_wrlock(&bloques_fisicos.lock);
+    if (bloques_fisicos.formato == FORMATO_SLAB) {
+        for (int s = 0; s < bloques_fisicos.cantidad_segmentos; s++) {
+            fdatasync(bloques_fisicos.fds_segmentos[s]);
+            close(bloques_fisicos.fds_segmentos[s]);
+        }
+        free(bloques_fisicos.fds_segmentos);
+        bloques_fisicos.fds_segmentos = NULL;
+        bloques_fisicos.cantidad_segmentos = 0;
+
+        desmapear_tabla(&bloques_fisicos.fd_referencias, &bloques_fisicos.referencias);
+        desmapear_tabla(&bloques_fisicos.fd_largos, &bloques_fisicos.largos);
+    }
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+    pthread_rwlock_destroy(&bloques_fisicos.lock);
+}
+
+void bloques_fisicos_borrar_segmentos() {
+    fs_borrar_directorio(DIR_SLABS);
+    for (int i = 0; i < storage_configs.cantidaddirectoriosdatos; i++) {
+        fs_borrar_directorio_en(storage_configs.directoriosdatos[i], DIR_SLABS);
+    }
+}
+
+bool bloques_fisicos_agrandar(int nueva_cantidad) {
+    int cantidad_actual = bloques_fisicos.cantidad_bloques;
+    if (nueva_cantidad <= cantidad_actual) return true;
+
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) {
+        if (!crear_blocks_fisicos_rango(cantidad_actual, nueva_cantidad)) return false;
+        bloques_fisicos.cantidad_bloques = nueva_cantidad;
+        return true;
+    }
+
+    pthread_rwlock_wrlock(&bloques_fisicos.lock);
+    bool exito = abrir_segmentos(nueva_cantidad) && mapear_tablas(nueva_cantidad, false);
+    if (exito) bloques_fisicos.cantidad_bloques = nueva_cantidad;
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+    return exito;
+}
+
+bool bloque_fisico_leer(int nro_bloque, void* destino, bool es_prefetch) {
+    int tamanio = superblock_configs.blocksize;
+    memset(destino, 0, tamanio);
+
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) {
+        char* path_bloque = path_bloque_archivo(nro_bloque);
+        int fd = open(path_bloque, O_RDONLY);
+        free(path_bloque);
+        if (fd == -1) return false;
+
+        if (es_prefetch) posix_fadvise(fd, 0, tamanio, POSIX_FADV_WILLNEED);
+        bool exito = pread(fd, destino, tamanio, 0) >= 0;
+        close(fd);
+        return exito;
+    }
+
+    pthread_rwlock_rdlock(&bloques_fisicos.lock);
+    bool exito = false;
+    if (nro_bloque >= 0 && nro_bloque < bloques_fisicos.cantidad_bloques) {
+        int fd = bloques_fisicos.fds_segmentos[nro_bloque / bloques_fisicos.bloques_por_segmento];
+        off_t offset = offset_en_segmento(nro_bloque);
+        // Con compresión se lee solo lo guardado: el resto ya quedó en cero
+        int a_leer = bloques_fisicos.comprimir ? (int) __atomic_load_n(&bloques_fisicos.largos[nro_bloque], __ATOMIC_RELAXED) : tamanio;
+        if (a_leer > tamanio) a_leer = tamanio;
+        if (es_prefetch && a_leer > 0) posix_fadvise(fd, offset, a_leer, POSIX_FADV_WILLNEED);
+        exito = a_leer == 0 || pread(fd, destino, a_leer, offset) >= 0;
+    }
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+    return exito;
+}
+
+bool bloque_fisico_escribir(int nro_bloque, void* contenido, int tamano_contenido, bool sincronizar) {
+    int tamanio = superblock_configs.blocksize;
+
+    // Siempre se escribe el bloque entero: lo que sobra queda en cero
+    char* buffer_bloque = calloc(1, tamanio);
+    memcpy(buffer_bloque, contenido, tamano_contenido < tamanio ? tamano_contenido : tamanio);
+    bool exito = false;
+
+    int largo = bloques_fisicos.comprimir ? largo_sin_cola_de_ceros(buffer_bloque, tamanio) : tamanio;
+
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) {
+        char* path_bloque = path_bloque_archivo(nro_bloque);
+        int fd = open(path_bloque, O_RDWR);
+        if (fd == -1) {
+            log_error(logger_storage, "WRITE_HELPER: No se pudo abrir %s", path_bloque);
+        } else {
+            // Con compresión el archivo queda del largo guardado (al leer, lo que falta es cero)
+            exito = pwrite(fd, buffer_bloque, largo, 0) == largo && ftruncate(fd, largo) == 0;
+            if (sincronizar) fdatasync(fd);
+            close(fd);
+        }
+        free(path_bloque);
+    } else {
+        pthread_rwlock_rdlock(&bloques_fisicos.lock);
+        if (nro_bloque >= 0 && nro_bloque < bloques_fisicos.cantidad_bloques) {
+            int fd = bloques_fisicos.fds_segmentos[nro_bloque / bloques_fisicos.bloques_por_segmento];
+            off_t offset = offset_en_segmento(nro_bloque);
+
+            if (!bloques_fisicos.comprimir) {
+                exito = pwrite(fd, buffer_bloque, tamanio, offset) == tamanio;
+            } else {
+                // Mientras se escribe, el largo de la tabla cubre lo viejo y lo nuevo: una
+                // lectura nunca corta datos que todavía están en disco
+                uint32_t largo_anterior = bloques_fisicos.largos[nro_bloque];
+                if ((uint32_t) largo > largo_anterior) __atomic_store_n(&bloques_fisicos.largos[nro_bloque], largo, __ATOMIC_RELAXED);
+
+                exito = largo == 0 || pwrite(fd, buffer_bloque, largo, offset) == largo;
+                poner_en_cero(fd, offset + largo, offset + (largo_anterior > (uint32_t) tamanio ? tamanio : largo_anterior));
+                __atomic_store_n(&bloques_fisicos.largos[nro_bloque], largo, __ATOMIC_RELAXED);
+            }
+            if (sincronizar) fdatasync(fd);
+        }
+        pthread_rwlock_unlock(&bloques_fisicos.lock);
+    }
+
+    free(buffer_bloque);
+    return exito;
+}
+
+bool bloque_fisico_preparar(int nro_bloque) {
+    if (bloques_fisicos.formato == FORMATO_SLAB) {
+        // Los segmentos ya tienen lugar para todos los bloques
+        return nro_bloque >= 0 && nro_bloque < bloques_fisicos.cantidad_bloques;
+    }
+
+    char* path_bloque = path_bloque_archivo(nro_bloque);
+    int fd = open(path_bloque, O_RDWR | O_CREAT, 0666);
+    free(path_bloque);
+    if (fd == -1) return false;
+
+    // Aseguramos el tamaño
+    ftruncate(fd, superblock_configs.blocksize);
+    close(fd);
+    return true;
+}
+
+int bloque_fisico_referencias(int nro_bloque) {
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) {
+        char* path_bloque = path_bloque_archivo(nro_bloque);
+        struct stat st;
+        int resultado = stat(path_bloque, &st);
+        free(path_bloque);
+        // Uno de los links es el propio archivo en /physical_blocks
+        return resultado == 0 ? (int) st.st_nlink - 1 : -1;
+    }
+
+    pthread_rwlock_rdlock(&bloques_fisicos.lock);
+    int referencias = nro_bloque >= 0 && nro_bloque < bloques_fisicos.cantidad_bloques
+                      ? (int) __atomic_load_n(&bloques_fisicos.referencias[nro_bloque], __ATOMIC_RELAXED) : -1;
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+    return referencias;
+}
+
+bool bloque_fisico_enlazar(int nro_bloque, const char* path_tag, int nro_bloque_logico) {
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) {
+        char* path_fisico = path_bloque_archivo(nro_bloque);
+        char* path_logico = path_bloque_logico(path_tag, nro_bloque_logico);
+        bool exito = link(path_fisico, path_logico) == 0;
+        free(path_fisico); free(path_logico);
+        return exito;
+    }
+
+    pthread_rwlock_rdlock(&bloques_fisicos.lock);
+    bool exito = nro_bloque >= 0 && nro_bloque < bloques_fisicos.cantidad_bloques;
+    if (exito) __atomic_add_fetch(&bloques_fisicos.referencias[nro_bloque], 1, __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+    return exito;
+}
+
+bool bloque_fisico_desenlazar(int nro_bloque, const char* path_tag, int nro_bloque_logico) {
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) {
+        char* path_logico = path_bloque_logico(path_tag, nro_bloque_logico);
+        bool exito = unlink(path_logico) == 0;
+        free(path_logico);
+        return exito;
+    }
+
+    pthread_rwlock_rdlock(&bloques_fisicos.lock);
+    bool exito = false;
+    if (nro_bloque >= 0 && nro_bloque < bloques_fisicos.cantidad_bloques) {
+        // Nunca por debajo de cero (ej: la tabla quedó vieja después de una caída)
+        uint32_t actual = __atomic_load_n(&bloques_fisicos.referencias[nro_bloque], __ATOMIC_RELAXED);
+        while (actual > 0 && !__atomic_compare_exchange_n(&bloques_fisicos.referencias[nro_bloque], &actual, actual - 1,
+                                                          false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        exito = actual > 0;
+    }
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+    return exito;
+}
+
+bool bloque_fisico_mover_enlace(const char* path_tag_origen, int logico_origen, const char* path_tag_destino, int logico_destino) {
+    // En SLAB la referencia es solo un contador: no hay nada que mover
+    if (bloques_fisicos.formato == FORMATO_SLAB) return true;
+
+    char* path_origen = path_bloque_logico(path_tag_origen, logico_origen);
+    char* path_destino = path_bloque_logico(path_tag_destino, logico_destino);
+    bool exito = rename(path_origen, path_destino) == 0;
+    free(path_origen); free(path_destino);
+    return exito;
+}
+
+void bloques_fisicos_cargar_referencias(uint32_t* referencias, int cantidad) {
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) return;
+
+    pthread_rwlock_wrlock(&bloques_fisicos.lock);
+    int a_copiar = cantidad < bloques_fisicos.cantidad_bloques ? cantidad : bloques_fisicos.cantidad_bloques;
+    memcpy(bloques_fisicos.referencias, referencias, sizeof(uint32_t) * a_copiar);
+    memset(bloques_fisicos.referencias + a_copiar, 0, sizeof(uint32_t) * (bloques_fisicos.cantidad_bloques - a_copiar));
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+    bloques_fisicos_sincronizar();
+}
+
+void bloques_fisicos_sincronizar() {
+    if (bloques_fisicos.formato == FORMATO_ARCHIVOS) return;
+
+    pthread_rwlock_rdlock(&bloques_fisicos.lock);
+    for (int s = 0; s < bloques_fisicos.cantidad_segmentos; s++) fdatasync(bloques_fisicos.fds_segmentos[s]);
+    size_t tamanio_tablas = sizeof(uint32_t) * (bloques_fisicos.cantidad_bloques > 0 ? bloques_fisicos.cantidad_bloques : 1);
+    if (bloques_fisicos.referencias != NULL) msync(bloques_fisicos.referencias, tamanio_tablas, MS_SYNC);
+    if (bloques_fisicos.largos != NULL) msync(bloques_fisicos.largos, tamanio_tablas, MS_SYNC);
+    pthread_rwlock_unlock(&bloques_fisicos.lock);
+}
@@ -0,0 +1,157 @@
+#ifndef STORAGE_BLOQUES_FISICOS_H
+#define STORAGE_BLOQUES_FISICOS_H
+
+#include <commons/string.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+// Carpeta (dentro de cada directorio de datos) con los segmentos del formato SLAB
+#define DIR_SLABS "slabs"
+// Referencias por bloque físico en el formato SLAB (uint32_t[cantidad_bloques])
+#define NOMBRE_TABLA_REFERENCIAS "referencias.bin"
+#define TAMANIO_SEGMENTO_DEFAULT 1048576
+// Largo guardado de cada bloque con COMPRESION=COLA_CEROS en el formato SLAB (uint32_t[cantidad_bloques])
+#define NOMBRE_TABLA_LARGOS "largos_bloques.bin"
+
+/**
+ * @enum t_formato_bloques
+ * @brief Cómo se guardan los bloques físicos en disco (FORMATO_BLOQUES del superblock)
+ *
+ * ARCHIVOS: un archivo por bloque (physical_blocks/blockNNNN.dat) y un hard link por
+ * bloque lógico; las referencias son el nlink.
+ * SLAB: los bloques van empaquetados en segmentos de TAMANIO_SEGMENTO bytes
+ * (slabs/segmentoNNNN.bin) y se direccionan como (segmento, offset). No hay hard links:
+ * las referencias se llevan en referencias.bin.
+ * Con DIRECTORIOS_DATOS los segmentos se reparten en round-robin entre esos directorios
+ * (el segmento s va al directorio s % n): los bloques consecutivos de un segmento quedan
+ * en el mismo disco y el siguiente segmento en el próximo. La metadata, el bitmap y las
+ * tablas siguen en el punto de montaje. En ARCHIVOS no se reparte: los hard links no
+ * cruzan filesystems.
+ */
+typedef enum {
+    FORMATO_ARCHIVOS,
+    FORMATO_SLAB
+} t_formato_bloques;
+
+/**
+ * @struct t_bloques_fisicos
+ * @brief Estado del almacenamiento de bloques físicos
+ *
+ * @param bloques_por_segmento Solo SLAB
+ * @param fds_segmentos Un fd abierto por segmento (solo SLAB)
+ * @param referencias Tabla mapeada de referencias.bin (solo SLAB)
+ * @param comprimir COMPRESION=COLA_CEROS: de cada bloque se guardan solo los bytes hasta
+ * el último distinto de cero. En ARCHIVOS el largo es el tamaño del archivo; en SLAB va en
+ * largos (el resto del bloque en el segmento queda en cero, como un agujero si se puede).
+ * @param largos Tabla mapeada de largos_bloques.bin (solo SLAB con compresión)
+ * @param lock Lo toman en escritura solo el crecimiento del FS y la destrucción (los
+ * prefetch del readahead leen sin lock_fs)
+ */
+typedef struct {
+    t_formato_bloques formato;
+    int cantidad_bloques;
+    int bloques_por_segmento;
+    int* fds_segmentos;
+    int cantidad_segmentos;
+    int fd_referencias;
+    uint32_t* referencias;
+    bool comprimir;
+    int fd_largos;
+    uint32_t* largos;
+    pthread_rwlock_t lock;
+} t_bloques_fisicos;
+
+/**
+ * @brief Traduce FORMATO_BLOQUES ("ARCHIVOS" / "SLAB") al enum.
+ */
+t_formato_bloques formato_bloques_desde_string(char* formato);
+
+/**
+ * @brief Traduce COMPRESION ("NINGUNA" / "COLA_CEROS"): true si hay que comprimir.
+ */
+bool compresion_desde_string(char* compresion);
+
+/**
+ * @brief Devuelve el formato con el que se inicializó el módulo.
+ */
+t_formato_bloques formato_bloques_actual();
+
+/**
+ * @brief Prepara los bloques físicos del FS (la compresión sale de COMPRESION del superblock).
+ *
+ * Con formatear crea todos los bloques vacíos (FRESH_START). Si no, crea los que falten
+ * al final (Storage se cayó mientras el FS crecía) y abre lo que haya.
+ */
+void inicializar_bloques_fisicos(t_formato_bloques formato, int cantidad_bloques, bool formatear);
+
+/**
+ * @brief Baja a disco lo pendiente y cierra segmentos / tabla de referencias.
+ */
+void destruir_bloques_fisicos();
+
+/**
+ * @brief Agrega los bloques [cantidad actual, nueva_cantidad) cuando el FS crece.
+ */
+bool bloques_fisicos_agrandar(int nueva_cantidad);
+
+/**
+ * @brief Lee un bloque completo. Lo que no esté escrito en disco se devuelve en cero.
+ * @param es_prefetch Avisa al kernel que lo vamos a leer (readahead)
+ */
+bool bloque_fisico_leer(int nro_bloque, void* destino, bool es_prefetch);
+
+/**
+ * @brief Sobrescribe un bloque completo: el contenido y el resto en cero.
+ * @param sincronizar Espera a que el dato llegue a disco (las operaciones lo piden siempre)
+ */
+bool bloque_fisico_escribir(int nro_bloque, void* contenido, int tamano_contenido, bool sincronizar);
+
+/**
+ * @brief Se asegura de que el bloque exista en disco antes de usarlo.
+ */
+bool bloque_fisico_preparar(int nro_bloque);
+
+/**
+ * @brief Cantidad de bloques lógicos (incluida la papelera) que apuntan al bloque.
+ * @return -1 si no se pudo averiguar.
+ */
+int bloque_fisico_referencias(int nro_bloque);
+
+/**
+ * @brief Agrega una referencia: el bloque lógico nro_bloque_logico del Tag en path_tag
+ * pasa a apuntar al bloque físico (en ARCHIVOS, el hard link logical_blocks/NNNNNN.dat).
+ */
+bool bloque_fisico_enlazar(int nro_bloque, const char* path_tag, int nro_bloque_logico);
+
+/**
+ * @brief Saca la referencia del bloque lógico al bloque físico.
+ * @return true si había una referencia para sacar.
+ */
+bool bloque_fisico_desenlazar(int nro_bloque, const char* path_tag, int nro_bloque_logico);
+
+/**
+ * @brief Pasa una referencia de un Tag a otro sin que cambie la cantidad
+ * (ej: la cola de un TRUNCATE que va a la papelera).
+ */
+bool bloque_fisico_mover_enlace(const char* path_tag_origen, int logico_origen, const char* path_tag_destino, int logico_destino);
+
+/**
+ * @brief Reemplaza la tabla de referencias (SLAB) con las que salen de la metadata.
+ * Se llama al arrancar, con el escaneo o el checkpoint. En ARCHIVOS no hace nada.
+ */
+void bloques_fisicos_cargar_referencias(uint32_t* referencias, int cantidad);
+
+/**
+ * @brief Borra los segmentos del punto de montaje y de todos los directorios de datos.
+ */
+void bloques_fisicos_borrar_segmentos();
+
+/**
+ * @brief Baja a disco los segmentos y la tabla de referencias.
+ */
+void bloques_fisicos_sincronizar();
+
+#endif
@@ -0,0 +1,292 @@
+#include "cache_bloques.h"
+#include "bloques_fisicos.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// Instancia global de la caché
+static t_cache_bloques cache_bloques = {0};
+static int tam_bloque_cache = 0;
+
+// Tabla de lecturas en vuelo: "nro_bloque" -> t_lectura_en_vuelo*
+static t_dictionary* lecturas_en_vuelo = NULL;
+static pthread_mutex_t mutex_lecturas_en_vuelo = PTHREAD_MUTEX_INITIALIZER;
+
+void inicializar_cache_bloques(int capacidad, int block_size) {
+    cache_bloques.capacidad = capacidad > 0 ? capacidad : 0;
+    cache_bloques.puntero_clock = 0;
+    cache_bloques.generacion = 0;
+    cache_bloques.prefetch_usados = 0;
+    cache_bloques.prefetch_desperdiciados = 0;
+    tam_bloque_cache = block_size;
+    pthread_mutex_init(&cache_bloques.mutex, NULL);
+    lecturas_en_vuelo = dictionary_create();
+
+    if (cache_bloques.capacidad == 0) {
+        log_info(logger_storage, "Caché de bloques desactivada.");
+        return;
+    }
+
+    cache_bloques.indice = dictionary_create();
+    cache_bloques.slots = calloc(cache_bloques.capacidad, sizeof(t_slot_cache));
+    for (int i = 0; i < cache_bloques.capacidad; i++) {
+        cache_bloques.slots[i].nro_bloque = -1;
+        cache_bloques.slots[i].datos = malloc(block_size);
+    }
+
+    log_info(logger_storage, "Caché de bloques inicializada: %d bloques de %d bytes.", capacidad, block_size);
+}
+
+void destruir_cache_bloques() {
+    if (cache_bloques.capacidad > 0) {
+        for (int i = 0; i < cache_bloques.capacidad; i++) {
+            free(cache_bloques.slots[i].datos);
+        }
+        free(cache_bloques.slots);
+        dictionary_destroy(cache_bloques.indice);
+    }
+    dictionary_destroy(lecturas_en_vuelo);
+    pthread_mutex_destroy(&cache_bloques.mutex);
+}
+
+bool cache_activa() {
+    return cache_bloques.capacidad > 0;
+}
+
+// --- Funciones auxiliares (se llaman con el mutex tomado) ---
+
+// Dividimos los contadores a la mitad cada tanto para que pese más lo reciente
+static void decaer_contadores_prefetch() {
+    if (cache_bloques.prefetch_usados + cache_bloques.prefetch_desperdiciados > 1024) {
+        cache_bloques.prefetch_usados /= 2;
+        cache_bloques.prefetch_desperdiciados /= 2;
+    }
+}
+
+static t_slot_cache* buscar_slot(int nro_bloque) {
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%d", nro_bloque);
+    return dictionary_get(cache_bloques.indice, clave);
+}
+
+static void vaciar_slot(t_slot_cache* slot) {
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%d", slot->nro_bloque);
+    dictionary_remove(cache_bloques.indice, clave);
+
+    if (slot->prefetcheado) {
+        cache_bloques.prefetch_desperdiciados++;
+        decaer_contadores_prefetch();
+    }
+    slot->nro_bloque = -1;
+    slot->usado = false;
+    slot->prefetcheado = false;
+}
+
+// CLOCK: avanzamos bajando el bit de uso hasta encontrar un slot libre o no usado
+static t_slot_cache* elegir_slot_victima() {
+    while (1) {
+        t_slot_cache* slot = &cache_bloques.slots[cache_bloques.puntero_clock];
+        cache_bloques.puntero_clock = (cache_bloques.puntero_clock + 1) % cache_bloques.capacidad;
+
+        if (slot->nro_bloque == -1) return slot;
+        if (!slot->usado) {
+            vaciar_slot(slot);
+            return slot;
+        }
+        slot->usado = false;
+    }
+}
+
+// --- Funciones públicas ---
+
+bool cache_leer_bloque(int nro_bloque, void* destino, bool* era_prefetch) {
+    if (era_prefetch) *era_prefetch = false;
+    if (!cache_activa()) return false;
+
+    pthread_mutex_lock(&cache_bloques.mutex);
+    t_slot_cache* slot = buscar_slot(nro_bloque);
+    if (slot == NULL) {
+        pthread_mutex_unlock(&cache_bloques.mutex);
+        return false;
+    }
+
+    memcpy(destino, slot->datos, tam_bloque_cache);
+    slot->usado = true;
+    if (slot->prefetcheado) {
+        slot->prefetcheado = false;
+        cache_bloques.prefetch_usados++;
+        decaer_contadores_prefetch();
+        if (era_prefetch) *era_prefetch = true;
+    }
+    pthread_mutex_unlock(&cache_bloques.mutex);
+
+    return true;
+}
+
+bool cache_contiene_bloque(int nro_bloque) {
+    if (!cache_activa()) return false;
+
+    pthread_mutex_lock(&cache_bloques.mutex);
+    bool esta = buscar_slot(nro_bloque) != NULL;
+    pthread_mutex_unlock(&cache_bloques.mutex);
+    return esta;
+}
+
+unsigned long cache_generacion_actual() {
+    pthread_mutex_lock(&cache_bloques.mutex);
+    unsigned long generacion = cache_bloques.generacion;
+    pthread_mutex_unlock(&cache_bloques.mutex);
+    return generacion;
+}
+
+void cache_insertar_bloque(int nro_bloque, void* datos, bool prefetch, unsigned long generacion_lectura) {
+    if (!cache_activa()) return;
+
+    pthread_mutex_lock(&cache_bloques.mutex);
+
+    // Si alguien escribió o liberó bloques mientras leíamos, lo leído puede estar viejo
+    if (generacion_lectura != cache_bloques.generacion || buscar_slot(nro_bloque) != NULL) {
+        pthread_mutex_unlock(&cache_bloques.mutex);
+        return;
+    }
+
+    t_slot_cache* slot = elegir_slot_victima();
+    memcpy(slot->datos, datos, tam_bloque_cache);
+    slot->nro_bloque = nro_bloque;
+    slot->usado = !prefetch; // Lo prefetcheado es el primero en irse si nadie lo pide
+    slot->prefetcheado = prefetch;
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%d", nro_bloque);
+    dictionary_put(cache_bloques.indice, clave, slot);
+
+    pthread_mutex_unlock(&cache_bloques.mutex);
+}
+
+static void olvidar_lectura_en_vuelo(int nro_bloque);
+
+void cache_invalidar_bloque(int nro_bloque) {
+    olvidar_lectura_en_vuelo(nro_bloque);
+    if (!cache_activa()) return;
+
+    pthread_mutex_lock(&cache_bloques.mutex);
+    cache_bloques.generacion++;
+    t_slot_cache* slot = buscar_slot(nro_bloque);
+    if (slot != NULL) {
+        slot->prefetcheado = false; // No cuenta como desperdicio
+        vaciar_slot(slot);
+    }
+    pthread_mutex_unlock(&cache_bloques.mutex);
+}
+
+bool cache_prefetch_desperdicia() {
+    pthread_mutex_lock(&cache_bloques.mutex);
+    // Recién opinamos cuando hay algo de historia
+    bool desperdicia = cache_bloques.prefetch_desperdiciados > 16 &&
+                       cache_bloques.prefetch_desperdiciados > cache_bloques.prefetch_usados;
+    pthread_mutex_unlock(&cache_bloques.mutex);
+    return desperdicia;
+}
+
+/*/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                                Lecturas de bloques físicos (una por bloque)
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static bool leer_bloque_de_disco(int nro_bloque, void* destino, bool es_prefetch) {
+    usleep(storage_configs.retardoaccesobloque * 1000);
+    return bloque_fisico_leer(nro_bloque, destino, es_prefetch);
+}
+
+// Los pedidos que lleguen después de una escritura tienen que ir a disco de nuevo
+static void olvidar_lectura_en_vuelo(int nro_bloque) {
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%d", nro_bloque);
+
+    pthread_mutex_lock(&mutex_lecturas_en_vuelo);
+    if (lecturas_en_vuelo != NULL) dictionary_remove(lecturas_en_vuelo, clave);
+    pthread_mutex_unlock(&mutex_lecturas_en_vuelo);
+}
+
+// Suelta una referencia a la lectura; el último apaga la luz (se llama con el mutex tomado)
+static void soltar_lectura_en_vuelo(t_lectura_en_vuelo* lectura) {
+    lectura->interesados--;
+    if (lectura->interesados == 0) {
+        pthread_cond_destroy(&lectura->cond_lista);
+        free(lectura->datos);
+        free(lectura);
+    }
+}
+
+bool leer_bloque_fisico(int nro_bloque, void* destino, bool es_prefetch, bool* acierto_cache) {
+    if (acierto_cache) *acierto_cache = false;
+
+    // 1. Caché
+    char* buffer_cache = destino != NULL ? destino : malloc(tam_bloque_cache);
+    bool acierto = es_prefetch ? cache_contiene_bloque(nro_bloque)
+                               : cache_leer_bloque(nro_bloque, buffer_cache, NULL);
+    if (destino == NULL) free(buffer_cache);
+    if (acierto) {
+        if (acierto_cache) *acierto_cache = true;
+        return true;
+    }
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%d", nro_bloque);
+
+    // 2. ¿Alguien ya lo está leyendo? Nos colgamos de su lectura
+    pthread_mutex_lock(&mutex_lecturas_en_vuelo);
+    t_lectura_en_vuelo* lectura = dictionary_get(lecturas_en_vuelo, clave);
+    if (lectura != NULL) {
+        lectura->interesados++;
+        if (!es_prefetch) lectura->pedida_por_demanda = true;
+        while (!lectura->lista) {
+            pthread_cond_wait(&lectura->cond_lista, &mutex_lecturas_en_vuelo);
+        }
+        bool exito = lectura->exito;
+        if (exito && destino != NULL) memcpy(destino, lectura->datos, tam_bloque_cache);
+        soltar_lectura_en_vuelo(lectura);
+        pthread_mutex_unlock(&mutex_lecturas_en_vuelo);
+
+        log_debug(logger_storage, "Bloque Físico %d: lectura compartida con otro pedido en vuelo", nro_bloque);
+        return exito;
+    }
+
+    // 3. Somos los primeros: registramos la lectura y vamos a disco sin el mutex
+    lectura = malloc(sizeof(t_lectura_en_vuelo));
+    lectura->nro_bloque = nro_bloque;
+    lectura->datos = malloc(tam_bloque_cache);
+    lectura->lista = false;
+    lectura->exito = false;
+    lectura->interesados = 1;
+    lectura->pedida_por_demanda = false;
+    pthread_cond_init(&lectura->cond_lista, NULL);
+    dictionary_put(lecturas_en_vuelo, clave, lectura);
+    pthread_mutex_unlock(&mutex_lecturas_en_vuelo);
+
+    unsigned long generacion = cache_generacion_actual();
+    bool exito = leer_bloque_de_disco(nro_bloque, lectura->datos, es_prefetch);
+    if (exito) {
+        pthread_mutex_lock(&mutex_lecturas_en_vuelo);
+        bool como_prefetch = es_prefetch && !lectura->pedida_por_demanda;
+        pthread_mutex_unlock(&mutex_lecturas_en_vuelo);
+
+        cache_insertar_bloque(nro_bloque, lectura->datos, como_prefetch, generacion);
+        if (destino != NULL) memcpy(destino, lectura->datos, tam_bloque_cache);
+    }
+
+    // 4. Despertar a los que esperaban y sacar la lectura de la tabla
+    pthread_mutex_lock(&mutex_lecturas_en_vuelo);
+    lectura->exito = exito;
+    lectura->lista = true;
+    // Si una escritura ya la sacó de la tabla puede haber otra lectura nueva con la misma clave
+    if (dictionary_get(lecturas_en_vuelo, clave) == lectura) dictionary_remove(lecturas_en_vuelo, clave);
+    pthread_cond_broadcast(&lectura->cond_lista);
+    soltar_lectura_en_vuelo(lectura);
+    pthread_mutex_unlock(&mutex_lecturas_en_vuelo);
+
+    return exito;
+}
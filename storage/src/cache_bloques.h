@@ -0,0 +1,147 @@
+#ifndef STORAGE_CACHE_BLOQUES_H
+#define STORAGE_CACHE_BLOQUES_H
+
+#include <commons/string.h>
+#include <commons/collections/dictionary.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+/**
+ * @struct t_slot_cache
+ * @brief Un lugar de la caché de bloques físicos
+ *
+ * @param nro_bloque Bloque físico cargado en el slot (-1 si está libre)
+ * @param datos Contenido del bloque (BLOCK_SIZE bytes)
+ * @param usado Bit de referencia para el reemplazo (CLOCK)
+ * @param prefetcheado Lo cargó el readahead y todavía nadie lo leyó
+ */
+typedef struct {
+    int nro_bloque;
+    char* datos;
+    bool usado;
+    bool prefetcheado;
+} t_slot_cache;
+
+/**
+ * @struct t_cache_bloques
+ * @brief Caché de bloques físicos compartida por todos los Workers
+ *
+ * @param slots Arreglo de slots (capacidad fija)
+ * @param capacidad Cantidad de slots
+ * @param puntero_clock Próximo slot a evaluar para reemplazo
+ * @param indice Diccionario "nro_bloque" -> t_slot_cache*
+ * @param generacion Se incrementa en cada invalidación. Una carga que empezó en una
+ * generación anterior se descarta para no meter contenido viejo en la caché.
+ * @param prefetch_usados Bloques prefetcheados que después se leyeron
+ * @param prefetch_desperdiciados Bloques prefetcheados que se reemplazaron sin leerse
+ */
+typedef struct {
+    t_slot_cache* slots;
+    int capacidad;
+    int puntero_clock;
+    t_dictionary* indice;
+    unsigned long generacion;
+    unsigned long prefetch_usados;
+    unsigned long prefetch_desperdiciados;
+    pthread_mutex_t mutex;
+} t_cache_bloques;
+
+/**
+ * @struct t_lectura_en_vuelo
+ * @brief Lectura de un bloque físico que se está haciendo en este momento
+ *
+ * Si llegan varios pedidos del mismo bloque a la vez, solo el primero va a disco y
+ * el resto espera en cond_lista y copia el mismo buffer.
+ *
+ * @param nro_bloque Bloque físico que se está leyendo
+ * @param datos Buffer compartido con el resultado
+ * @param lista true cuando el que fue a disco terminó
+ * @param exito false si no se pudo leer el bloque
+ * @param interesados Hilos que todavía tienen que copiar el buffer (incluye al que lee)
+ * @param pedida_por_demanda Un READ se colgó de un prefetch: el bloque ya no cuenta como prefetcheado
+ * @param cond_lista Se señaliza cuando la lectura termina
+ */
+typedef struct {
+    int nro_bloque;
+    char* datos;
+    bool lista;
+    bool exito;
+    int interesados;
+    bool pedida_por_demanda;
+    pthread_cond_t cond_lista;
+} t_lectura_en_vuelo;
+
+/**
+ * @brief Inicializa la caché de bloques con la capacidad de la config (CACHE_BLOQUES).
+ * Si la capacidad es 0 la caché queda desactivada y todas las consultas fallan.
+ */
+void inicializar_cache_bloques(int capacidad, int block_size);
+
+/**
+ * @brief Libera la memoria de la caché de bloques.
+ */
+void destruir_cache_bloques();
+
+/**
+ * @brief Indica si la caché está activa.
+ */
+bool cache_activa();
+
+/**
+ * @brief Copia el bloque a destino si está en la caché.
+ * @param nro_bloque Bloque físico buscado.
+ * @param destino Buffer de al menos BLOCK_SIZE bytes.
+ * @param era_prefetch Out-parameter (puede ser NULL): true si el bloque lo había traído el readahead.
+ * @return true si hubo acierto, false si hay que ir a disco.
+ */
+bool cache_leer_bloque(int nro_bloque, void* destino, bool* era_prefetch);
+
+/**
+ * @brief Indica si el bloque ya está cargado (no cuenta como uso).
+ */
+bool cache_contiene_bloque(int nro_bloque);
+
+/**
+ * @brief Devuelve la generación actual. Hay que tomarla ANTES de leer el bloque de disco
+ * y pasarla a cache_insertar_bloque.
+ */
+unsigned long cache_generacion_actual();
+
+/**
+ * @brief Inserta un bloque leído de disco, reemplazando con CLOCK si hace falta.
+ * @param generacion_lectura Generación tomada antes de leer. Si hubo invalidaciones
+ * en el medio, el bloque no se inserta.
+ * @param prefetch true si lo carga el readahead.
+ */
+void cache_insertar_bloque(int nro_bloque, void* datos, bool prefetch, unsigned long generacion_lectura);
+
+/**
+ * @brief Saca un bloque de la caché. Se llama cada vez que se escribe o libera un bloque físico.
+ * Si el bloque se está leyendo, esa lectura queda fuera de la tabla para que los pedidos
+ * nuevos no reciban el contenido viejo.
+ */
+void cache_invalidar_bloque(int nro_bloque);
+
+/**
+ * @brief Lee un bloque físico pasando por la caché y la tabla de lecturas en vuelo.
+ *
+ * Si el bloque está en caché se copia sin retardo. Si otro hilo ya lo está leyendo,
+ * se espera a esa lectura en vez de abrir el archivo de nuevo. Si no, este hilo va a
+ * disco (pagando RETARDO_ACCESO_BLOQUE) y deja el resultado en la caché.
+ *
+ * @param nro_bloque Bloque físico a leer.
+ * @param destino Buffer de BLOCK_SIZE bytes (puede ser NULL si solo se quiere cargar la caché).
+ * @param es_prefetch true si lo pide el readahead (se avisa al kernel con posix_fadvise).
+ * @param acierto_cache Out-parameter (puede ser NULL): true si se sirvió desde la caché.
+ * @return true si se pudo leer, false si el bloque no se pudo abrir.
+ */
+bool leer_bloque_fisico(int nro_bloque, void* destino, bool es_prefetch, bool* acierto_cache);
+
+/**
+ * @brief Indica si el readahead está trayendo más bloques de los que se usan.
+ */
+bool cache_prefetch_desperdicia();
+
+#endif
@@ -0,0 +1,639 @@
+#define _GNU_SOURCE // PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP
+#include "checkpoint.h"
+#include "bitmap.h"
+#include "hash_index.h"
+#include "bloques_fisicos.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <commons/temporal.h>
+
+#define MAX_HILOS_ESCANEO 8
+
+// Instancias globales
+t_estado_fs estado_fs = {0};
+// Con preferencia de escritura: si no, bajo carga constante el checkpoint, el crecimiento,
+// la dedup y el compactador no consiguen nunca el lock (glibc prefiere a los lectores)
+pthread_rwlock_t lock_fs = PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP;
+
+// Estado del archivo en disco y directorios que cambiaron desde el último checkpoint
+// (path -> t_tag_a_escanear*; los protege mutex_sucio)
+static int fd_checkpoint = -1;
+static bool checkpoint_sucio = true;
+static t_dictionary* cambios_pendientes = NULL;
+static pthread_mutex_t mutex_sucio = PTHREAD_MUTEX_INITIALIZER;
+
+// Hilo de checkpoints periódicos
+static pthread_t hilo_periodico;
+static bool periodico_activo = false;
+static pthread_mutex_t mutex_periodico = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_periodico = PTHREAD_COND_INITIALIZER;
+
+static char* path_checkpoint() {
+    return string_from_format("%s/%s", storage_configs.puntomontaje, NOMBRE_CHECKPOINT);
+}
+
+static void destruir_entrada_catalogo(void* elemento) {
+    t_entrada_catalogo* entrada = elemento;
+    free(entrada->nombre_file);
+    free(entrada->nombre_tag);
+    free(entrada->bloques);
+    free(entrada);
+}
+
+static void crear_estado(t_estado_fs* estado, int cantidad_bloques) {
+    estado->catalogo = dictionary_create();
+    estado->papelera = dictionary_create();
+    estado->referencias = calloc(cantidad_bloques, sizeof(uint32_t));
+    estado->cantidad_bloques = cantidad_bloques;
+}
+
+static void destruir_estado(t_estado_fs* estado) {
+    if (estado->catalogo != NULL) dictionary_destroy_and_destroy_elements(estado->catalogo, destruir_entrada_catalogo);
+    if (estado->papelera != NULL) dictionary_destroy_and_destroy_elements(estado->papelera, destruir_entrada_catalogo);
+    free(estado->referencias);
+    estado->catalogo = NULL;
+    estado->papelera = NULL;
+    estado->referencias = NULL;
+}
+
+// Los File:Tags van por "file:tag" y lo de la papelera por el nombre del directorio
+static char* clave_de_entrada(t_entrada_catalogo* entrada, bool en_papelera) {
+    return en_papelera ? string_duplicate(entrada->nombre_tag)
+                       : string_from_format("%s:%s", entrada->nombre_file, entrada->nombre_tag);
+}
+
+static void agregar_al_catalogo(t_estado_fs* estado, t_entrada_catalogo* entrada, bool en_papelera) {
+    char* clave = clave_de_entrada(entrada, en_papelera);
+    dictionary_put(en_papelera ? estado->papelera : estado->catalogo, clave, entrada);
+    free(clave);
+}
+
+// Suma (o resta) una referencia a cada bloque físico de la entrada
+static void sumar_referencias(t_estado_fs* estado, t_entrada_catalogo* entrada, int delta) {
+    for (uint32_t b = 0; b < entrada->cantidad_bloques; b++) {
+        uint32_t nro_bloque = entrada->bloques[b];
+        if (nro_bloque >= (uint32_t) estado->cantidad_bloques) continue;
+        if (delta < 0 && estado->referencias[nro_bloque] == 0) continue;
+        __atomic_add_fetch(&estado->referencias[nro_bloque], delta, __ATOMIC_RELAXED);
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                                Escaneo de files/ (arranque sin checkpoint)
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+/**
+ * @struct t_tag_a_escanear
+ * @brief Directorio con metadata.config a leer (de files/ o de la papelera).
+ */
+typedef struct {
+    char* path;
+    char* nombre_file;
+    char* nombre_tag;
+    bool en_papelera;
+} t_tag_a_escanear;
+
+typedef struct {
+    t_list* tags;
+    int desde_hilo;
+    int cantidad_hilos;
+    t_estado_fs* estado;
+    pthread_mutex_t* mutex_catalogo;
+} t_trabajo_escaneo;
+
+static void destruir_tag_a_escanear(void* elemento) {
+    t_tag_a_escanear* tag = elemento;
+    free(tag->path);
+    free(tag->nombre_file);
+    free(tag->nombre_tag);
+    free(tag);
+}
+
+static t_tag_a_escanear* crear_tag_a_escanear(char* path, char* nombre_file, char* nombre_tag, bool en_papelera) {
+    t_tag_a_escanear* tag = malloc(sizeof(t_tag_a_escanear));
+    tag->path = string_duplicate(path);
+    tag->nombre_file = string_duplicate(nombre_file);
+    tag->nombre_tag = string_duplicate(nombre_tag);
+    tag->en_papelera = en_papelera;
+    return tag;
+}
+
+// Agrega a la lista cada subdirectorio de path (sin "." ni "..")
+static void listar_subdirectorios(char* path, char* nombre_file, bool en_papelera, t_list* destino) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) return;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+        char* path_entrada = string_from_format("%s/%s", path, entry->d_name);
+        list_add(destino, crear_tag_a_escanear(path_entrada, nombre_file != NULL ? nombre_file : entry->d_name,
+                                               entry->d_name, en_papelera));
+        free(path_entrada);
+    }
+    closedir(dir);
+}
+
+/**
+ * @brief Lee el metadata.config del directorio.
+ * @return La entrada (sin sumar referencias), o NULL si el directorio ya no tiene metadata.
+ */
+static t_entrada_catalogo* leer_entrada(t_tag_a_escanear* tag) {
+    char* path_metadata = string_from_format("%s/metadata.config", tag->path);
+    t_config* metadata = config_create(path_metadata);
+    free(path_metadata);
+    if (metadata == NULL) return NULL;
+
+    char** bloques_array = config_get_array_value(metadata, "BLOCKS");
+    int num_bloques = bloques_array != NULL ? string_array_size(bloques_array) : 0;
+
+    t_entrada_catalogo* entrada = malloc(sizeof(t_entrada_catalogo));
+    entrada->nombre_file = string_duplicate(tag->nombre_file);
+    entrada->nombre_tag = string_duplicate(tag->nombre_tag);
+    entrada->commited = config_has_property(metadata, "ESTADO") &&
+                        strcmp(config_get_string_value(metadata, "ESTADO"), "COMMITED") == 0;
+    entrada->tamanio = config_has_property(metadata, "TAMAÑO") ? config_get_int_value(metadata, "TAMAÑO") : 0;
+    entrada->cantidad_bloques = num_bloques;
+    entrada->bloques = malloc(sizeof(uint32_t) * (num_bloques > 0 ? num_bloques : 1));
+    for (int b = 0; b < num_bloques; b++) entrada->bloques[b] = atoi(bloques_array[b]);
+
+    if (bloques_array != NULL) string_array_destroy(bloques_array);
+    config_destroy(metadata);
+    return entrada;
+}
+
+static void* escanear_tags(void* arg) {
+    t_trabajo_escaneo* trabajo = arg;
+
+    for (int i = trabajo->desde_hilo; i < list_size(trabajo->tags); i += trabajo->cantidad_hilos) {
+        t_tag_a_escanear* tag = list_get(trabajo->tags, i);
+        t_entrada_catalogo* entrada = leer_entrada(tag);
+        if (entrada == NULL) continue;
+
+        // Lo de la papelera cuenta como referencia hasta que el reclamador lo libere
+        sumar_referencias(trabajo->estado, entrada, 1);
+        pthread_mutex_lock(trabajo->mutex_catalogo);
+        agregar_al_catalogo(trabajo->estado, entrada, tag->en_papelera);
+        pthread_mutex_unlock(trabajo->mutex_catalogo);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Arma el catálogo y las referencias leyendo todos los metadata.config.
+ * Los directorios se listan en este hilo y los metadata se leen en paralelo.
+ */
+static void escanear_fs_en_paralelo(t_estado_fs* estado) {
+    t_list* tags = list_create();
+
+    char* path_files = string_from_format("%s/files", storage_configs.puntomontaje);
+    t_list* files = list_create();
+    listar_subdirectorios(path_files, NULL, false, files);
+    for (int i = 0; i < list_size(files); i++) {
+        t_tag_a_escanear* file = list_get(files, i);
+        listar_subdirectorios(file->path, file->nombre_file, false, tags);
+    }
+    list_destroy_and_destroy_elements(files, destruir_tag_a_escanear);
+    free(path_files);
+
+    char* path_papelera = string_from_format("%s/papelera", storage_configs.puntomontaje);
+    listar_subdirectorios(path_papelera, "papelera", true, tags);
+    free(path_papelera);
+
+    int cantidad_hilos = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (cantidad_hilos < 1) cantidad_hilos = 1;
+    if (cantidad_hilos > MAX_HILOS_ESCANEO) cantidad_hilos = MAX_HILOS_ESCANEO;
+
+    pthread_mutex_t mutex_catalogo = PTHREAD_MUTEX_INITIALIZER;
+    pthread_t hilos[MAX_HILOS_ESCANEO];
+    t_trabajo_escaneo trabajos[MAX_HILOS_ESCANEO];
+    for (int h = 0; h < cantidad_hilos; h++) {
+        trabajos[h] = (t_trabajo_escaneo) { tags, h, cantidad_hilos, estado, &mutex_catalogo };
+        pthread_create(&hilos[h], NULL, escanear_tags, &trabajos[h]);
+    }
+    for (int h = 0; h < cantidad_hilos; h++) pthread_join(hilos[h], NULL);
+
+    list_destroy_and_destroy_elements(tags, destruir_tag_a_escanear);
+}
+
+/**
+ * @brief Después de una caída el bitmap puede no coincidir con las referencias:
+ * bloques reservados que nunca se linkearon, o liberaciones a medias.
+ */
+static void reconciliar_bitmap(t_estado_fs* estado) {
+    int liberados = 0;
+    int marcados = 0;
+
+    // El bloque 0 es de initial_file y nunca se libera
+    for (int i = 1; i < estado->cantidad_bloques; i++) {
+        bool ocupado = bloque_esta_ocupado(i);
+        if (ocupado && estado->referencias[i] == 0) {
+            liberar_bloque(i);
+            liberados++;
+        } else if (!ocupado && estado->referencias[i] > 0) {
+            marcar_bloque_ocupado(i);
+            marcados++;
+        }
+    }
+    if (liberados > 0 || marcados > 0) {
+        log_warning(logger_storage, "Bitmap reconciliado: %d bloques sin referencias liberados, %d bloques en uso marcados.",
+                    liberados, marcados);
+        sincronizar_bitmap();
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                                        Lectura y escritura del checkpoint
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+/**
+ * @brief Escribe estado_fs y el hash index en checkpoint.bin (temporal + rename).
+ * Hay que llamarla sin operaciones en curso (lock_fs en escritura o en el arranque).
+ */
+static bool guardar_imagen() {
+    char* path = path_checkpoint();
+    char* path_temporal = string_from_format("%s.tmp", path);
+
+    FILE* archivo = fopen(path_temporal, "w");
+    if (archivo == NULL) {
+        log_error(logger_storage, "No se pudo escribir %s: %s", path_temporal, strerror(errno));
+        free(path); free(path_temporal);
+        return false;
+    }
+
+    t_checkpoint_header header = {0};
+    memcpy(header.magia, MAGIA_CHECKPOINT, 4);
+    header.version = VERSION_CHECKPOINT;
+    header.limpio = 1;
+    header.cantidad_bloques = estado_fs.cantidad_bloques;
+    header.block_size = superblock_configs.blocksize;
+    header.cantidad_tags = dictionary_size(estado_fs.catalogo) + dictionary_size(estado_fs.papelera);
+    fwrite(&header, sizeof(header), 1, archivo); // Se reescribe al final con los offsets
+
+    // 1. Referencias
+    fwrite(estado_fs.referencias, sizeof(uint32_t), estado_fs.cantidad_bloques, archivo);
+
+    // 2. Catálogo (primero files/ y después la papelera)
+    header.offset_catalogo = ftell(archivo);
+    for (int en_papelera = 0; en_papelera <= 1; en_papelera++) {
+        t_list* entradas = dictionary_elements(en_papelera ? estado_fs.papelera : estado_fs.catalogo);
+        for (int i = 0; i < list_size(entradas); i++) {
+            t_entrada_catalogo* entrada = list_get(entradas, i);
+            t_registro_catalogo registro = {
+                .largo_file = strlen(entrada->nombre_file),
+                .largo_tag = strlen(entrada->nombre_tag),
+                .commited = entrada->commited,
+                .en_papelera = en_papelera,
+                .tamanio = entrada->tamanio,
+                .cantidad_bloques = entrada->cantidad_bloques
+            };
+            fwrite(&registro, sizeof(registro), 1, archivo);
+            fwrite(entrada->nombre_file, 1, registro.largo_file, archivo);
+            fwrite(entrada->nombre_tag, 1, registro.largo_tag, archivo);
+            fwrite(entrada->bloques, sizeof(uint32_t), entrada->cantidad_bloques, archivo);
+        }
+        list_destroy(entradas);
+    }
+
+    // 3. Hash index
+    header.offset_hashes = ftell(archivo);
+    for (int i = 0; i < estado_fs.cantidad_bloques; i++) {
+        char* hash = hash_index_hash_de_bloque(i);
+        if (hash == NULL) continue;
+
+        t_registro_hash registro = { .nro_bloque = i };
+        strncpy(registro.md5, hash, sizeof(registro.md5));
+        fwrite(&registro, sizeof(registro), 1, archivo);
+        header.cantidad_hashes++;
+        free(hash);
+    }
+
+    fseek(archivo, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, archivo);
+    fflush(archivo);
+    fsync(fileno(archivo));
+    fclose(archivo);
+
+    bool exito = rename(path_temporal, path) == 0;
+    if (exito) {
+        // Nos quedamos con el archivo abierto para poder marcarlo sucio rápido
+        if (fd_checkpoint != -1) close(fd_checkpoint);
+        fd_checkpoint = open(path, O_RDWR);
+        pthread_mutex_lock(&mutex_sucio);
+        checkpoint_sucio = false;
+        pthread_mutex_unlock(&mutex_sucio);
+    }
+
+    free(path); free(path_temporal);
+    return exito;
+}
+
+/**
+ * @brief Mapea checkpoint.bin y carga estado_fs y el hash index.
+ * @return false si no existe, está sucio, está corrupto o no corresponde a este FS.
+ */
+static bool cargar_imagen() {
+    char* path = path_checkpoint();
+    int fd = open(path, O_RDWR);
+    free(path);
+    if (fd == -1) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(t_checkpoint_header)) {
+        close(fd);
+        return false;
+    }
+
+    char* imagen = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (imagen == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    t_checkpoint_header header;
+    memcpy(&header, imagen, sizeof(header));
+    size_t largo_referencias = (size_t) header.cantidad_bloques * sizeof(uint32_t);
+    bool valido = memcmp(header.magia, MAGIA_CHECKPOINT, 4) == 0 &&
+                  header.version == VERSION_CHECKPOINT &&
+                  header.limpio == 1 &&
+                  header.cantidad_bloques == (uint32_t) estado_fs.cantidad_bloques &&
+                  header.block_size == (uint32_t) superblock_configs.blocksize &&
+                  sizeof(header) + largo_referencias <= header.offset_catalogo &&
+                  header.offset_catalogo <= header.offset_hashes &&
+                  header.offset_hashes + (uint64_t) header.cantidad_hashes * sizeof(t_registro_hash) <= (uint64_t) st.st_size;
+
+    if (!valido) {
+        log_info(logger_storage, "Checkpoint viejo o de otro FS (limpio=%u). Se descarta.", header.limpio);
+        munmap(imagen, st.st_size);
+        close(fd);
+        return false;
+    }
+
+    // 1. Referencias
+    memcpy(estado_fs.referencias, imagen + sizeof(header), largo_referencias);
+
+    // 2. Catálogo (cada registro tiene que terminar antes de los hashes: si no, el checkpoint está roto)
+    char* cursor = imagen + header.offset_catalogo;
+    char* fin_catalogo = imagen + header.offset_hashes;
+    for (uint32_t i = 0; i < header.cantidad_tags; i++) {
+        t_registro_catalogo registro;
+        if ((size_t) (fin_catalogo - cursor) < sizeof(registro)) {
+            valido = false;
+            break;
+        }
+        memcpy(&registro, cursor, sizeof(registro));
+        cursor += sizeof(registro);
+
+        uint64_t largo_resto = (uint64_t) registro.largo_file + registro.largo_tag +
+                               (uint64_t) registro.cantidad_bloques * sizeof(uint32_t);
+        if ((uint64_t) (fin_catalogo - cursor) < largo_resto) {
+            valido = false;
+            break;
+        }
+
+        t_entrada_catalogo* entrada = malloc(sizeof(t_entrada_catalogo));
+        entrada->nombre_file = string_substring(cursor, 0, registro.largo_file);
+        cursor += registro.largo_file;
+        entrada->nombre_tag = string_substring(cursor, 0, registro.largo_tag);
+        cursor += registro.largo_tag;
+        entrada->commited = registro.commited;
+        entrada->tamanio = registro.tamanio;
+        entrada->cantidad_bloques = registro.cantidad_bloques;
+        entrada->bloques = malloc(sizeof(uint32_t) * (registro.cantidad_bloques > 0 ? registro.cantidad_bloques : 1));
+        memcpy(entrada->bloques, cursor, sizeof(uint32_t) * registro.cantidad_bloques);
+        cursor += sizeof(uint32_t) * registro.cantidad_bloques;
+
+        agregar_al_catalogo(&estado_fs, entrada, registro.en_papelera);
+    }
+
+    if (!valido) {
+        // Se vuelve a arrancar de cero: lo cargado hasta acá sale del escaneo
+        log_warning(logger_storage, "Checkpoint con el catálogo cortado o corrupto. Se descarta.");
+        int cantidad_bloques = estado_fs.cantidad_bloques;
+        destruir_estado(&estado_fs);
+        crear_estado(&estado_fs, cantidad_bloques);
+        munmap(imagen, st.st_size);
+        close(fd);
+        return false;
+    }
+
+    // 3. Hash index
+    t_registro_hash* registros_hash = (t_registro_hash*) (imagen + header.offset_hashes);
+    char hash[33];
+    for (uint32_t i = 0; i < header.cantidad_hashes; i++) {
+        memcpy(hash, registros_hash[i].md5, 32);
+        hash[32] = '\0';
+        hash_index_agregar(hash, registros_hash[i].nro_bloque);
+    }
+
+    munmap(imagen, st.st_size);
+    fd_checkpoint = fd;
+    checkpoint_sucio = false;
+    return true;
+}
+
+void checkpoint_marcar_sucio() {
+    pthread_mutex_lock(&mutex_sucio);
+    if (!checkpoint_sucio) {
+        if (fd_checkpoint != -1) {
+            uint32_t limpio = 0;
+            pwrite(fd_checkpoint, &limpio, sizeof(limpio), offsetof(t_checkpoint_header, limpio));
+            fdatasync(fd_checkpoint);
+        }
+        checkpoint_sucio = true;
+    }
+    pthread_mutex_unlock(&mutex_sucio);
+}
+
+/**
+ * @brief Arma el directorio a releer a partir del path (files/FILE/TAG o papelera/NOMBRE).
+ * @return NULL si el path no es de ninguno de los dos.
+ */
+static t_tag_a_escanear* tag_desde_path(char* path) {
+    char* prefijo_files = string_from_format("%s/files/", storage_configs.puntomontaje);
+    char* prefijo_papelera = string_from_format("%s/papelera/", storage_configs.puntomontaje);
+    t_tag_a_escanear* tag = NULL;
+
+    if (string_starts_with(path, prefijo_files)) {
+        char** file_tag = string_split(path + strlen(prefijo_files), "/");
+        if (string_array_size(file_tag) == 2) tag = crear_tag_a_escanear(path, file_tag[0], file_tag[1], false);
+        string_array_destroy(file_tag);
+    } else if (string_starts_with(path, prefijo_papelera)) {
+        tag = crear_tag_a_escanear(path, "papelera", path + strlen(prefijo_papelera), true);
+    }
+
+    free(prefijo_files);
+    free(prefijo_papelera);
+    return tag;
+}
+
+void checkpoint_marcar_cambio(char* path) {
+    checkpoint_marcar_sucio();
+
+    t_tag_a_escanear* tag = tag_desde_path(path);
+    if (tag == NULL) return;
+
+    pthread_mutex_lock(&mutex_sucio);
+    if (cambios_pendientes == NULL) cambios_pendientes = dictionary_create();
+    if (dictionary_has_key(cambios_pendientes, path)) {
+        destruir_tag_a_escanear(tag);
+    } else {
+        dictionary_put(cambios_pendientes, path, tag);
+    }
+    pthread_mutex_unlock(&mutex_sucio);
+}
+
+/**
+ * @brief Relee los directorios que cambiaron y actualiza el catálogo y las referencias
+ * (se resta lo que tenía la entrada vieja y se suma lo de la nueva). Con lock_fs en escritura.
+ * @return Cantidad de directorios releídos.
+ */
+static int aplicar_cambios_pendientes() {
+    pthread_mutex_lock(&mutex_sucio);
+    t_dictionary* cambios = cambios_pendientes;
+    cambios_pendientes = NULL;
+    pthread_mutex_unlock(&mutex_sucio);
+    if (cambios == NULL) return 0;
+
+    t_list* tags = dictionary_elements(cambios);
+    for (int i = 0; i < list_size(tags); i++) {
+        t_tag_a_escanear* tag = list_get(tags, i);
+        t_dictionary* destino = tag->en_papelera ? estado_fs.papelera : estado_fs.catalogo;
+        char* clave = tag->en_papelera ? string_duplicate(tag->nombre_tag)
+                                       : string_from_format("%s:%s", tag->nombre_file, tag->nombre_tag);
+
+        t_entrada_catalogo* vieja = dictionary_remove(destino, clave);
+        if (vieja != NULL) {
+            sumar_referencias(&estado_fs, vieja, -1);
+            destruir_entrada_catalogo(vieja);
+        }
+        t_entrada_catalogo* nueva = leer_entrada(tag);
+        if (nueva != NULL) {
+            sumar_referencias(&estado_fs, nueva, 1);
+            dictionary_put(destino, clave, nueva);
+        }
+        free(clave);
+    }
+    int cantidad = list_size(tags);
+    list_destroy(tags);
+    dictionary_destroy_and_destroy_elements(cambios, destruir_tag_a_escanear);
+    return cantidad;
+}
+
+void checkpoint_agrandar(int nueva_cantidad) {
+    if (nueva_cantidad <= estado_fs.cantidad_bloques) return;
+
+    estado_fs.referencias = realloc(estado_fs.referencias, sizeof(uint32_t) * nueva_cantidad);
+    memset(estado_fs.referencias + estado_fs.cantidad_bloques, 0,
+           sizeof(uint32_t) * (nueva_cantidad - estado_fs.cantidad_bloques));
+    estado_fs.cantidad_bloques = nueva_cantidad;
+
+    // El checkpoint en disco tiene la cantidad de bloques vieja
+    checkpoint_marcar_sucio();
+}
+
+// Se llama con lock_fs tomado en escritura
+static void escribir_si_hay_cambios() {
+    pthread_mutex_lock(&mutex_sucio);
+    bool hay_cambios = checkpoint_sucio;
+    pthread_mutex_unlock(&mutex_sucio);
+    if (!hay_cambios) return;
+
+    t_temporal* cronometro = temporal_create();
+
+    // Solo se releen los directorios que tocaron las operaciones desde el último checkpoint
+    int releidos = aplicar_cambios_pendientes();
+    sincronizar_bitmap();
+    hash_index_guardar();
+    if (guardar_imagen()) {
+        log_info(logger_storage, "Checkpoint escrito: %d File:Tags (%d releídos) en %ld ms.",
+                 dictionary_size(estado_fs.catalogo), releidos, (long) temporal_gettime(cronometro));
+    }
+    temporal_destroy(cronometro);
+}
+
+void checkpoint_escribir() {
+    pthread_rwlock_wrlock(&lock_fs);
+    escribir_si_hay_cambios();
+    pthread_rwlock_unlock(&lock_fs);
+}
+
+void checkpoint_final() {
+    pthread_rwlock_wrlock(&lock_fs);
+    escribir_si_hay_cambios();
+}
+
+static void* checkpoints_periodicos(void* arg) {
+    pthread_mutex_lock(&mutex_periodico);
+    while (periodico_activo) {
+        struct timespec hasta;
+        clock_gettime(CLOCK_REALTIME, &hasta);
+        hasta.tv_sec += storage_configs.checkpointintervalo;
+        pthread_cond_timedwait(&cond_periodico, &mutex_periodico, &hasta);
+        if (!periodico_activo) break;
+
+        pthread_mutex_unlock(&mutex_periodico);
+        checkpoint_escribir();
+        pthread_mutex_lock(&mutex_periodico);
+    }
+    pthread_mutex_unlock(&mutex_periodico);
+    return NULL;
+}
+
+void inicializar_checkpoint() {
+    t_temporal* cronometro = temporal_create();
+    crear_estado(&estado_fs, bitmap_storage.cantidad_bloques);
+    cambios_pendientes = dictionary_create();
+
+    if (!storage_configs.freshstart && cargar_imagen()) {
+        log_info(logger_storage, "Arranque desde checkpoint: %d File:Tags cargados en %ld ms.",
+                 dictionary_size(estado_fs.catalogo), (long) temporal_gettime(cronometro));
+    } else {
+        if (!storage_configs.freshstart) {
+            log_info(logger_storage, "Sin checkpoint válido. Escaneando files/...");
+        }
+        escanear_fs_en_paralelo(&estado_fs);
+        reconciliar_bitmap(&estado_fs);
+        hash_index_cargar_archivo();
+        guardar_imagen();
+        log_info(logger_storage, "Escaneo del FS: %d File:Tags en %ld ms.",
+                 dictionary_size(estado_fs.catalogo), (long) temporal_gettime(cronometro));
+    }
+    temporal_destroy(cronometro);
+
+    // En el formato SLAB la tabla de referencias sale de la metadata (la del disco puede
+    // estar vieja si Storage se cayó a mitad de una operación)
+    bloques_fisicos_cargar_referencias(estado_fs.referencias, estado_fs.cantidad_bloques);
+
+    if (storage_configs.checkpointintervalo > 0) {
+        periodico_activo = true;
+        pthread_create(&hilo_periodico, NULL, checkpoints_periodicos, NULL);
+    }
+}
+
+void destruir_checkpoint() {
+    if (periodico_activo) {
+        pthread_mutex_lock(&mutex_periodico);
+        periodico_activo = false;
+        pthread_cond_signal(&cond_periodico);
+        pthread_mutex_unlock(&mutex_periodico);
+        pthread_join(hilo_periodico, NULL);
+    }
+    destruir_estado(&estado_fs);
+    if (cambios_pendientes != NULL) dictionary_destroy_and_destroy_elements(cambios_pendientes, destruir_tag_a_escanear);
+    cambios_pendientes = NULL;
+    if (fd_checkpoint != -1) close(fd_checkpoint);
+    fd_checkpoint = -1;
+}
@@ -0,0 +1,146 @@
+#ifndef STORAGE_CHECKPOINT_H
+#define STORAGE_CHECKPOINT_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/collections/dictionary.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+#define NOMBRE_CHECKPOINT "checkpoint.bin"
+#define MAGIA_CHECKPOINT "TPCK"
+#define VERSION_CHECKPOINT 2
+
+/**
+ * @struct t_checkpoint_header
+ * @brief Encabezado de checkpoint.bin
+ *
+ * Después del encabezado vienen, en orden: las referencias por bloque físico
+ * (uint32_t[cantidad_bloques]), el catálogo de File:Tag (registros de largo variable
+ * desde offset_catalogo) y el hash index (registros fijos desde offset_hashes).
+ *
+ * @param limpio 1 si nadie modificó el FS desde que se escribió. La primera operación
+ * que modifica algo lo pone en 0 y en ese caso el próximo arranque escanea files/.
+ */
+typedef struct __attribute__((packed)) {
+    char magia[4];
+    uint32_t version;
+    uint32_t limpio;
+    uint32_t cantidad_bloques;
+    uint32_t block_size;
+    uint32_t cantidad_tags;
+    uint32_t cantidad_hashes;
+    uint64_t offset_catalogo;
+    uint64_t offset_hashes;
+} t_checkpoint_header;
+
+/**
+ * @struct t_registro_catalogo
+ * @brief Registro de un File:Tag (o de un directorio de la papelera) en el checkpoint.
+ * Le siguen el nombre del File, el del Tag (sin '\0') y los bloques físicos (uint32_t[cantidad_bloques]).
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t largo_file;
+    uint16_t largo_tag;
+    uint8_t commited;
+    uint8_t en_papelera;
+    uint32_t tamanio;
+    uint32_t cantidad_bloques;
+} t_registro_catalogo;
+
+/**
+ * @struct t_registro_hash
+ * @brief Entrada del hash index en el checkpoint (md5 en hexa, sin '\0')
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t nro_bloque;
+    char md5[32];
+} t_registro_hash;
+
+/**
+ * @struct t_entrada_catalogo
+ * @brief File:Tag residente en memoria
+ */
+typedef struct {
+    char* nombre_file;
+    char* nombre_tag;
+    bool commited;
+    uint32_t tamanio;
+    uint32_t cantidad_bloques;
+    uint32_t* bloques;
+} t_entrada_catalogo;
+
+/**
+ * @struct t_estado_fs
+ * @brief Imagen del FS que se guarda en el checkpoint
+ *
+ * @param catalogo Diccionario "file:tag" -> t_entrada_catalogo*
+ * @param papelera Diccionario nombre del directorio -> t_entrada_catalogo* (lo que el reclamador
+ * todavía no liberó: sus bloques siguen referenciados)
+ * @param referencias Referencias lógicas de cada bloque físico (hard links sin contar
+ * el de /physical_blocks). Incluye las de la papelera.
+ * @param cantidad_bloques Tamaño de referencias
+ */
+typedef struct {
+    t_dictionary* catalogo;
+    t_dictionary* papelera;
+    uint32_t* referencias;
+    int cantidad_bloques;
+} t_estado_fs;
+
+extern t_estado_fs estado_fs;
+
+/**
+ * @var lock_fs
+ * @brief Las operaciones lo toman en modo lectura (pueden ir en paralelo entre ellas);
+ * el checkpoint lo toma en modo escritura para ver el FS quieto. Prefiere a los que
+ * escriben, así que un hilo que ya lo tiene en lectura no lo puede volver a pedir.
+ */
+extern pthread_rwlock_t lock_fs;
+
+/**
+ * @brief Arranque: si hay un checkpoint limpio lo mapea y carga el hash index desde ahí.
+ * Si no, escanea files/ en paralelo, reconcilia el bitmap y carga el hash index del
+ * archivo. Después levanta el hilo de checkpoints periódicos (CHECKPOINT_INTERVALO).
+ */
+void inicializar_checkpoint();
+
+/**
+ * @brief Frena el hilo periódico y libera el estado en memoria.
+ */
+void destruir_checkpoint();
+
+/**
+ * @brief Con lock_fs en escritura relee los directorios marcados con checkpoint_marcar_cambio
+ * (no todo files/) y escribe checkpoint.bin.
+ */
+void checkpoint_escribir();
+
+/**
+ * @brief Último checkpoint antes de salir. Toma lock_fs en escritura y no lo suelta,
+ * así ninguna operación toca el FS después de guardarlo.
+ */
+void checkpoint_final();
+
+/**
+ * @brief Marca el checkpoint en disco como viejo. Lo llama toda operación que modifica
+ * el FS; solo la primera después de un checkpoint toca el disco.
+ */
+void checkpoint_marcar_sucio();
+
+/**
+ * @brief Como checkpoint_marcar_sucio, y además anota el directorio que cambió (files/FILE/TAG
+ * o uno de la papelera) para que el próximo checkpoint relea solo ese.
+ */
+void checkpoint_marcar_cambio(char* path);
+
+/**
+ * @brief Agranda la tabla de referencias cuando el FS crece y marca el checkpoint
+ * como viejo. Se llama con lock_fs tomado en escritura.
+ */
+void checkpoint_agrandar(int nueva_cantidad);
+
+#endif
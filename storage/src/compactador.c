@@ -0,0 +1,228 @@
+#include "compactador.h"
+#include "bitmap.h"
+#include "cache_bloques.h"
+#include "hash_index.h"
+#include "checkpoint.h"
+#include "bloques_fisicos.h"
+#include "storage_operaciones.h"
+#include "storage_conexiones.h"
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+
+static pthread_t hilo_compactador;
+static bool compactador_activo = false;
+static pthread_mutex_t mutex_compactador = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_compactador = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Espera ms milisegundos o hasta que se frene el compactador.
+ * @return false si se pidió frenar.
+ */
+static bool esperar_ms(long ms) {
+    pthread_mutex_lock(&mutex_compactador);
+    if (compactador_activo) {
+        struct timespec hasta;
+        clock_gettime(CLOCK_REALTIME, &hasta);
+        hasta.tv_sec += ms / 1000;
+        hasta.tv_nsec += (ms % 1000) * 1000000;
+        if (hasta.tv_nsec >= 1000000000) {
+            hasta.tv_sec++;
+            hasta.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&cond_compactador, &mutex_compactador, &hasta);
+    }
+    bool seguir = compactador_activo;
+    pthread_mutex_unlock(&mutex_compactador);
+    return seguir;
+}
+
+// Bajo carga no se compacta: se espera a que no haya operaciones en curso
+static bool esperar_sin_carga() {
+    while (storage_operaciones_en_curso() > 0) {
+        if (!esperar_ms(ESPERA_CARGA_COMPACTACION_MS)) return false;
+    }
+    return esperar_ms(0);
+}
+
+// Agrega a destino los subdirectorios de path (salteando . y ..)
+static void listar_subdirectorios(char* path, t_list* destino) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) return;
+
+    struct dirent* entrada;
+    while ((entrada = readdir(dir)) != NULL) {
+        if (strcmp(entrada->d_name, ".") == 0 || strcmp(entrada->d_name, "..") == 0) continue;
+        char* path_entrada = string_from_format("%s/%s", path, entrada->d_name);
+        struct stat st;
+        if (stat(path_entrada, &st) == 0 && S_ISDIR(st.st_mode)) {
+            list_add(destino, path_entrada);
+        } else {
+            free(path_entrada);
+        }
+    }
+    closedir(dir);
+}
+
+/**
+ * @brief Un File:Tag se puede compactar si está COMMITED, sus bloques no son consecutivos
+ * y cada uno tiene una sola referencia (ni el bloque 0 ni bloques compartidos).
+ */
+static bool se_puede_compactar(t_config* metadata, char** bloques_array, int num_bloques) {
+    if (!config_has_property(metadata, "ESTADO") || strcmp(config_get_string_value(metadata, "ESTADO"), "COMMITED") != 0) {
+        return false;
+    }
+    if (num_bloques < 2 || num_bloques > MAXIMO_BLOQUES_COMPACTACION) return false;
+
+    bool consecutivos = true;
+    for (int i = 0; i < num_bloques; i++) {
+        int nro_bloque = atoi(bloques_array[i]);
+        if (nro_bloque == 0 || bloque_fisico_referencias(nro_bloque) != 1) return false;
+        if (i > 0 && nro_bloque != atoi(bloques_array[i - 1]) + 1) consecutivos = false;
+    }
+    return !consecutivos;
+}
+
+/**
+ * @brief Mueve los bloques del File:Tag a bloques consecutivos (con lock_fs en escritura).
+ * @return Cantidad de bloques movidos (0 si no correspondía o no hay una corrida libre).
+ */
+static int compactar_tag(char* path_tag) {
+    char* path_metadata = string_from_format("%s/metadata.config", path_tag);
+    int movidos = 0;
+
+    pthread_rwlock_wrlock(&lock_fs);
+    t_config* metadata = config_create(path_metadata);
+    char** bloques_array = metadata != NULL ? config_get_array_value(metadata, "BLOCKS") : NULL;
+    int num_bloques = bloques_array != NULL ? string_array_size(bloques_array) : 0;
+
+    int inicio = -1;
+    if (metadata != NULL && se_puede_compactar(metadata, bloques_array, num_bloques)) {
+        inicio = reservar_rango_libre(num_bloques);
+        if (inicio == -1) log_debug(logger_storage, "Compactación: no hay %d bloques libres seguidos para %s", num_bloques, path_tag);
+    }
+
+    if (inicio != -1) {
+        checkpoint_marcar_cambio(path_tag);
+        int* viejos = malloc(sizeof(int) * num_bloques);
+        char* buffer = malloc(superblock_configs.blocksize);
+        bool exito = true;
+
+        // 1. Copiar los datos (si algo falla, se devuelve la corrida y no cambia nada)
+        for (int i = 0; i < num_bloques && exito; i++) {
+            viejos[i] = atoi(bloques_array[i]);
+            exito = bloque_fisico_preparar(inicio + i) && bloque_fisico_leer(viejos[i], buffer, false) &&
+                    bloque_fisico_escribir(inicio + i, buffer, superblock_configs.blocksize, true);
+        }
+
+        if (!exito) {
+            log_warning(logger_storage, "Compactación: no se pudo copiar %s. Se deja como estaba.", path_tag);
+            for (int i = 0; i < num_bloques; i++) liberar_bloque(inicio + i);
+        } else {
+            // 2. Links y BLOCKS apuntan a la corrida nueva
+            for (int i = 0; i < num_bloques; i++) {
+                bloque_fisico_desenlazar(viejos[i], path_tag, i);
+                bloque_fisico_enlazar(inicio + i, path_tag, i);
+                free(bloques_array[i]);
+                bloques_array[i] = string_itoa(inicio + i);
+            }
+            char* nuevo_blocks_config_str = array_to_blocks_string(bloques_array, num_bloques);
+            config_set_value(metadata, "BLOCKS", nuevo_blocks_config_str);
+            config_save(metadata);
+            free(nuevo_blocks_config_str);
+
+            // 3. Liberar los viejos; el hash index pasa a apuntar a los nuevos
+            for (int i = 0; i < num_bloques; i++) {
+                char* hash = hash_index_hash_de_bloque(viejos[i]);
+                hash_index_olvidar_bloque(viejos[i]);
+                cache_invalidar_bloque(viejos[i]);
+                if (hash != NULL) hash_index_agregar(hash, inicio + i);
+                free(hash);
+            }
+            liberar_bloques(viejos, num_bloques);
+            movidos = num_bloques;
+        }
+        free(buffer);
+        free(viejos);
+    }
+
+    if (bloques_array != NULL) string_array_destroy(bloques_array);
+    if (metadata != NULL) config_destroy(metadata);
+    pthread_rwlock_unlock(&lock_fs);
+
+    free(path_metadata);
+    return movidos;
+}
+
+/**
+ * @brief Una pasada por todos los File:Tags.
+ * @return false si se frenó el compactador a la mitad.
+ */
+static bool pasada_de_compactacion() {
+    t_list* files = list_create();
+    t_list* tags = list_create();
+    char* path_files = string_from_format("%s/files", storage_configs.puntomontaje);
+    listar_subdirectorios(path_files, files);
+    for (int f = 0; f < list_size(files); f++) listar_subdirectorios(list_get(files, f), tags);
+    list_destroy_and_destroy_elements(files, free);
+    free(path_files);
+
+    int tags_movidos = 0, bloques_movidos = 0;
+    bool completa = true;
+    for (int t = 0; t < list_size(tags) && completa; t++) {
+        if (!esperar_sin_carga()) {
+            completa = false;
+            break;
+        }
+
+        char* path_tag = list_get(tags, t);
+        int movidos = compactar_tag(path_tag);
+        if (movidos == 0) continue;
+
+        log_info(logger_storage, "Compactación: %s reubicado en %d bloques físicos consecutivos", path_tag + strlen(storage_configs.puntomontaje), movidos);
+        tags_movidos++;
+        bloques_movidos += movidos;
+
+        // Presupuesto: PRESUPUESTO_COMPACTACION bloques por segundo
+        if (storage_configs.presupuestocompactacion > 0) {
+            completa = esperar_ms((long) movidos * 1000 / storage_configs.presupuestocompactacion);
+        }
+    }
+    list_destroy_and_destroy_elements(tags, free);
+
+    if (tags_movidos > 0) {
+        pthread_rwlock_rdlock(&lock_fs);
+        hash_index_guardar();
+        pthread_rwlock_unlock(&lock_fs);
+        log_info(logger_storage, "## Compactación: %d File:Tags, %d bloques movidos", tags_movidos, bloques_movidos);
+    }
+    return completa;
+}
+
+static void* compactaciones_periodicas(void* arg) {
+    while (esperar_ms((long) storage_configs.compactacionintervalo * 1000)) {
+        if (!pasada_de_compactacion()) break;
+    }
+    return NULL;
+}
+
+void inicializar_compactador() {
+    if (storage_configs.compactacionintervalo <= 0) return;
+
+    compactador_activo = true;
+    pthread_create(&hilo_compactador, NULL, compactaciones_periodicas, NULL);
+}
+
+void destruir_compactador() {
+    pthread_mutex_lock(&mutex_compactador);
+    if (!compactador_activo) {
+        pthread_mutex_unlock(&mutex_compactador);
+        return;
+    }
+    compactador_activo = false;
+    pthread_cond_signal(&cond_compactador);
+    pthread_mutex_unlock(&mutex_compactador);
+    pthread_join(hilo_compactador, NULL);
+}
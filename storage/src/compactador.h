@@ -0,0 +1,36 @@
+#ifndef STORAGE_COMPACTADOR_H
+#define STORAGE_COMPACTADOR_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/collections/list.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+// File:Tags más grandes que esto no se mueven (se mueven enteros con lock_fs en escritura)
+#define MAXIMO_BLOQUES_COMPACTACION 256
+
+// Cada cuánto se vuelve a mirar si bajó la carga (ms)
+#define ESPERA_CARGA_COMPACTACION_MS 100
+
+/**
+ * @brief Con COMPACTACION_INTERVALO > 0 levanta el compactador.
+ *
+ * Cada pasada recorre los File:Tags COMMITED y, a los que tienen los bloques físicos
+ * desordenados, los mueve a una corrida de bloques consecutivos libres: copia los datos,
+ * rehace los links y BLOCKS y libera los bloques viejos, todo con lock_fs en escritura.
+ * Solo se mueven File:Tags en los que cada bloque tiene una única referencia (un bloque
+ * compartido por TAG o dedup no se puede mover sin tocar a los demás File:Tags).
+ * Se frena mientras haya operaciones en curso y mueve a lo sumo PRESUPUESTO_COMPACTACION
+ * bloques por segundo.
+ */
+void inicializar_compactador();
+
+/**
+ * @brief Frena el compactador (si estaba a mitad de una pasada, sigue en la próxima ejecución).
+ */
+void destruir_compactador();
+
+#endif
@@ -0,0 +1,49 @@
+#include "contenido_inline.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char digitos_hexa[] = "0123456789abcdef";
+
+static int valor_hexa(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return 0;
+}
+
+bool metadata_es_inline(t_config* metadata) {
+    return config_has_property(metadata, CLAVE_CONTENIDO_INLINE);
+}
+
+bool tamanio_entra_inline(int tamanio) {
+    return storage_configs.umbralinline > 0 && tamanio > 0 && tamanio <= storage_configs.umbralinline;
+}
+
+char* contenido_inline_leer(t_config* metadata, int tamanio) {
+    char* datos = calloc(1, tamanio > 0 ? tamanio : 1);
+    char* hexa = config_has_property(metadata, CLAVE_CONTENIDO_INLINE)
+                 ? config_get_string_value(metadata, CLAVE_CONTENIDO_INLINE) : "";
+
+    int largo = strlen(hexa) / 2;
+    for (int i = 0; i < largo && i < tamanio; i++) {
+        datos[i] = (char) (valor_hexa(hexa[2 * i]) << 4 | valor_hexa(hexa[2 * i + 1]));
+    }
+    return datos;
+}
+
+void contenido_inline_guardar(t_config* metadata, char* datos, int tamanio) {
+    if (tamanio <= 0) {
+        config_remove_key(metadata, CLAVE_CONTENIDO_INLINE);
+        return;
+    }
+
+    // Hexa: el contenido es binario (ceros de relleno incluidos) y el config es de texto
+    char* hexa = malloc(2 * tamanio + 1);
+    for (int i = 0; i < tamanio; i++) {
+        hexa[2 * i] = digitos_hexa[(unsigned char) datos[i] >> 4];
+        hexa[2 * i + 1] = digitos_hexa[(unsigned char) datos[i] & 0x0F];
+    }
+    hexa[2 * tamanio] = '\0';
+    config_set_value(metadata, CLAVE_CONTENIDO_INLINE, hexa);
+    free(hexa);
+}
@@ -0,0 +1,35 @@
+#ifndef STORAGE_CONTENIDO_INLINE_H
+#define STORAGE_CONTENIDO_INLINE_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <stdbool.h>
+#include "storage-configs.h"
+
+// Clave del metadata.config con el contenido de un File:Tag chico (en hexa)
+#define CLAVE_CONTENIDO_INLINE "CONTENIDO_INLINE"
+
+/**
+ * @brief Un File:Tag es inline si su contenido vive en el metadata.config en lugar de
+ * en bloques físicos (BLOCKS=[] y TAMAÑO > 0). Solo lo son los de hasta UMBRAL_INLINE bytes.
+ */
+bool metadata_es_inline(t_config* metadata);
+
+/**
+ * @brief Devuelve true si un File:Tag de ese tamaño entra inline con la config actual.
+ */
+bool tamanio_entra_inline(int tamanio);
+
+/**
+ * @brief Decodifica el contenido inline.
+ * @return Buffer de tamanio bytes (lo que no esté guardado queda en cero). Hay que liberarlo.
+ */
+char* contenido_inline_leer(t_config* metadata, int tamanio);
+
+/**
+ * @brief Guarda el contenido en el metadata (en memoria; falta el config_save).
+ * Con tamanio 0 se saca la clave.
+ */
+void contenido_inline_guardar(t_config* metadata, char* datos, int tamanio);
+
+#endif
@@ -0,0 +1,63 @@
+#include "crecimiento_fs.h"
+#include "bloques_fisicos.h"
+#include "bitmap.h"
+#include "hash_index.h"
+#include "checkpoint.h"
+
+bool crecer_fs() {
+    // 1. Releer el superblock (el tamaño nuevo lo pone el administrador)
+    char* path_superblock = string_from_format("%s/superblock.config", storage_configs.puntomontaje);
+    t_config* superblock = config_create(path_superblock);
+    free(path_superblock);
+    if (superblock == NULL || !config_has_property(superblock, "FS_SIZE") || !config_has_property(superblock, "BLOCK_SIZE")) {
+        log_error(logger_storage, "Crecimiento del FS: no se pudo leer superblock.config");
+        if (superblock != NULL) config_destroy(superblock);
+        return false;
+    }
+    int nuevo_fs_size = config_get_int_value(superblock, "FS_SIZE");
+    int nuevo_block_size = config_get_int_value(superblock, "BLOCK_SIZE");
+    config_destroy(superblock);
+
+    // 2. Validar: mismo BLOCK_SIZE y solo crecer
+    if (nuevo_block_size != superblock_configs.blocksize) {
+        log_error(logger_storage, "Crecimiento del FS: BLOCK_SIZE no se puede cambiar en caliente (%d -> %d).",
+                  superblock_configs.blocksize, nuevo_block_size);
+        return false;
+    }
+    int nueva_cantidad = nuevo_fs_size / nuevo_block_size;
+
+    // 3. Frenar las operaciones: las que están en curso terminan y las nuevas esperan
+    pthread_rwlock_wrlock(&lock_fs);
+    int cantidad_actual = bitmap_storage.cantidad_bloques;
+    if (nueva_cantidad <= cantidad_actual) {
+        pthread_rwlock_unlock(&lock_fs);
+        if (nueva_cantidad < cantidad_actual) {
+            log_error(logger_storage, "Crecimiento del FS: no se puede achicar (%d -> %d bloques).",
+                      cantidad_actual, nueva_cantidad);
+            return false;
+        }
+        log_info(logger_storage, "Crecimiento del FS: el tamaño no cambió (%d bloques).", cantidad_actual);
+        return true;
+    }
+
+    log_info(logger_storage, "## Creciendo el FS: %d -> %d bloques.", cantidad_actual, nueva_cantidad);
+    t_temporal* cronometro = temporal_create();
+
+    // 4. Bloques físicos nuevos; 5. bitmap, hash index y referencias
+    bool exito = bloques_fisicos_agrandar(nueva_cantidad) && agrandar_bitmap(nueva_cantidad);
+    if (exito) {
+        hash_index_agrandar(nueva_cantidad);
+        checkpoint_agrandar(nueva_cantidad);
+        superblock_configs.fssize = nuevo_fs_size;
+        log_info(logger_storage, "## FS agrandado a %d bloques (%d bytes) en %ld ms.",
+                 nueva_cantidad, nuevo_fs_size, (long) temporal_gettime(cronometro));
+    } else {
+        // Los bloques que se llegaron a crear no molestan: se reusan en el próximo intento
+        log_error(logger_storage, "Crecimiento del FS: falló. Se sigue con %d bloques.", cantidad_actual);
+    }
+    temporal_destroy(cronometro);
+
+    // 6. Liberar las operaciones
+    pthread_rwlock_unlock(&lock_fs);
+    return exito;
+}
@@ -0,0 +1,27 @@
+#ifndef STORAGE_CRECIMIENTO_FS_H
+#define STORAGE_CRECIMIENTO_FS_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/temporal.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+/**
+ * @brief Agranda el FS en caliente, sin FRESH_START y con los Workers conectados.
+ *
+ * Relee FS_SIZE de superblock.config y, con lock_fs en escritura (las operaciones en
+ * curso terminan y las nuevas esperan), agrega los bloques físicos que faltan, agranda y
+ * vuelve a mapear el bitmap y agranda el hash index y las referencias del checkpoint.
+ * Solo se puede crecer: achicar el FS o cambiar BLOCK_SIZE se rechaza.
+ *
+ * Si Storage se cae a la mitad, el próximo arranque crea los bloques que falten
+ * (ver inicializar_fs).
+ *
+ * @return true si el FS quedó con el tamaño del superblock.
+ */
+bool crecer_fs();
+
+#endif
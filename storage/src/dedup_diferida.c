@@ -0,0 +1,286 @@
+#include "dedup_diferida.h"
+#include "storage_operaciones.h"
+#include "hash_index.h"
+#include "checkpoint.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+
+// Cola de t_trabajo_dedup* (la protege mutex_dedup, igual que dedup_activo)
+static t_queue* cola_dedup = NULL;
+static pthread_mutex_t mutex_dedup = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_dedup = PTHREAD_COND_INITIALIZER;
+
+static pthread_t hilo_dedup;
+static bool dedup_activo = false;
+
+// Para que los nombres de las marcas no se repitan
+static unsigned long contador_marcas = 0;
+
+static void destruir_trabajo(t_trabajo_dedup* trabajo) {
+    free(trabajo->path_marca);
+    free(trabajo->nombre_file);
+    free(trabajo->nombre_tag);
+    free(trabajo);
+}
+
+// Con el hilo ya frenado (Storage apagándose) el trabajo se descarta: la marca lo retoma al arrancar
+static void encolar_trabajo(t_trabajo_dedup* trabajo) {
+    pthread_mutex_lock(&mutex_dedup);
+    if (!dedup_activo) {
+        pthread_mutex_unlock(&mutex_dedup);
+        destruir_trabajo(trabajo);
+        return;
+    }
+    queue_push(cola_dedup, trabajo);
+    pthread_cond_signal(&cond_dedup);
+    pthread_mutex_unlock(&mutex_dedup);
+}
+
+/**
+ * @brief Presupuesto de I/O: después de leer bloques_leidos bloques espera lo que
+ * corresponde a PRESUPUESTO_DEDUP bloques por segundo.
+ * @return false si mientras tanto se pidió frenar el hilo.
+ */
+static bool esperar_presupuesto(int bloques_leidos) {
+    pthread_mutex_lock(&mutex_dedup);
+    if (dedup_activo && storage_configs.presupuestodedup > 0) {
+        long espera_ms = (long) bloques_leidos * 1000 / storage_configs.presupuestodedup;
+        struct timespec hasta;
+        clock_gettime(CLOCK_REALTIME, &hasta);
+        hasta.tv_sec += espera_ms / 1000;
+        hasta.tv_nsec += (espera_ms % 1000) * 1000000;
+        if (hasta.tv_nsec >= 1000000000) {
+            hasta.tv_sec++;
+            hasta.tv_nsec -= 1000000000;
+        }
+        // Un encolado nuevo también despierta: se vuelve a esperar lo que falte
+        while (dedup_activo && pthread_cond_timedwait(&cond_dedup, &mutex_dedup, &hasta) == 0);
+    }
+    bool seguir = dedup_activo;
+    pthread_mutex_unlock(&mutex_dedup);
+    return seguir;
+}
+
+// Solo se deduplican File:Tags COMMITED: el hash index no puede tener bloques que se sigan escribiendo
+static bool metadata_commited(t_config* metadata) {
+    return metadata != NULL && config_has_property(metadata, "ESTADO") &&
+           strcmp(config_get_string_value(metadata, "ESTADO"), "COMMITED") == 0;
+}
+
+/**
+ * @brief Deduplica un lote de bloques lógicos del File:Tag.
+ *
+ * Todo va con lock_fs en lectura, igual que la dedup del COMMIT: las operaciones siguen.
+ * Primero se calculan los md5; después se relee el metadata y se rehacen los links, que
+ * serializa el hash index (cada link se cambia con el índice tomado, así el reclamador y
+ * las escrituras en el lugar no ven un bloque a medio enlazar). Si en el medio el File:Tag
+ * dejó de estar COMMITED (se borró y se volvió a crear) no se toca nada, y los bloques
+ * lógicos que cambiaron de bloque físico se saltean.
+ * @return Cantidad de bloques procesados, o -1 si el File:Tag ya no existe, no está COMMITED o no hay más.
+ */
+static int deduplicar_lote(t_trabajo_dedup* trabajo, char* path_tag, int desde) {
+    char* path_metadata = string_from_format("%s/metadata.config", path_tag);
+    char* hashes[TAMANIO_LOTE_DEDUP] = {0};
+    int fisicos[TAMANIO_LOTE_DEDUP];
+    int hasta = desde;
+
+    // 1. md5 del lote con lock_fs en lectura (un COMMITED no se escribe, solo se puede borrar)
+    pthread_rwlock_rdlock(&lock_fs);
+    t_config* metadata = config_create(path_metadata);
+    if (metadata_commited(metadata)) {
+        char** bloques_array = config_get_array_value(metadata, "BLOCKS");
+        int num_bloques = string_array_size(bloques_array);
+        hasta = desde + TAMANIO_LOTE_DEDUP < num_bloques ? desde + TAMANIO_LOTE_DEDUP : num_bloques;
+
+        for (int i = desde; i < hasta; i++) {
+            fisicos[i - desde] = atoi(bloques_array[i]);
+            hashes[i - desde] = calcular_hash_bloque_fisico(fisicos[i - desde]);
+            if (hashes[i - desde] == NULL) {
+                log_error(logger_storage, "##%d Deduplicación: No se pudo leer el bloque físico block%04d", trabajo->query_id, fisicos[i - desde]);
+            }
+        }
+        string_array_destroy(bloques_array);
+    }
+    if (metadata != NULL) config_destroy(metadata);
+    pthread_rwlock_unlock(&lock_fs);
+
+    // 2. Relinkear, si sigue siendo el mismo File:Tag COMMITED
+    int procesados = -1;
+    if (desde < hasta) {
+        pthread_rwlock_rdlock(&lock_fs);
+        metadata = config_create(path_metadata);
+        if (metadata_commited(metadata)) {
+            char** bloques_array = config_get_array_value(metadata, "BLOCKS");
+            int num_bloques = string_array_size(bloques_array);
+            int hasta_actual = hasta < num_bloques ? hasta : num_bloques;
+
+            for (int i = desde; i < hasta_actual; i++) {
+                if (atoi(bloques_array[i]) == fisicos[i - desde]) continue;
+                free(hashes[i - desde]);
+                hashes[i - desde] = NULL;
+            }
+
+            checkpoint_marcar_cambio(path_tag);
+            if (desde < hasta_actual &&
+                deduplicar_file_tag(trabajo->query_id, trabajo->nombre_file, trabajo->nombre_tag, path_tag,
+                                    bloques_array, desde, hasta_actual, hashes)) {
+                char* nuevo_blocks_config_str = array_to_blocks_string(bloques_array, num_bloques);
+                config_set_value(metadata, "BLOCKS", nuevo_blocks_config_str);
+                config_save(metadata);
+                free(nuevo_blocks_config_str);
+            }
+            procesados = hasta - desde;
+            string_array_destroy(bloques_array);
+        }
+        if (metadata != NULL) config_destroy(metadata);
+        pthread_rwlock_unlock(&lock_fs);
+    }
+
+    for (int i = 0; i < hasta - desde; i++) free(hashes[i]);
+    free(path_metadata);
+    return procesados;
+}
+
+/**
+ * @return true si el File:Tag quedó deduplicado (o ya no existe); false si se frenó el hilo antes.
+ */
+static bool procesar_trabajo(t_trabajo_dedup* trabajo) {
+    char* path_tag = string_from_format("%s/files/%s/%s", storage_configs.puntomontaje,
+                                        trabajo->nombre_file, trabajo->nombre_tag);
+    t_temporal* cronometro = temporal_create();
+    int total = 0;
+    bool completo = true;
+
+    for (int procesados; (procesados = deduplicar_lote(trabajo, path_tag, total)) > 0; ) {
+        total += procesados;
+        if (!esperar_presupuesto(procesados)) {
+            completo = false;
+            break;
+        }
+    }
+
+    if (completo) {
+        pthread_rwlock_rdlock(&lock_fs);
+        hash_index_guardar();
+        pthread_rwlock_unlock(&lock_fs);
+        log_info(logger_storage, "##%d Dedup diferida de %s:%s: %d bloques lógicos en %ld ms",
+                 trabajo->query_id, trabajo->nombre_file, trabajo->nombre_tag, total, (long) temporal_gettime(cronometro));
+    }
+
+    temporal_destroy(cronometro);
+    free(path_tag);
+    return completo;
+}
+
+static void* hilo_dedup_diferida(void* arg) {
+    pthread_mutex_lock(&mutex_dedup);
+    while (dedup_activo) {
+        if (queue_is_empty(cola_dedup)) {
+            pthread_cond_wait(&cond_dedup, &mutex_dedup);
+            continue;
+        }
+        t_trabajo_dedup* trabajo = queue_pop(cola_dedup);
+        pthread_mutex_unlock(&mutex_dedup);
+
+        if (procesar_trabajo(trabajo)) unlink(trabajo->path_marca);
+        destruir_trabajo(trabajo);
+
+        pthread_mutex_lock(&mutex_dedup);
+    }
+    pthread_mutex_unlock(&mutex_dedup);
+    return NULL;
+}
+
+void dedup_diferida_encolar(int query_id, char* nombre_file, char* nombre_tag) {
+    pthread_mutex_lock(&mutex_dedup);
+    unsigned long nro = contador_marcas++;
+    pthread_mutex_unlock(&mutex_dedup);
+
+    t_trabajo_dedup* trabajo = malloc(sizeof(t_trabajo_dedup));
+    trabajo->path_marca = string_from_format("%s/%s/%ld-%lu", storage_configs.puntomontaje, DIR_DEDUP_PENDIENTE,
+                                             (long) time(NULL), nro);
+    trabajo->query_id = query_id;
+    trabajo->nombre_file = string_duplicate(nombre_file);
+    trabajo->nombre_tag = string_duplicate(nombre_tag);
+
+    // La marca va antes que la cola: si Storage se cae, el File:Tag se retoma al arrancar
+    FILE* f_marca = fopen(trabajo->path_marca, "w");
+    if (f_marca != NULL) {
+        fprintf(f_marca, "FILE=%s\n", nombre_file);
+        fprintf(f_marca, "TAG=%s\n", nombre_tag);
+        fclose(f_marca);
+    } else {
+        log_warning(logger_storage, "Dedup diferida: no se pudo crear la marca de %s:%s", nombre_file, nombre_tag);
+    }
+
+    encolar_trabajo(trabajo);
+}
+
+/**
+ * @brief Encola los File:Tags que quedaron marcados (Storage se apagó antes de deduplicarlos).
+ */
+static void encolar_pendientes(char* path_pendientes) {
+    DIR* dir = opendir(path_pendientes);
+    if (dir == NULL) return;
+
+    int pendientes = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+        char* path_marca = string_from_format("%s/%s", path_pendientes, entry->d_name);
+        t_config* marca = config_create(path_marca);
+        if (marca == NULL || !config_has_property(marca, "FILE") || !config_has_property(marca, "TAG")) {
+            unlink(path_marca);
+        } else {
+            t_trabajo_dedup* trabajo = malloc(sizeof(t_trabajo_dedup));
+            trabajo->path_marca = string_duplicate(path_marca);
+            trabajo->query_id = 0;
+            trabajo->nombre_file = string_duplicate(config_get_string_value(marca, "FILE"));
+            trabajo->nombre_tag = string_duplicate(config_get_string_value(marca, "TAG"));
+            encolar_trabajo(trabajo);
+            pendientes++;
+        }
+        if (marca != NULL) config_destroy(marca);
+        free(path_marca);
+    }
+    closedir(dir);
+
+    if (pendientes > 0) {
+        log_info(logger_storage, "Dedup diferida: %d File:Tags pendientes de deduplicar.", pendientes);
+    }
+}
+
+void inicializar_dedup_diferida() {
+    if (!storage_configs.dedupdiferida) return;
+
+    char* path_pendientes = string_from_format("%s/%s", storage_configs.puntomontaje, DIR_DEDUP_PENDIENTE);
+    mkdir(path_pendientes, 0777);
+
+    cola_dedup = queue_create();
+    dedup_activo = true;
+    encolar_pendientes(path_pendientes);
+    free(path_pendientes);
+
+    pthread_create(&hilo_dedup, NULL, hilo_dedup_diferida, NULL);
+}
+
+void destruir_dedup_diferida() {
+    pthread_mutex_lock(&mutex_dedup);
+    if (!dedup_activo) {
+        pthread_mutex_unlock(&mutex_dedup);
+        return;
+    }
+    dedup_activo = false;
+    pthread_cond_signal(&cond_dedup);
+    pthread_mutex_unlock(&mutex_dedup);
+    pthread_join(hilo_dedup, NULL);
+
+    // Lo que quedó en la cola sigue marcado en dedup_pendiente/
+    while (!queue_is_empty(cola_dedup)) destruir_trabajo(queue_pop(cola_dedup));
+    queue_destroy(cola_dedup);
+}
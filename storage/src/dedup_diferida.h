@@ -0,0 +1,51 @@
+#ifndef STORAGE_DEDUP_DIFERIDA_H
+#define STORAGE_DEDUP_DIFERIDA_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/collections/queue.h>
+#include <commons/temporal.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+// Carpeta (dentro del punto de montaje) con una marca por File:Tag pendiente de deduplicar
+#define DIR_DEDUP_PENDIENTE "dedup_pendiente"
+
+// Bloques lógicos que se deduplican por cada vez que se toma lock_fs
+#define TAMANIO_LOTE_DEDUP 16
+
+/**
+ * @struct t_trabajo_dedup
+ * @brief File:Tag COMMITED pendiente de deduplicar (DEDUP_DIFERIDA)
+ *
+ * @param path_marca Archivo en dedup_pendiente/ (FILE y TAG). Se borra recién cuando
+ * el File:Tag quedó deduplicado entero: si Storage se apaga antes, se retoma al arrancar.
+ * @param query_id Query que hizo el COMMIT (para los logs, 0 si quedó de una ejecución anterior)
+ */
+typedef struct {
+    char* path_marca;
+    int query_id;
+    char* nombre_file;
+    char* nombre_tag;
+} t_trabajo_dedup;
+
+/**
+ * @brief Con DEDUP_DIFERIDA: crea dedup_pendiente/, encola lo que quedó de una ejecución
+ * anterior y levanta el hilo de dedup. Sin DEDUP_DIFERIDA no hace nada.
+ */
+void inicializar_dedup_diferida();
+
+/**
+ * @brief Frena el hilo sin esperar a que se vacíe la cola (lo pendiente sigue marcado en disco).
+ */
+void destruir_dedup_diferida();
+
+/**
+ * @brief Deja marcado el File:Tag y lo encola para deduplicarlo en segundo plano.
+ * Los nombres se copian.
+ */
+void dedup_diferida_encolar(int query_id, char* nombre_file, char* nombre_tag);
+
+#endif
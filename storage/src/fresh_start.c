@@ -1,7 +1,13 @@
+#define _GNU_SOURCE // nftw (FTW_DEPTH / FTW_PHYS)
 #include "fresh_start.h"
 #include "bitmap.h"
+#include "bloques_fisicos.h"
+#include "dedup_diferida.h"
 #include <fcntl.h>
 #include <string.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <commons/temporal.h>
 
 // --- FUNCIONES AUXILIARES ---
 
@@ -54,48 +60,134 @@ void inicializar_initial_file() {
     free(metadata_inicial);
 }
 
+// Callback de nftw: se llama primero con el contenido y después con el directorio (FTW_DEPTH)
+static int borrar_entrada(const char* path, const struct stat* st, int tipo, struct FTW* ftw) {
+    if (remove(path) == -1) {
+        log_warning(logger_storage, "No se pudo borrar %s: %s", path, strerror(errno));
+    }
+    return 0; // Seguimos aunque falle una entrada
+}
+
+void fs_borrar_directorio(const char* dir_name) {
+    fs_borrar_directorio_en(storage_configs.puntomontaje, dir_name);
+}
+
+void fs_borrar_directorio_en(const char* base, const char* dir_name) {
+    char path_completo[512];
+    snprintf(path_completo, sizeof(path_completo), "%s/%s", base, dir_name);
+
+    // Recorrido en profundidad sin seguir symlinks, sin lanzar un shell
+    if (access(path_completo, F_OK) == 0) {
+        nftw(path_completo, borrar_entrada, 64, FTW_DEPTH | FTW_PHYS);
+    }
+}
+
 void borrar_datos_existentes() {
     log_info(logger_storage, "Limpiando persistencia en: %s", storage_configs.puntomontaje);
 
     char ruta_completa[512]; 
-    const char *nombres_archivos[] = {"bitmap.bin", "blocks_hash_index.config"};
+    const char *nombres_archivos[] = {"bitmap.bin", "blocks_hash_index.config", "checkpoint.bin", NOMBRE_TABLA_REFERENCIAS};
     
-    for (int i = 0; i < 2; i++) {
+    for (int i = 0; i < 4; i++) {
         snprintf(ruta_completa, sizeof(ruta_completa), "%s/%s", storage_configs.puntomontaje, nombres_archivos[i]);
         unlink(ruta_completa);
     }
 
-    char comando_limpieza[1024];
-    const char *nombres_dirs[] = {"physical_blocks", "files"};
+    // physical_blocks (o slabs) lo vuelve a crear inicializar_bloques_fisicos según el formato
+    const char *nombres_dirs[] = {"physical_blocks", "files", "papelera", DIR_DEDUP_PENDIENTE};
     
-    for (int i = 0; i < 2; i++) {
-        snprintf(ruta_completa, sizeof(ruta_completa), "%s/%s", storage_configs.puntomontaje, nombres_dirs[i]);
-        snprintf(comando_limpieza, sizeof(comando_limpieza), "rm -rf \"%s\"", ruta_completa);
-        system(comando_limpieza);
+    for (int i = 0; i < 4; i++) {
+        fs_borrar_directorio(nombres_dirs[i]);
+    }
+    bloques_fisicos_borrar_segmentos(); // Los segmentos pueden estar en otros directorios de datos
+}
 
-        if (strcmp(nombres_dirs[i], "physical_blocks") == 0) {
-             mkdir(ruta_completa, 0777);
+/**
+ * @struct t_rango_formateo
+ * @brief Rango de bloques físicos que crea un hilo de formateo [desde, hasta)
+ */
+typedef struct {
+    uint32_t desde;
+    uint32_t hasta;
+    int fd_directorio;
+} t_rango_formateo;
+
+static uint32_t bloques_creados = 0;     // Progreso compartido por los hilos (atómico)
+static uint32_t total_bloques_a_crear = 0;
+static bool error_creando_bloques = false;
+
+static void* crear_rango_de_bloques(void* arg) {
+    t_rango_formateo* rango = arg;
+    uint32_t tamanio = superblock_configs.blocksize;
+    char nombre_bloque[32];
+
+    for (uint32_t i = rango->desde; i < rango->hasta; i++) {
+        snprintf(nombre_bloque, sizeof(nombre_bloque), "block%04d.dat", i);
+        // openat evita resolver todo el path del punto de montaje en cada bloque
+        int fd = openat(rango->fd_directorio, nombre_bloque, O_CREAT | O_WRONLY | O_TRUNC, 0664);
+        if (fd == -1) {
+            log_error(logger_storage, "No se pudo crear el bloque físico %u: %s", i, strerror(errno));
+            error_creando_bloques = true;
+            return NULL;
+        }
+        // Reservamos el espacio de una (si el FS no soporta fallocate, alcanza con el tamaño)
+        if (posix_fallocate(fd, 0, tamanio) != 0) ftruncate(fd, tamanio);
+        close(fd);
+
+        // Avisamos cada 10% (solo el hilo que cruza el umbral)
+        uint32_t creados = __atomic_add_fetch(&bloques_creados, 1, __ATOMIC_RELAXED);
+        uint32_t decil = (uint64_t) creados * 10 / total_bloques_a_crear;
+        if (decil != (uint64_t) (creados - 1) * 10 / total_bloques_a_crear && creados < total_bloques_a_crear) {
+            log_info(logger_storage, "Formateo: %u/%u bloques físicos creados (%u%%)",
+                     creados, total_bloques_a_crear, decil * 10);
         }
     }
+    return NULL;
 }
 
-void crear_blocks_fisicos() {
-    uint32_t cantidad = superblock_configs.fssize / superblock_configs.blocksize;
-    uint32_t tamanio = superblock_configs.blocksize;
+bool crear_blocks_fisicos_rango(uint32_t desde, uint32_t hasta) {
+    uint32_t cantidad = hasta - desde;
+    if (hasta <= desde) return true;
+
+    // HILOS_FORMATEO <= 0 (o sin definir): uno por CPU
+    int hilos = storage_configs.hilosformateo > 0 ? storage_configs.hilosformateo : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (hilos < 1) hilos = 1;
+    if ((uint32_t) hilos > cantidad) hilos = cantidad;
+
+    log_info(logger_storage, "Creando %u archivos de bloque físico con %d hilos...", cantidad, hilos);
+    t_temporal* cronometro = temporal_create();
 
-    log_info(logger_storage, "Creando %u archivos de bloque físico...", cantidad);
-    char ruta_bloque[512];
     char ruta_padre[512];
     snprintf(ruta_padre, sizeof(ruta_padre), "%s/physical_blocks", storage_configs.puntomontaje);
     mkdir(ruta_padre, 0777);
+    int fd_directorio = open(ruta_padre, O_RDONLY | O_DIRECTORY);
+    if (fd_directorio == -1) {
+        temporal_destroy(cronometro);
+        return false;
+    }
 
-    for (uint32_t i = 0; i < cantidad; i++) {
-        snprintf(ruta_bloque, sizeof(ruta_bloque), "%s/physical_blocks/block%04d.dat", storage_configs.puntomontaje, i);
-        int fd = open(ruta_bloque, O_CREAT | O_WRONLY | O_TRUNC, 0664);
-        if (fd == -1) exit(EXIT_FAILURE);
-        ftruncate(fd, tamanio);
-        close(fd);
+    bloques_creados = 0;
+    total_bloques_a_crear = cantidad;
+    error_creando_bloques = false;
+
+    // Cada hilo se lleva un rango contiguo de bloques
+    pthread_t* hilos_formateo = malloc(sizeof(pthread_t) * hilos);
+    t_rango_formateo* rangos = malloc(sizeof(t_rango_formateo) * hilos);
+    for (int h = 0; h < hilos; h++) {
+        rangos[h].desde = desde + (uint64_t) cantidad * h / hilos;
+        rangos[h].hasta = desde + (uint64_t) cantidad * (h + 1) / hilos;
+        rangos[h].fd_directorio = fd_directorio;
+        pthread_create(&hilos_formateo[h], NULL, crear_rango_de_bloques, &rangos[h]);
     }
+    for (int h = 0; h < hilos; h++) pthread_join(hilos_formateo[h], NULL);
+
+    close(fd_directorio);
+    free(hilos_formateo);
+    free(rangos);
+
+    log_info(logger_storage, "Bloques físicos creados: %u en %ld ms.", cantidad, (long) temporal_gettime(cronometro));
+    temporal_destroy(cronometro);
+    return !error_creando_bloques;
 }
 
 void crear_archivo_hash_index() {
@@ -105,24 +197,25 @@ void crear_archivo_hash_index() {
 }
 
 void crear_bloque_logico_como_link(const char* path_tag, int nro_bloque_fisico, int nro_bloque_logico) {
-    char ruta_fisica[512];
-    char ruta_logica[512];
-
-    snprintf(ruta_fisica, sizeof(ruta_fisica), "%s/physical_blocks/block%04d.dat", storage_configs.puntomontaje, nro_bloque_fisico);
-    snprintf(ruta_logica, sizeof(ruta_logica), "%s/files/%s/logical_blocks/%06d.dat", storage_configs.puntomontaje, path_tag, nro_bloque_logico);
+    char* ruta_tag = string_from_format("%s/files/%s", storage_configs.puntomontaje, path_tag);
+    bool enlazado = bloque_fisico_enlazar(nro_bloque_fisico, ruta_tag, nro_bloque_logico);
+    free(ruta_tag);
 
-    if (link(ruta_fisica, ruta_logica) != 0 && storage_configs.freshstart) exit(EXIT_FAILURE);
+    if (!enlazado && storage_configs.freshstart) exit(EXIT_FAILURE);
 }
 
 void inicializar_fs() {
     char ruta_bitmap[256];
     snprintf(ruta_bitmap, sizeof(ruta_bitmap), "%s/bitmap.bin", storage_configs.puntomontaje);
     uint32_t cantidad_bloques = superblock_configs.fssize / superblock_configs.blocksize;
+    t_formato_bloques formato = formato_bloques_desde_string(superblock_configs.formatobloques);
 
     if (storage_configs.freshstart) {
         log_info(logger_storage, "=== FRESH START ===");
+        t_temporal* cronometro = temporal_create();
         borrar_datos_existentes();
-        crear_blocks_fisicos();
+        log_info(logger_storage, "Datos anteriores borrados en %ld ms.", (long) temporal_gettime(cronometro));
+        inicializar_bloques_fisicos(formato, cantidad_bloques, true);
         crear_archivo_hash_index();
         
         // ESTA ES LA CLAVE: inicializar con TRUE. NO llamar a crear_archivo_bitmap
@@ -130,9 +223,13 @@ void inicializar_fs() {
         
         inicializar_initial_file();
         crear_bloque_logico_como_link("initial_file/BASE", 0, 0);
+
+        log_info(logger_storage, "FRESH START completo en %ld ms.", (long) temporal_gettime(cronometro));
+        temporal_destroy(cronometro);
     } else {
         log_info(logger_storage, "=== NORMAL START ===");
         if (access(ruta_bitmap, F_OK) != 0) exit(EXIT_FAILURE);
+        inicializar_bloques_fisicos(formato, cantidad_bloques, false);
         inicializar_bitmap(ruta_bitmap, cantidad_bloques, false);
     }
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #include <utils/configs.h>
 #include "storage-configs.h"
@@ -22,10 +24,15 @@ void inicializar_fs();
 void inicializar_initial_file();
 
 
-void crear_blocks_fisicos();
+/**
+ * @brief Crea en paralelo los archivos de bloque físico [desde, hasta) del formato
+ * ARCHIVOS. Se usa en el FRESH_START y cuando el FS crece en caliente.
+ * @return false si algún bloque no se pudo crear.
+ */
+bool crear_blocks_fisicos_rango(uint32_t desde, uint32_t hasta);
 
 /**
- * @brief Crea un bloque lógico como un hard link a un bloque físico.
+ * @brief Crea un bloque lógico apuntando a un bloque físico (en el formato ARCHIVOS, un hard link).
  * @param path_tag Directorio del tag donde se creará la carpeta logical_blocks.
  * Ej: "files/initial_file/BASE"
  * @param nro_bloque_fisico El número del bloque físico al cual vincular (ej: 0).
@@ -44,6 +51,16 @@ void crear_bloque_logico_como_link(const char* path_tag, int nro_bloque_fisico,
  */
 void fs_crear_directorio(const char* dir_name);
 
+/**
+ * @brief Borra un directorio del punto de montaje con todo su contenido (si existe).
+ */
+void fs_borrar_directorio(const char* dir_name);
+
+/**
+ * @brief Igual que fs_borrar_directorio, pero dentro de base (ej: un directorio de datos).
+ */
+void fs_borrar_directorio_en(const char* base, const char* dir_name);
+
 /**
  * @brief Borra todo el contenido del punto de montaje (archivos y directorios).
  */
@@ -0,0 +1,222 @@
+#include "hash_index.h"
+#include "bitmap.h"
+#include "bloques_fisicos.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// Instancia global del índice
+static t_hash_index hash_index = {0};
+
+// --- Funciones auxiliares (se llaman con el mutex tomado) ---
+
+static void sacar_bloque(int nro_bloque) {
+    char* hash = hash_index.hash_por_bloque[nro_bloque];
+    if (hash == NULL) return;
+
+    int* bloque_indexado = dictionary_get(hash_index.por_hash, hash);
+    // Solo borramos la entrada directa si todavía apunta a este bloque
+    if (bloque_indexado != NULL && *bloque_indexado == nro_bloque) {
+        dictionary_remove_and_destroy(hash_index.por_hash, hash, free);
+    }
+    free(hash);
+    hash_index.hash_por_bloque[nro_bloque] = NULL;
+    hash_index.generacion[nro_bloque]++;
+    hash_index.modificado = true;
+}
+
+static void poner_entrada(char* hash, int nro_bloque) {
+    sacar_bloque(nro_bloque);
+
+    // Si el hash apuntaba a otro bloque, ese bloque deja de estar indexado
+    int* bloque_anterior = dictionary_get(hash_index.por_hash, hash);
+    if (bloque_anterior != NULL) sacar_bloque(*bloque_anterior);
+
+    int* bloque = malloc(sizeof(int));
+    *bloque = nro_bloque;
+    dictionary_put(hash_index.por_hash, hash, bloque);
+    hash_index.hash_por_bloque[nro_bloque] = string_duplicate(hash);
+    hash_index.generacion[nro_bloque]++;
+    hash_index.modificado = true;
+}
+
+// Auxiliares de la carga inicial
+static int entradas_descartadas;
+
+static void cargar_entrada(char* hash, void* valor) {
+    char* nombre_bloque = valor; // "blockNNNN"
+    int nro_bloque = string_starts_with(nombre_bloque, "block") ? atoi(nombre_bloque + 5) : -1;
+
+    if (nro_bloque < 0 || nro_bloque >= hash_index.cantidad_bloques || !bloque_esta_ocupado(nro_bloque)) {
+        entradas_descartadas++;
+        return;
+    }
+    poner_entrada(hash, nro_bloque);
+}
+
+// --- Funciones públicas ---
+
+void inicializar_hash_index(int cantidad_bloques) {
+    pthread_mutex_init(&hash_index.mutex, NULL);
+    hash_index.por_hash = dictionary_create();
+    hash_index.hash_por_bloque = calloc(cantidad_bloques, sizeof(char*));
+    hash_index.generacion = calloc(cantidad_bloques, sizeof(uint32_t));
+    hash_index.cantidad_bloques = cantidad_bloques;
+    hash_index.modificado = false;
+}
+
+void hash_index_cargar_archivo() {
+    char* path_hash_index = string_from_format("%s/blocks_hash_index.config", storage_configs.puntomontaje);
+    t_config* hash_index_config = config_create(path_hash_index);
+    free(path_hash_index);
+
+    entradas_descartadas = 0;
+    pthread_mutex_lock(&hash_index.mutex);
+    if (hash_index_config != NULL) {
+        dictionary_iterator(hash_index_config->properties, cargar_entrada);
+        config_destroy(hash_index_config);
+    }
+    // Lo que se descartó no tiene que volver al archivo
+    hash_index.modificado = entradas_descartadas > 0;
+    pthread_mutex_unlock(&hash_index.mutex);
+
+    log_info(logger_storage, "Hash index cargado: %d entradas (%d descartadas por apuntar a bloques libres).",
+             dictionary_size(hash_index.por_hash), entradas_descartadas);
+}
+
+void destruir_hash_index() {
+    hash_index_guardar();
+
+    for (int i = 0; i < hash_index.cantidad_bloques; i++) free(hash_index.hash_por_bloque[i]);
+    free(hash_index.hash_por_bloque);
+    free(hash_index.generacion);
+    dictionary_destroy_and_destroy_elements(hash_index.por_hash, free);
+    pthread_mutex_destroy(&hash_index.mutex);
+}
+
+char* calcular_hash_bloque_fisico(int nro_bloque) {
+    char* buffer = calloc(1, superblock_configs.blocksize);
+    char* hash = NULL;
+    if (bloque_fisico_leer(nro_bloque, buffer, false)) {
+        hash = crypto_md5(buffer, superblock_configs.blocksize);
+    }
+    free(buffer);
+    return hash;
+}
+
+int hash_index_buscar_y_enlazar(char* hash, int nro_bloque_actual, const char* path_tag, int nro_bloque_logico) {
+    pthread_mutex_lock(&hash_index.mutex);
+    int* bloque_indexado = dictionary_get(hash_index.por_hash, hash);
+    int nro_bloque = bloque_indexado != NULL ? *bloque_indexado : -1;
+    uint32_t generacion = nro_bloque != -1 ? hash_index.generacion[nro_bloque] : 0;
+    pthread_mutex_unlock(&hash_index.mutex);
+    if (nro_bloque == -1) return -1;
+
+    // Validación perezosa (sin el índice tomado, es I/O): el bloque puede haberse reescrito sin pasar por acá
+    char* hash_real = bloque_esta_ocupado(nro_bloque) ? calcular_hash_bloque_fisico(nro_bloque) : NULL;
+    bool valido = hash_real != NULL && strcmp(hash_real, hash) == 0;
+    free(hash_real);
+
+    pthread_mutex_lock(&hash_index.mutex);
+    if (hash_index.generacion[nro_bloque] != generacion) {
+        // Mientras se validaba el bloque salió del índice (se liberó, se reescribe o se movió)
+        nro_bloque = -1;
+    } else if (!valido) {
+        log_debug(logger_storage, "Hash index: entrada %s -> bloque %d vencida. Se descarta.", hash, nro_bloque);
+        sacar_bloque(nro_bloque);
+        nro_bloque = -1;
+    } else if (nro_bloque != nro_bloque_actual) {
+        // Con el índice tomado: el reclamador no lo puede liberar hasta que tenga este link
+        bloque_fisico_desenlazar(nro_bloque_actual, path_tag, nro_bloque_logico);
+        bloque_fisico_enlazar(nro_bloque, path_tag, nro_bloque_logico);
+    }
+    pthread_mutex_unlock(&hash_index.mutex);
+    return nro_bloque;
+}
+
+int hash_index_reclamar_bloque(int nro_bloque) {
+    pthread_mutex_lock(&hash_index.mutex);
+    int referencias = bloque_fisico_referencias(nro_bloque);
+    if (referencias == 0 && nro_bloque < hash_index.cantidad_bloques) sacar_bloque(nro_bloque);
+    pthread_mutex_unlock(&hash_index.mutex);
+    return referencias;
+}
+
+bool hash_index_tomar_para_escribir(int nro_bloque) {
+    pthread_mutex_lock(&hash_index.mutex);
+    bool propio = bloque_fisico_referencias(nro_bloque) <= 1;
+    if (propio && nro_bloque < hash_index.cantidad_bloques) sacar_bloque(nro_bloque);
+    pthread_mutex_unlock(&hash_index.mutex);
+    return propio;
+}
+
+void hash_index_agregar(char* hash, int nro_bloque) {
+    if (nro_bloque < 0 || nro_bloque >= hash_index.cantidad_bloques) return;
+
+    pthread_mutex_lock(&hash_index.mutex);
+    poner_entrada(hash, nro_bloque);
+    pthread_mutex_unlock(&hash_index.mutex);
+}
+
+char* hash_index_hash_de_bloque(int nro_bloque) {
+    if (nro_bloque < 0 || nro_bloque >= hash_index.cantidad_bloques) return NULL;
+
+    pthread_mutex_lock(&hash_index.mutex);
+    char* hash = hash_index.hash_por_bloque[nro_bloque] != NULL
+                 ? string_duplicate(hash_index.hash_por_bloque[nro_bloque]) : NULL;
+    pthread_mutex_unlock(&hash_index.mutex);
+    return hash;
+}
+
+void hash_index_olvidar_bloque(int nro_bloque) {
+    if (nro_bloque < 0 || nro_bloque >= hash_index.cantidad_bloques) return;
+
+    pthread_mutex_lock(&hash_index.mutex);
+    sacar_bloque(nro_bloque);
+    pthread_mutex_unlock(&hash_index.mutex);
+}
+
+void hash_index_agrandar(int nueva_cantidad) {
+    pthread_mutex_lock(&hash_index.mutex);
+    if (nueva_cantidad > hash_index.cantidad_bloques) {
+        hash_index.hash_por_bloque = realloc(hash_index.hash_por_bloque, sizeof(char*) * nueva_cantidad);
+        memset(hash_index.hash_por_bloque + hash_index.cantidad_bloques, 0,
+               sizeof(char*) * (nueva_cantidad - hash_index.cantidad_bloques));
+        hash_index.generacion = realloc(hash_index.generacion, sizeof(uint32_t) * nueva_cantidad);
+        memset(hash_index.generacion + hash_index.cantidad_bloques, 0,
+               sizeof(uint32_t) * (nueva_cantidad - hash_index.cantidad_bloques));
+        hash_index.cantidad_bloques = nueva_cantidad;
+    }
+    pthread_mutex_unlock(&hash_index.mutex);
+}
+
+void hash_index_guardar() {
+    pthread_mutex_lock(&hash_index.mutex);
+    if (!hash_index.modificado) {
+        pthread_mutex_unlock(&hash_index.mutex);
+        return;
+    }
+
+    // Escribimos a un temporal y lo renombramos para no dejar el archivo a medias
+    char* path_hash_index = string_from_format("%s/blocks_hash_index.config", storage_configs.puntomontaje);
+    char* path_temporal = string_from_format("%s.tmp", path_hash_index);
+
+    FILE* archivo = fopen(path_temporal, "w");
+    if (archivo == NULL) {
+        log_error(logger_storage, "No se pudo guardar blocks_hash_index.config");
+    } else {
+        for (int i = 0; i < hash_index.cantidad_bloques; i++) {
+            if (hash_index.hash_por_bloque[i] != NULL) {
+                fprintf(archivo, "%s=block%04d\n", hash_index.hash_por_bloque[i], i);
+            }
+        }
+        fclose(archivo);
+        rename(path_temporal, path_hash_index);
+        hash_index.modificado = false;
+    }
+    pthread_mutex_unlock(&hash_index.mutex);
+
+    free(path_hash_index);
+    free(path_temporal);
+}
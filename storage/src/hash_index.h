@@ -0,0 +1,109 @@
+#ifndef STORAGE_HASH_INDEX_H
+#define STORAGE_HASH_INDEX_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/crypto.h>
+#include <commons/collections/dictionary.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+/**
+ * @struct t_hash_index
+ * @brief Índice de deduplicación en memoria (espejo de blocks_hash_index.config)
+ *
+ * @param por_hash Diccionario md5 -> int* (bloque físico)
+ * @param hash_por_bloque Mapa inverso: para cada bloque físico su md5 (NULL si no está indexado)
+ * @param generacion Para cada bloque, cuántas veces cambió su entrada (la deduplicación valida sin el mutex)
+ * @param cantidad_bloques Tamaño de hash_por_bloque
+ * @param modificado Hay cambios que todavía no se guardaron en el archivo
+ */
+typedef struct {
+    t_dictionary* por_hash;
+    char** hash_por_bloque;
+    uint32_t* generacion;
+    int cantidad_bloques;
+    bool modificado;
+    pthread_mutex_t mutex;
+} t_hash_index;
+
+/**
+ * @brief Crea el índice vacío.
+ */
+void inicializar_hash_index(int cantidad_bloques);
+
+/**
+ * @brief Carga blocks_hash_index.config en memoria. Las entradas que apuntan a bloques
+ * libres en el bitmap se descartan. (En un arranque con checkpoint no hace falta.)
+ */
+void hash_index_cargar_archivo();
+
+/**
+ * @brief Devuelve una copia del hash de un bloque, o NULL si no está indexado.
+ */
+char* hash_index_hash_de_bloque(int nro_bloque);
+
+/**
+ * @brief Guarda el índice (si cambió) y libera la memoria.
+ */
+void destruir_hash_index();
+
+/**
+ * @brief Deduplicación: busca un bloque con ese contenido y hace que el bloque lógico apunte
+ * a él (saca el link a nro_bloque_actual y crea el nuevo) con el índice tomado. Así el
+ * bloque no se puede liberar antes del link (ver hash_index_reclamar_bloque).
+ *
+ * El candidato se valida antes, sin el mutex: tiene que seguir ocupado y su md5 tiene que
+ * coincidir. Si no, la entrada se borra y se devuelve -1; si su entrada cambió mientras se
+ * validaba (generacion) también se devuelve -1. Si es nro_bloque_actual no se toca ningún link.
+ *
+ * @return Número de bloque físico al que apunta ahora el bloque lógico, o -1 si no hay ninguno.
+ */
+int hash_index_buscar_y_enlazar(char* hash, int nro_bloque_actual, const char* path_tag, int nro_bloque_logico);
+
+/**
+ * @brief Antes de liberar un bloque: si ya no tiene referencias lo saca del índice, con el
+ * mismo mutex que hash_index_buscar_y_enlazar (ninguna deduplicación lo puede enlazar después).
+ * @return Las referencias del bloque (0 = el que llama lo libera), o -1 si no se pudieron leer.
+ */
+int hash_index_reclamar_bloque(int nro_bloque);
+
+/**
+ * @brief Antes de sobreescribir un bloque en el lugar: con el mismo mutex que
+ * hash_index_buscar_y_enlazar relee sus referencias y, si no está compartido, lo saca del índice
+ * (ninguna deduplicación lo puede enlazar mientras se escribe).
+ * @return true si se puede escribir en el lugar; false si está compartido (hay que hacer CoW).
+ */
+bool hash_index_tomar_para_escribir(int nro_bloque);
+
+/**
+ * @brief Registra el hash de un bloque (si el bloque tenía otro hash, se reemplaza).
+ */
+void hash_index_agregar(char* hash, int nro_bloque);
+
+/**
+ * @brief Saca el bloque del índice. Se llama cuando el bloque se libera o se
+ * sobreescribe en el lugar.
+ */
+void hash_index_olvidar_bloque(int nro_bloque);
+
+/**
+ * @brief Agranda el mapa inverso cuando el FS crece (los bloques nuevos no están indexados).
+ */
+void hash_index_agrandar(int nueva_cantidad);
+
+/**
+ * @brief Escribe el índice en blocks_hash_index.config si hubo cambios.
+ */
+void hash_index_guardar();
+
+/**
+ * @brief Calcula el md5 de un bloque físico leyéndolo de disco.
+ * @return El hash (hay que liberarlo), o NULL si no se pudo leer.
+ */
+char* calcular_hash_bloque_fisico(int nro_bloque);
+
+#endif
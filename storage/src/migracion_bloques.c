@@ -0,0 +1,216 @@
+#define _GNU_SOURCE // nftw (FTW_PHYS)
+#include "migracion_bloques.h"
+#include "fresh_start.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+// --- Funciones auxiliares ---
+
+static void guardar_formato_en_superblock(t_formato_bloques formato) {
+    config_set_value(superblock_tconfig, "FORMATO_BLOQUES", formato == FORMATO_SLAB ? "SLAB" : "ARCHIVOS");
+    if (formato == FORMATO_SLAB) {
+        char* tamanio_segmento = string_itoa(superblock_configs.tamaniosegmento);
+        config_set_value(superblock_tconfig, "TAMANIO_SEGMENTO", tamanio_segmento);
+        free(tamanio_segmento);
+    }
+    config_save(superblock_tconfig);
+
+    free(superblock_configs.formatobloques);
+    superblock_configs.formatobloques = strdup(formato == FORMATO_SLAB ? "SLAB" : "ARCHIVOS");
+}
+
+// Callback de nftw: borra los hard links (los .dat dentro de un logical_blocks)
+static int borrar_hard_link(const char* path, const struct stat* st, int tipo, struct FTW* ftw) {
+    if (tipo == FTW_F && strstr(path, "/logical_blocks/") != NULL) unlink(path);
+    return 0;
+}
+
+static void borrar_hard_links(const char* dir_name) {
+    char* path = string_from_format("%s/%s", storage_configs.puntomontaje, dir_name);
+    if (access(path, F_OK) == 0) nftw(path, borrar_hard_link, 64, FTW_PHYS);
+    free(path);
+}
+
+/**
+ * @brief Rehace los hard links de un Tag (o de un directorio de la papelera) a partir
+ * de BLOCKS de su metadata.config.
+ * @return Cantidad de links creados.
+ */
+static int enlazar_tag(char* path_tag) {
+    char* path_metadata = string_from_format("%s/metadata.config", path_tag);
+    t_config* metadata = config_create(path_metadata);
+    free(path_metadata);
+    if (metadata == NULL) return 0;
+
+    char* path_logical_blocks = string_from_format("%s/logical_blocks", path_tag);
+    mkdir(path_logical_blocks, 0777);
+    free(path_logical_blocks);
+
+    char** bloques_array = config_get_array_value(metadata, "BLOCKS");
+    int enlazados = 0;
+    for (int i = 0; bloques_array[i] != NULL; i++) {
+        char* path_bloque_logico = string_from_format("%s/logical_blocks/%06d.dat", path_tag, i);
+        unlink(path_bloque_logico); // Por si quedó de un intento anterior
+        free(path_bloque_logico);
+        if (bloque_fisico_enlazar(atoi(bloques_array[i]), path_tag, i)) enlazados++;
+    }
+
+    string_array_destroy(bloques_array);
+    config_destroy(metadata);
+    return enlazados;
+}
+
+// Recorre los subdirectorios de path (salteando . y ..)
+static t_list* listar_subdirectorios(char* path) {
+    t_list* subdirectorios = list_create();
+    DIR* dir = opendir(path);
+    if (dir == NULL) return subdirectorios;
+
+    struct dirent* entrada;
+    while ((entrada = readdir(dir)) != NULL) {
+        if (strcmp(entrada->d_name, ".") == 0 || strcmp(entrada->d_name, "..") == 0) continue;
+        char* path_entrada = string_from_format("%s/%s", path, entrada->d_name);
+        struct stat st;
+        if (stat(path_entrada, &st) == 0 && S_ISDIR(st.st_mode)) {
+            list_add(subdirectorios, path_entrada);
+        } else {
+            free(path_entrada);
+        }
+    }
+    closedir(dir);
+    return subdirectorios;
+}
+
+static int enlazar_todos_los_tags() {
+    int enlazados = 0;
+
+    // files/<File>/<Tag>
+    char* path_files = string_from_format("%s/files", storage_configs.puntomontaje);
+    t_list* files = listar_subdirectorios(path_files);
+    for (int f = 0; f < list_size(files); f++) {
+        t_list* tags = listar_subdirectorios(list_get(files, f));
+        for (int t = 0; t < list_size(tags); t++) enlazados += enlazar_tag(list_get(tags, t));
+        list_destroy_and_destroy_elements(tags, free);
+    }
+    list_destroy_and_destroy_elements(files, free);
+    free(path_files);
+
+    // papelera/<trabajo> (siguen contando hasta que los procese el reclamador)
+    char* path_papelera = string_from_format("%s/papelera", storage_configs.puntomontaje);
+    t_list* trabajos = listar_subdirectorios(path_papelera);
+    for (int i = 0; i < list_size(trabajos); i++) enlazados += enlazar_tag(list_get(trabajos, i));
+    list_destroy_and_destroy_elements(trabajos, free);
+    free(path_papelera);
+
+    return enlazados;
+}
+
+static int migrar_a_slab(int cantidad_bloques) {
+    // 1. Segmentos y tabla nuevos (lo que haya quedado de un intento anterior se pisa)
+    inicializar_bloques_fisicos(FORMATO_SLAB, cantidad_bloques, true);
+
+    // 2. Copiar cada bloque a su segmento y tomar las referencias del nlink
+    uint32_t* referencias = calloc(cantidad_bloques, sizeof(uint32_t));
+    char* buffer = malloc(superblock_configs.blocksize);
+    for (int i = 0; i < cantidad_bloques; i++) {
+        char* path_bloque = string_from_format("%s/physical_blocks/block%04d.dat", storage_configs.puntomontaje, i);
+        int fd = open(path_bloque, O_RDONLY);
+        free(path_bloque);
+        if (fd == -1) continue; // Un bloque que no existe queda en cero y sin referencias
+
+        struct stat st;
+        memset(buffer, 0, superblock_configs.blocksize);
+        if (fstat(fd, &st) == 0 && pread(fd, buffer, superblock_configs.blocksize, 0) >= 0) {
+            bloque_fisico_escribir(i, buffer, superblock_configs.blocksize, false);
+            referencias[i] = st.st_nlink - 1;
+        }
+        close(fd);
+    }
+    free(buffer);
+
+    // 3. Todo a disco antes de tocar el superblock
+    bloques_fisicos_cargar_referencias(referencias, cantidad_bloques);
+    free(referencias);
+    destruir_bloques_fisicos();
+    guardar_formato_en_superblock(FORMATO_SLAB);
+
+    // 4. Desde acá el formato viejo ya no se usa
+    borrar_hard_links("files");
+    borrar_hard_links("papelera");
+    fs_borrar_directorio("physical_blocks");
+    return EXIT_SUCCESS;
+}
+
+static int migrar_a_archivos(int cantidad_bloques) {
+    // 1. Archivos de bloque nuevos
+    inicializar_bloques_fisicos(FORMATO_SLAB, cantidad_bloques, false);
+    fs_borrar_directorio("physical_blocks");
+    if (!crear_blocks_fisicos_rango(0, cantidad_bloques)) {
+        destruir_bloques_fisicos();
+        return EXIT_FAILURE;
+    }
+
+    // 2. Copiar el contenido de los segmentos
+    char* buffer = malloc(superblock_configs.blocksize);
+    for (int i = 0; i < cantidad_bloques; i++) {
+        if (!bloque_fisico_leer(i, buffer, false)) continue;
+
+        char* path_bloque = string_from_format("%s/physical_blocks/block%04d.dat", storage_configs.puntomontaje, i);
+        int fd = open(path_bloque, O_WRONLY);
+        free(path_bloque);
+        if (fd == -1) continue;
+        pwrite(fd, buffer, superblock_configs.blocksize, 0);
+        close(fd);
+    }
+    free(buffer);
+    destruir_bloques_fisicos();
+    sync();
+
+    // 3. Hard links desde la metadata
+    inicializar_bloques_fisicos(FORMATO_ARCHIVOS, cantidad_bloques, false);
+    int enlazados = enlazar_todos_los_tags();
+    destruir_bloques_fisicos();
+    log_info(logger_storage, "Migración: %d hard links creados.", enlazados);
+
+    // 4. Cambiar el superblock y borrar el formato viejo
+    guardar_formato_en_superblock(FORMATO_ARCHIVOS);
+    bloques_fisicos_borrar_segmentos();
+    char* path_referencias = string_from_format("%s/%s", storage_configs.puntomontaje, NOMBRE_TABLA_REFERENCIAS);
+    unlink(path_referencias);
+    free(path_referencias);
+    char* path_largos = string_from_format("%s/%s", storage_configs.puntomontaje, NOMBRE_TABLA_LARGOS);
+    unlink(path_largos);
+    free(path_largos);
+    return EXIT_SUCCESS;
+}
+
+// --- Funciones públicas ---
+
+int migrar_formato_bloques(t_formato_bloques destino) {
+    t_formato_bloques origen = formato_bloques_desde_string(superblock_configs.formatobloques);
+    int cantidad_bloques = superblock_configs.fssize / superblock_configs.blocksize;
+    char* nombre_destino = destino == FORMATO_SLAB ? "SLAB" : "ARCHIVOS";
+
+    if (origen == destino) {
+        log_info(logger_storage, "Migración: el FS ya está en formato %s. No se hace nada.", nombre_destino);
+        return EXIT_SUCCESS;
+    }
+
+    log_info(logger_storage, "## Migrando %d bloques físicos al formato %s...", cantidad_bloques, nombre_destino);
+    t_temporal* cronometro = temporal_create();
+
+    int resultado = destino == FORMATO_SLAB ? migrar_a_slab(cantidad_bloques) : migrar_a_archivos(cantidad_bloques);
+
+    if (resultado == EXIT_SUCCESS) {
+        log_info(logger_storage, "## Migración al formato %s completa en %ld ms.", nombre_destino, (long) temporal_gettime(cronometro));
+    } else {
+        log_error(logger_storage, "Migración al formato %s fallida. El FS sigue en el formato anterior.", nombre_destino);
+    }
+    temporal_destroy(cronometro);
+    return resultado;
+}
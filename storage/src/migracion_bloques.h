@@ -0,0 +1,29 @@
+#ifndef STORAGE_MIGRACION_BLOQUES_H
+#define STORAGE_MIGRACION_BLOQUES_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/temporal.h>
+#include <stdbool.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+#include "bloques_fisicos.h"
+
+/**
+ * @brief Pasa los bloques físicos del FS al formato destino, con Storage apagado
+ * (se invoca como: storage <config> --migrar-a-slab | --migrar-a-archivos).
+ *
+ * ARCHIVOS -> SLAB: copia cada physical_blocks/blockNNNN.dat a su segmento, arma
+ * referencias.bin con el nlink y recién después cambia FORMATO_BLOQUES en el superblock
+ * y borra los archivos de bloque y los hard links.
+ * SLAB -> ARCHIVOS: crea los archivos de bloque, rehace los hard links de files/ y de la
+ * papelera desde la metadata, cambia el superblock y borra los segmentos.
+ *
+ * Si se corta antes de cambiar el superblock, el FS sigue entero en el formato viejo y
+ * se puede volver a correr.
+ *
+ * @return EXIT_SUCCESS o EXIT_FAILURE
+ */
+int migrar_formato_bloques(t_formato_bloques destino);
+
+#endif
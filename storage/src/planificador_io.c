@@ -0,0 +1,227 @@
+#include "planificador_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Colas de los Workers, la ronda de los que tienen pedidos y los lugares ocupados (los protege mutex_planificador)
+static t_dictionary* colas_workers = NULL;
+static t_list* ronda = NULL;
+static int posicion_ronda = 0;
+static int operaciones_ejecutando = 0;
+static pthread_mutex_t mutex_planificador = PTHREAD_MUTEX_INITIALIZER;
+static bool planificador_activo = false;
+
+// Límites de LIMITES_OPERACIONES_WORKERS (id -> ops/s)
+static t_dictionary* limites_workers = NULL;
+
+static double segundos_entre(struct timespec desde, struct timespec hasta) {
+    return (hasta.tv_sec - desde.tv_sec) + (hasta.tv_nsec - desde.tv_nsec) / 1e9;
+}
+
+static t_cola_worker* cola_de_worker(uint32_t worker_id) {
+    char* clave = string_itoa(worker_id);
+    t_cola_worker* cola = dictionary_get(colas_workers, clave);
+    if (cola == NULL) {
+        cola = calloc(1, sizeof(t_cola_worker));
+        cola->worker_id = worker_id;
+        cola->pedidos = queue_create();
+        int* limite = dictionary_get(limites_workers, clave);
+        cola->limite = limite != NULL ? *limite : storage_configs.limiteoperacionesworker;
+        cola->tokens = cola->limite;
+        clock_gettime(CLOCK_MONOTONIC, &cola->ultima_recarga);
+        dictionary_put(colas_workers, clave, cola);
+    }
+    free(clave);
+    return cola;
+}
+
+// Bloques que toca la operación (como mínimo 1)
+static int costo_operacion(t_codigo_operacion codigo, t_op_storage* op) {
+    if (codigo == WRITE && op != NULL && op->tamano_contenido > (uint32_t) superblock_configs.blocksize) {
+        return (op->tamano_contenido + superblock_configs.blocksize - 1) / superblock_configs.blocksize;
+    }
+    // READ de un rango: desde el bloque base hasta donde termina (tamaño 0 es un bloque entero).
+    // Ninguna lectura válida pasa del tamaño del FS (las otras las rechaza storage_op_read)
+    if (codigo == READ && op != NULL && op->tamano > 0) {
+        uint64_t fin = (uint64_t) op->desplazamiento + op->tamano;
+        uint64_t bloques = (fin + superblock_configs.blocksize - 1) / superblock_configs.blocksize;
+        uint64_t bloques_fs = superblock_configs.fssize / superblock_configs.blocksize;
+        if (bloques > bloques_fs) bloques = bloques_fs;
+        return bloques > 1 ? (int) bloques : 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Token bucket: espera hasta que el Worker tenga un token y lo consume.
+ */
+static void esperar_token(t_cola_worker* cola) {
+    while (1) {
+        pthread_mutex_lock(&mutex_planificador);
+        struct timespec ahora;
+        clock_gettime(CLOCK_MONOTONIC, &ahora);
+        cola->tokens += segundos_entre(cola->ultima_recarga, ahora) * cola->limite;
+        if (cola->tokens > cola->limite) cola->tokens = cola->limite;
+        cola->ultima_recarga = ahora;
+
+        if (cola->tokens >= 1) {
+            cola->tokens -= 1;
+            pthread_mutex_unlock(&mutex_planificador);
+            return;
+        }
+        long espera_us = (long) ((1 - cola->tokens) / cola->limite * 1e6) + 1;
+        pthread_mutex_unlock(&mutex_planificador);
+
+        log_debug(logger_storage, "Planificador: Worker %d sobre su límite (%.0f ops/s), espera %ld us", cola->worker_id, cola->limite, espera_us);
+        usleep(espera_us);
+    }
+}
+
+// Prioridad con aging: sube un nivel cada AGING_IO turnos que se llevaron pedidos más prioritarios
+static uint32_t prioridad_efectiva(t_pedido_io* pedido) {
+    uint32_t niveles = pedido->salteos / storage_configs.agingio;
+    return pedido->prioridad > niveles ? pedido->prioridad - niveles : 0;
+}
+
+// Mejor prioridad (el menor número) entre los próximos pedidos de la ronda
+static uint32_t mejor_prioridad_en_ronda() {
+    uint32_t mejor = UINT32_MAX;
+    for (int i = 0; i < list_size(ronda); i++) {
+        t_pedido_io* pedido = queue_peek(((t_cola_worker*) list_get(ronda, i))->pedidos);
+        if (prioridad_efectiva(pedido) < mejor) mejor = prioridad_efectiva(pedido);
+    }
+    return mejor;
+}
+
+// Al darle turno a un pedido, los que esperan con peor prioridad suman un salteo
+static void contar_salteos(t_pedido_io* despachado) {
+    uint32_t prioridad = prioridad_efectiva(despachado);
+    for (int i = 0; i < list_size(ronda); i++) {
+        t_cola_worker* cola = list_get(ronda, i);
+        if (queue_is_empty(cola->pedidos)) continue;
+        t_pedido_io* pedido = queue_peek(cola->pedidos);
+        if (prioridad_efectiva(pedido) > prioridad) pedido->salteos++;
+    }
+}
+
+/**
+ * @brief Mientras haya lugar, le da turno al próximo pedido: entre los Workers cuyo pedido
+ * tiene la mejor prioridad, deficit round-robin (con mutex_planificador tomado).
+ */
+static void despachar() {
+    while (operaciones_ejecutando < storage_configs.operacionessimultaneas && !list_is_empty(ronda)) {
+        if (posicion_ronda >= list_size(ronda)) posicion_ronda = 0;
+        t_cola_worker* cola = list_get(ronda, posicion_ronda);
+        t_pedido_io* pedido = queue_peek(cola->pedidos);
+
+        // Un pedido menos prioritario espera (sin acumular déficit) a que no haya mejores
+        if (prioridad_efectiva(pedido) > mejor_prioridad_en_ronda()) {
+            posicion_ronda++;
+            continue;
+        }
+
+        // Al llegar a un Worker en la vuelta se le suma el quantum una sola vez
+        if (!cola->visitado) {
+            cola->deficit += storage_configs.quantumio;
+            cola->visitado = true;
+        }
+
+        if (cola->deficit < pedido->costo) {
+            cola->visitado = false;
+            posicion_ronda++;
+            continue;
+        }
+
+        cola->deficit -= pedido->costo;
+        queue_pop(cola->pedidos);
+        contar_salteos(pedido);
+        pedido->habilitado = true;
+        pthread_cond_signal(&pedido->turno);
+        operaciones_ejecutando++;
+
+        // Sin pedidos sale de la ronda (y pierde el déficit acumulado)
+        if (queue_is_empty(cola->pedidos)) {
+            cola->deficit = 0;
+            cola->visitado = false;
+            list_remove(ronda, posicion_ronda);
+        }
+    }
+}
+
+void planificador_io_entrar(uint32_t worker_id, t_codigo_operacion codigo, t_op_storage* op) {
+    if (!planificador_activo) return;
+
+    pthread_mutex_lock(&mutex_planificador);
+    t_cola_worker* cola = cola_de_worker(worker_id);
+    pthread_mutex_unlock(&mutex_planificador);
+
+    // 1. Límite de operaciones por segundo del Worker
+    if (cola->limite > 0) esperar_token(cola);
+
+    // 2. Turno en el round-robin
+    t_pedido_io pedido = { .costo = costo_operacion(codigo, op), .prioridad = op != NULL ? op->prioridad : 0, .salteos = 0, .habilitado = false };
+    pthread_cond_init(&pedido.turno, NULL);
+
+    pthread_mutex_lock(&mutex_planificador);
+    if (queue_is_empty(cola->pedidos)) list_add(ronda, cola);
+    queue_push(cola->pedidos, &pedido);
+    despachar();
+    while (!pedido.habilitado) pthread_cond_wait(&pedido.turno, &mutex_planificador);
+    pthread_mutex_unlock(&mutex_planificador);
+
+    pthread_cond_destroy(&pedido.turno);
+}
+
+void planificador_io_salir() {
+    if (!planificador_activo) return;
+
+    pthread_mutex_lock(&mutex_planificador);
+    operaciones_ejecutando--;
+    despachar();
+    pthread_mutex_unlock(&mutex_planificador);
+}
+
+static void destruir_cola_worker(void* arg) {
+    t_cola_worker* cola = arg;
+    queue_destroy(cola->pedidos);
+    free(cola);
+}
+
+void inicializar_planificador_io() {
+    if (!storage_configs.planificadorio) return;
+
+    colas_workers = dictionary_create();
+    ronda = list_create();
+    limites_workers = dictionary_create();
+
+    // "id:ops" -> límite propio de ese Worker
+    for (int i = 0; storage_configs.limitesoperacionesworkers != NULL && storage_configs.limitesoperacionesworkers[i] != NULL; i++) {
+        char** id_limite = string_split(storage_configs.limitesoperacionesworkers[i], ":");
+        if (id_limite[0] != NULL && id_limite[1] != NULL) {
+            int* limite = malloc(sizeof(int));
+            *limite = atoi(id_limite[1]);
+            dictionary_put(limites_workers, id_limite[0], limite);
+        } else {
+            log_warning(logger_storage, "LIMITES_OPERACIONES_WORKERS: se ignora '%s' (se espera id:ops)", storage_configs.limitesoperacionesworkers[i]);
+        }
+        string_array_destroy(id_limite);
+    }
+
+    planificador_activo = true;
+    log_info(logger_storage, "## Planificador de I/O: %d operaciones simultáneas, quantum %d bloques, aging cada %d turnos, límite por Worker %d ops/s (%d Workers con límite propio)",
+             storage_configs.operacionessimultaneas, storage_configs.quantumio, storage_configs.agingio, storage_configs.limiteoperacionesworker, dictionary_size(limites_workers));
+}
+
+void destruir_planificador_io() {
+    if (!planificador_activo) return;
+
+    pthread_mutex_lock(&mutex_planificador);
+    planificador_activo = false;
+    list_destroy(ronda);
+    dictionary_destroy_and_destroy_elements(colas_workers, destruir_cola_worker);
+    dictionary_destroy_and_destroy_elements(limites_workers, free);
+    ronda = NULL;
+    colas_workers = NULL;
+    limites_workers = NULL;
+    pthread_mutex_unlock(&mutex_planificador);
+}
@@ -0,0 +1,81 @@
+#ifndef STORAGE_PLANIFICADOR_IO_H
+#define STORAGE_PLANIFICADOR_IO_H
+
+#include <commons/string.h>
+#include <commons/collections/list.h>
+#include <commons/collections/queue.h>
+#include <commons/collections/dictionary.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <utils/serializacion.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+/**
+ * @struct t_pedido_io
+ * @brief Operación de un Worker esperando su turno
+ *
+ * @param costo Bloques que toca la operación (lo que se descuenta del déficit)
+ * @param prioridad Prioridad de la Query que la pidió (menor = más prioritaria)
+ * @param salteos Turnos que se les dieron a pedidos más prioritarios mientras este esperaba (aging)
+ * @param habilitado Lo pone el planificador cuando le toca (con mutex_planificador)
+ */
+typedef struct {
+    int costo;
+    uint32_t prioridad;
+    uint32_t salteos;
+    bool habilitado;
+    pthread_cond_t turno;
+} t_pedido_io;
+
+/**
+ * @struct t_cola_worker
+ * @brief Estado de un Worker en el planificador (se mantiene aunque se reconecte)
+ *
+ * @param pedidos Cola FIFO de t_pedido_io* esperando turno
+ * @param deficit Déficit del round-robin (se le suma QUANTUM_IO en cada vuelta)
+ * @param tokens Token bucket: operaciones que puede hacer sin esperar
+ * @param limite Operaciones por segundo (0 = sin límite); también es el tamaño del bucket
+ * @param ultima_recarga Momento en que se recargaron los tokens por última vez
+ */
+typedef struct {
+    uint32_t worker_id;
+    t_queue* pedidos;
+    int deficit;
+    bool visitado;
+    double tokens;
+    double limite;
+    struct timespec ultima_recarga;
+} t_cola_worker;
+
+/**
+ * @brief Con PLANIFICADOR_IO arma el planificador de operaciones de los Workers.
+ *
+ * Cada Worker tiene su cola y a lo sumo OPERACIONES_SIMULTANEAS operaciones se ejecutan a la
+ * vez. Primero pasan los pedidos de la Query más prioritaria (la prioridad viene en cada
+ * operación, con el aging del Master ya aplicado); un pedido que espera sube un nivel cada
+ * AGING_IO turnos que se llevan otros más prioritarios, así no se queda sin turno mientras
+ * haya pedidos mejores. Entre los de igual prioridad los turnos se
+ * reparten con deficit round-robin (QUANTUM_IO bloques por vuelta), así un Worker con miles de
+ * WRITE no deja sin turno a los demás. Aparte, cada Worker puede tener un
+ * límite de operaciones por segundo (token bucket): LIMITE_OPERACIONES_WORKER para todos y
+ * LIMITES_OPERACIONES_WORKERS=[id:ops,...] para algunos en particular.
+ */
+void inicializar_planificador_io();
+
+void destruir_planificador_io();
+
+/**
+ * @brief Espera el turno de una operación del Worker (primero su límite, después el round-robin).
+ * Llamarla antes de ejecutar la operación, sin lock_fs tomado.
+ */
+void planificador_io_entrar(uint32_t worker_id, t_codigo_operacion codigo, t_op_storage* op);
+
+/**
+ * @brief Libera el lugar de la operación que terminó y le da turno a la siguiente.
+ */
+void planificador_io_salir();
+
+#endif
@@ -0,0 +1,201 @@
+#include "readahead.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HILOS_PREFETCH 2
+#define VENTANA_INICIAL 2
+
+// Patrones de acceso por "worker:file:tag"
+static t_dictionary* patrones = NULL;
+static pthread_mutex_t mutex_patrones = PTHREAD_MUTEX_INITIALIZER;
+
+// Cola de bloques físicos a traer (int*), la consumen los hilos de prefetch
+static t_queue* cola_prefetch = NULL;
+static pthread_mutex_t mutex_cola_prefetch = PTHREAD_MUTEX_INITIALIZER;
+static sem_t sem_prefetch_pendientes;
+
+static pthread_t hilos_prefetch[HILOS_PREFETCH];
+static bool readahead_activo = false;
+
+/**
+ * @brief Trae un bloque físico de disco a la caché.
+ * Paga el retardo de acceso acá, fuera del camino de la lectura del Worker. Si un
+ * Worker pide el mismo bloque mientras tanto, espera esta misma lectura.
+ */
+static void prefetchear_bloque(int nro_bloque) {
+    bool ya_estaba = false;
+    if (leer_bloque_fisico(nro_bloque, NULL, true, &ya_estaba) && !ya_estaba) {
+        log_debug(logger_storage, "Readahead: Bloque Físico %d cargado en caché", nro_bloque);
+    }
+}
+
+static void* hilo_prefetch(void* arg) {
+    while (1) {
+        sem_wait(&sem_prefetch_pendientes);
+
+        pthread_mutex_lock(&mutex_cola_prefetch);
+        int* nro_bloque = queue_pop(cola_prefetch);
+        pthread_mutex_unlock(&mutex_cola_prefetch);
+
+        // -1 es la señal para terminar
+        if (*nro_bloque == -1) {
+            free(nro_bloque);
+            break;
+        }
+        prefetchear_bloque(*nro_bloque);
+        free(nro_bloque);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Encola un bloque para los hilos de prefetch.
+ * @param maximo_en_cola Si la cola ya tiene esa cantidad, el pedido se descarta (0: sin límite).
+ * @return false si se descartó.
+ */
+static bool encolar_prefetch(int nro_bloque, int maximo_en_cola) {
+    pthread_mutex_lock(&mutex_cola_prefetch);
+    if (maximo_en_cola > 0 && queue_size(cola_prefetch) >= maximo_en_cola) {
+        pthread_mutex_unlock(&mutex_cola_prefetch);
+        return false;
+    }
+    int* pedido = malloc(sizeof(int));
+    *pedido = nro_bloque;
+    queue_push(cola_prefetch, pedido);
+    pthread_mutex_unlock(&mutex_cola_prefetch);
+    sem_post(&sem_prefetch_pendientes);
+    return true;
+}
+
+void inicializar_readahead() {
+    if (!storage_configs.readahead || !cache_activa()) {
+        if (storage_configs.readahead) {
+            log_warning(logger_storage, "READAHEAD requiere CACHE_BLOQUES > 0. Readahead desactivado.");
+        }
+        return;
+    }
+
+    patrones = dictionary_create();
+    cola_prefetch = queue_create();
+    sem_init(&sem_prefetch_pendientes, 0, 0);
+
+    for (int i = 0; i < HILOS_PREFETCH; i++) {
+        pthread_create(&hilos_prefetch[i], NULL, hilo_prefetch, NULL);
+    }
+    readahead_activo = true;
+
+    log_info(logger_storage, "Readahead activo (ventana máxima: %d bloques).", storage_configs.ventanareadaheadmax);
+}
+
+void destruir_readahead() {
+    if (!readahead_activo) return;
+    readahead_activo = false;
+
+    for (int i = 0; i < HILOS_PREFETCH; i++) encolar_prefetch(-1, 0);
+    for (int i = 0; i < HILOS_PREFETCH; i++) pthread_join(hilos_prefetch[i], NULL);
+
+    queue_destroy_and_destroy_elements(cola_prefetch, free);
+    dictionary_destroy_and_destroy_elements(patrones, free);
+    sem_destroy(&sem_prefetch_pendientes);
+}
+
+void readahead_registrar_lectura(uint32_t worker_id, char* nombre_file, char* nombre_tag,
+                                 int nro_bloque_logico, char** bloques_array, int num_bloques,
+                                 bool fue_acierto) {
+    if (!readahead_activo) return;
+
+    char* clave = string_from_format("%u:%s:%s", worker_id, nombre_file, nombre_tag);
+
+    pthread_mutex_lock(&mutex_patrones);
+    t_patron_acceso* patron = dictionary_get(patrones, clave);
+    if (patron == NULL) {
+        patron = malloc(sizeof(t_patron_acceso));
+        patron->ultimo_bloque_logico = nro_bloque_logico;
+        patron->paso = 1;
+        patron->proximo_a_prefetchear = nro_bloque_logico + 1;
+        patron->ventana = VENTANA_INICIAL;
+        dictionary_put(patrones, clave, patron);
+        pthread_mutex_unlock(&mutex_patrones);
+        free(clave);
+        return;
+    }
+
+    // 1. Detectar patrón: secuencial (paso 1) o con paso fijo (ej: AGING lee 0, 64, 128...)
+    int paso_nuevo = nro_bloque_logico - patron->ultimo_bloque_logico;
+    bool secuencial = paso_nuevo > 0 && (paso_nuevo == patron->paso || paso_nuevo == 1);
+    patron->ultimo_bloque_logico = nro_bloque_logico;
+
+    if (!secuencial) {
+        // Se rompió el patrón: volvemos a empezar con la ventana chica
+        patron->paso = paso_nuevo > 0 ? paso_nuevo : 1;
+        patron->proximo_a_prefetchear = nro_bloque_logico + patron->paso;
+        patron->ventana = VENTANA_INICIAL;
+        pthread_mutex_unlock(&mutex_patrones);
+        free(clave);
+        return;
+    }
+    if (paso_nuevo != patron->paso) {
+        patron->paso = paso_nuevo;
+        patron->proximo_a_prefetchear = nro_bloque_logico + paso_nuevo;
+    }
+
+    // 2. Adaptar K: si el prefetch se está tirando, achicamos; si no, agrandamos
+    if (cache_prefetch_desperdicia()) {
+        patron->ventana = patron->ventana > 1 ? patron->ventana / 2 : 1;
+    } else if (fue_acierto) {
+        patron->ventana *= 2;
+    } else {
+        patron->ventana++; // Llegamos antes que el prefetch: hay que mirar más lejos
+    }
+    if (patron->ventana > storage_configs.ventanareadaheadmax) {
+        patron->ventana = storage_configs.ventanareadaheadmax;
+    }
+
+    // 3. Encolar los bloques de la ventana que todavía no se pidieron
+    int desde = patron->proximo_a_prefetchear;
+    if (desde <= nro_bloque_logico) desde = nro_bloque_logico + patron->paso;
+    int hasta = nro_bloque_logico + patron->ventana * patron->paso;
+
+    // Si el disco no da abasto la cola no crece sin fin: como mucho una ventana máxima por
+    // flujo. Lo que no entra se vuelve a intentar en la próxima lectura de este flujo
+    int maximo_en_cola = storage_configs.ventanareadaheadmax * dictionary_size(patrones);
+    int bloque_logico = desde;
+    for (; bloque_logico <= hasta && bloque_logico < num_bloques; bloque_logico += patron->paso) {
+        int nro_bloque_fisico = atoi(bloques_array[bloque_logico]);
+        if (!cache_contiene_bloque(nro_bloque_fisico) && !encolar_prefetch(nro_bloque_fisico, maximo_en_cola)) {
+            log_debug(logger_storage, "Readahead: cola llena (%d bloques). Se descarta el prefetch de %s:%s desde el bloque lógico %d",
+                      maximo_en_cola, nombre_file, nombre_tag, bloque_logico);
+            break;
+        }
+    }
+    patron->proximo_a_prefetchear = bloque_logico;
+
+    pthread_mutex_unlock(&mutex_patrones);
+    free(clave);
+}
+
+// Auxiliares de readahead_olvidar_worker (se usan con mutex_patrones tomado)
+static char* prefijo_a_olvidar;
+static t_list* claves_a_borrar;
+
+static void juntar_claves_del_worker(char* clave, void* patron) {
+    if (string_starts_with(clave, prefijo_a_olvidar)) {
+        list_add(claves_a_borrar, string_duplicate(clave));
+    }
+}
+
+void readahead_olvidar_worker(uint32_t worker_id) {
+    if (!readahead_activo) return;
+
+    pthread_mutex_lock(&mutex_patrones);
+    prefijo_a_olvidar = string_from_format("%u:", worker_id);
+    claves_a_borrar = list_create();
+    dictionary_iterator(patrones, juntar_claves_del_worker);
+
+    for (int i = 0; i < list_size(claves_a_borrar); i++) {
+        dictionary_remove_and_destroy(patrones, list_get(claves_a_borrar, i), free);
+    }
+    list_destroy_and_destroy_elements(claves_a_borrar, free);
+    free(prefijo_a_olvidar);
+    pthread_mutex_unlock(&mutex_patrones);
+}
@@ -0,0 +1,62 @@
+#ifndef STORAGE_READAHEAD_H
+#define STORAGE_READAHEAD_H
+
+#include <commons/string.h>
+#include <commons/collections/dictionary.h>
+#include <commons/collections/queue.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+#include "cache_bloques.h"
+
+/**
+ * @struct t_patron_acceso
+ * @brief Patrón de lectura de un Worker sobre un File:Tag
+ *
+ * @param ultimo_bloque_logico Último bloque lógico leído
+ * @param paso Distancia entre las dos últimas lecturas (1 = secuencial puro)
+ * @param proximo_a_prefetchear Primer bloque lógico que todavía no se pidió al readahead
+ * @param ventana Cantidad de bloques que se piden por adelantado (K, adaptativo)
+ */
+typedef struct {
+    int ultimo_bloque_logico;
+    int paso;
+    int proximo_a_prefetchear;
+    int ventana;
+} t_patron_acceso;
+
+/**
+ * @brief Crea los hilos de prefetch. No hace nada si READAHEAD=FALSE o si no hay caché.
+ */
+void inicializar_readahead();
+
+/**
+ * @brief Frena los hilos de prefetch y libera los patrones.
+ */
+void destruir_readahead();
+
+/**
+ * @brief Registra una lectura y, si el patrón es secuencial (o con paso fijo),
+ * encola los próximos K bloques físicos para traerlos a la caché en segundo plano.
+ *
+ * @param worker_id Worker que hizo la lectura.
+ * @param nombre_file File leído.
+ * @param nombre_tag Tag leído.
+ * @param nro_bloque_logico Bloque lógico recién leído.
+ * @param bloques_array Arreglo BLOCKS de la metadata (bloques físicos como string).
+ * @param num_bloques Tamaño de bloques_array.
+ * @param fue_acierto true si el bloque ya estaba en la caché.
+ */
+void readahead_registrar_lectura(uint32_t worker_id, char* nombre_file, char* nombre_tag,
+                                 int nro_bloque_logico, char** bloques_array, int num_bloques,
+                                 bool fue_acierto);
+
+/**
+ * @brief Olvida los patrones de un Worker (se llama cuando se desconecta).
+ */
+void readahead_olvidar_worker(uint32_t worker_id);
+
+#endif
@@ -0,0 +1,210 @@
+#include "reclamador.h"
+#include "bitmap.h"
+#include "cache_bloques.h"
+#include "hash_index.h"
+#include "checkpoint.h"
+#include "bloques_fisicos.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+
+// Cola de t_trabajo_reclamo* (NULL es la señal para terminar)
+static t_queue* cola_reclamo = NULL;
+static pthread_mutex_t mutex_cola_reclamo = PTHREAD_MUTEX_INITIALIZER;
+static sem_t sem_reclamos_pendientes;
+
+static pthread_t hilo_reclamador;
+static bool reclamador_activo = false;
+
+// Para que los nombres de la papelera no se repitan
+static unsigned long contador_papelera = 0;
+static pthread_mutex_t mutex_contador_papelera = PTHREAD_MUTEX_INITIALIZER;
+
+static void destruir_trabajo(t_trabajo_reclamo* trabajo) {
+    free(trabajo->path);
+    free(trabajo->nombre_file);
+    free(trabajo->nombre_tag);
+    free(trabajo);
+}
+
+static int comparar_enteros(const void* a, const void* b) {
+    return *(const int*) a - *(const int*) b;
+}
+
+/**
+ * @brief Libera en el bitmap y en la caché un lote de bloques ya sin referencias.
+ */
+static void liberar_lote(t_trabajo_reclamo* trabajo, int* lote, int cantidad) {
+    if (cantidad == 0) return;
+
+    liberar_bloques(lote, cantidad);
+    for (int i = 0; i < cantidad; i++) {
+        cache_invalidar_bloque(lote[i]);
+        log_info(logger_storage, "##%d Bloque Físico Liberado %d", trabajo->query_id, lote[i]);
+    }
+}
+
+/**
+ * @brief Borra los hard links de un directorio de la papelera y libera los bloques
+ * físicos que quedaron sin referencias.
+ */
+static void procesar_trabajo(t_trabajo_reclamo* trabajo) {
+    char* path_metadata = string_from_format("%s/metadata.config", trabajo->path);
+    char* path_logical_blocks_dir = string_from_format("%s/logical_blocks", trabajo->path);
+
+    t_config* metadata = config_create(path_metadata);
+    char** bloques_array = metadata != NULL ? config_get_array_value(metadata, "BLOCKS") : NULL;
+    int num_bloques = bloques_array != NULL ? string_array_size(bloques_array) : 0;
+    // Los trabajos de TRUNCATE guardan la cola del File:Tag: para los logs sumamos el desplazamiento
+    int primer_bloque_logico = metadata != NULL && config_has_property(metadata, "PRIMER_BLOQUE_LOGICO")
+                               ? config_get_int_value(metadata, "PRIMER_BLOQUE_LOGICO") : 0;
+
+    // 1. Sacar todos los hard links primero: así un bloque repetido en el mismo
+    //    File:Tag se queda sin referencias recién cuando se fue la última
+    for (int i = 0; i < num_bloques; i++) {
+        if (bloque_fisico_desenlazar(atoi(bloques_array[i]), trabajo->path, i)) {
+            log_info(logger_storage, "##%d Hard Link Eliminado: %s:%s, Bloque Lógico %d (apuntaba a Físico %s)",
+                     trabajo->query_id, trabajo->nombre_file, trabajo->nombre_tag, primer_bloque_logico + i, bloques_array[i]);
+        }
+    }
+
+    // 2. Bloques físicos distintos (un File:Tag puede repetir bloques, ej: el 0)
+    int* fisicos = malloc(sizeof(int) * (num_bloques > 0 ? num_bloques : 1));
+    for (int i = 0; i < num_bloques; i++) fisicos[i] = atoi(bloques_array[i]);
+    qsort(fisicos, num_bloques, sizeof(int), comparar_enteros);
+
+    // 3. Chequear los físicos y liberar de a lotes
+    int lote[TAMANIO_LOTE_RECLAMO];
+    int en_lote = 0;
+    for (int i = 0; i < num_bloques; i++) {
+        int nro_bloque_fisico = fisicos[i];
+        if (nro_bloque_fisico == 0 || (i > 0 && fisicos[i - 1] == nro_bloque_fisico)) continue;
+
+        // Sin referencias: ningún bloque lógico (ni de la papelera) apunta a este bloque
+        // (y ya no está en el índice, así que la deduplicación no lo puede volver a enlazar)
+        if (hash_index_reclamar_bloque(nro_bloque_fisico) == 0) {
+            lote[en_lote++] = nro_bloque_fisico;
+        }
+
+        if (en_lote == TAMANIO_LOTE_RECLAMO) {
+            liberar_lote(trabajo, lote, en_lote);
+            en_lote = 0;
+        }
+    }
+    liberar_lote(trabajo, lote, en_lote);
+    free(fisicos);
+
+    // 4. Borrar el directorio de la papelera
+    if (metadata != NULL) {
+        string_array_destroy(bloques_array);
+        config_destroy(metadata);
+    }
+    unlink(path_metadata);
+    rmdir(path_logical_blocks_dir);
+    if (rmdir(trabajo->path) == -1) {
+        log_warning(logger_storage, "Reclamador: no se pudo borrar %s de la papelera", trabajo->path);
+    }
+
+    log_debug(logger_storage, "Reclamador: %s:%s liberado (%d bloques lógicos)",
+              trabajo->nombre_file, trabajo->nombre_tag, num_bloques);
+
+    free(path_metadata);
+    free(path_logical_blocks_dir);
+}
+
+static void* hilo_reclamo(void* arg) {
+    while (1) {
+        sem_wait(&sem_reclamos_pendientes);
+
+        pthread_mutex_lock(&mutex_cola_reclamo);
+        t_trabajo_reclamo* trabajo = queue_pop(cola_reclamo);
+        pthread_mutex_unlock(&mutex_cola_reclamo);
+
+        if (trabajo == NULL) break;
+        pthread_rwlock_rdlock(&lock_fs);
+        checkpoint_marcar_cambio(trabajo->path);
+        procesar_trabajo(trabajo);
+        pthread_rwlock_unlock(&lock_fs);
+        destruir_trabajo(trabajo);
+    }
+    return NULL;
+}
+
+static void encolar_trabajo(t_trabajo_reclamo* trabajo) {
+    pthread_mutex_lock(&mutex_cola_reclamo);
+    queue_push(cola_reclamo, trabajo);
+    pthread_mutex_unlock(&mutex_cola_reclamo);
+    sem_post(&sem_reclamos_pendientes);
+}
+
+void reclamador_encolar(char* path, int query_id, char* nombre_file, char* nombre_tag) {
+    t_trabajo_reclamo* trabajo = malloc(sizeof(t_trabajo_reclamo));
+    trabajo->path = string_duplicate(path);
+    trabajo->query_id = query_id;
+    trabajo->nombre_file = string_duplicate(nombre_file);
+    trabajo->nombre_tag = string_duplicate(nombre_tag);
+    checkpoint_marcar_cambio(path); // Un directorio nuevo en la papelera
+    encolar_trabajo(trabajo);
+}
+
+char* reclamador_nuevo_path_papelera() {
+    pthread_mutex_lock(&mutex_contador_papelera);
+    unsigned long nro = contador_papelera++;
+    pthread_mutex_unlock(&mutex_contador_papelera);
+
+    return string_from_format("%s/%s/%ld-%lu", storage_configs.puntomontaje, DIR_PAPELERA,
+                              (long) time(NULL), nro);
+}
+
+/**
+ * @brief Encola lo que haya quedado en la papelera (Storage se cayó antes de liberarlo).
+ */
+static void encolar_papelera_pendiente(char* path_papelera) {
+    DIR* dir = opendir(path_papelera);
+    if (dir == NULL) return;
+
+    int pendientes = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+        char* path = string_from_format("%s/%s", path_papelera, entry->d_name);
+        reclamador_encolar(path, 0, DIR_PAPELERA, entry->d_name);
+        free(path);
+        pendientes++;
+    }
+    closedir(dir);
+
+    if (pendientes > 0) {
+        log_info(logger_storage, "Reclamador: %d elementos pendientes en la papelera.", pendientes);
+    }
+}
+
+void inicializar_reclamador() {
+    char* path_papelera = string_from_format("%s/%s", storage_configs.puntomontaje, DIR_PAPELERA);
+    mkdir(path_papelera, 0777);
+
+    cola_reclamo = queue_create();
+    sem_init(&sem_reclamos_pendientes, 0, 0);
+
+    encolar_papelera_pendiente(path_papelera);
+    free(path_papelera);
+
+    pthread_create(&hilo_reclamador, NULL, hilo_reclamo, NULL);
+    reclamador_activo = true;
+}
+
+void destruir_reclamador() {
+    if (!reclamador_activo) return;
+    reclamador_activo = false;
+
+    // NULL va al final de la cola: se termina todo lo pendiente antes de salir
+    encolar_trabajo(NULL);
+    pthread_join(hilo_reclamador, NULL);
+
+    queue_destroy(cola_reclamo);
+    sem_destroy(&sem_reclamos_pendientes);
+}
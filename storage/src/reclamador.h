@@ -0,0 +1,62 @@
+#ifndef STORAGE_RECLAMADOR_H
+#define STORAGE_RECLAMADOR_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/collections/queue.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+// Carpeta (dentro del punto de montaje) donde quedan los bloques a liberar
+#define DIR_PAPELERA "papelera"
+
+// Cantidad máxima de bloques que se liberan juntos en el bitmap
+#define TAMANIO_LOTE_RECLAMO 64
+
+/**
+ * @struct t_trabajo_reclamo
+ * @brief Directorio de la papelera pendiente de liberar
+ *
+ * Tiene la misma forma que un Tag: un metadata.config con BLOCKS y la carpeta
+ * logical_blocks con los hard links (el link i apunta a BLOCKS[i]). Los de TRUNCATE
+ * además guardan PRIMER_BLOQUE_LOGICO (número original del link 0, solo para los logs).
+ *
+ * @param path Ruta absoluta del directorio en la papelera
+ * @param query_id Query que lo generó (para los logs, 0 si quedó de una ejecución anterior)
+ * @param nombre_file File al que pertenecían los bloques
+ * @param nombre_tag Tag al que pertenecían los bloques
+ */
+typedef struct {
+    char* path;
+    int query_id;
+    char* nombre_file;
+    char* nombre_tag;
+} t_trabajo_reclamo;
+
+/**
+ * @brief Crea la papelera, encola lo que haya quedado de una ejecución anterior
+ * y levanta el hilo reclamador.
+ */
+void inicializar_reclamador();
+
+/**
+ * @brief Espera a que el reclamador termine lo pendiente y lo frena.
+ */
+void destruir_reclamador();
+
+/**
+ * @brief Reserva un directorio nuevo en la papelera (no lo crea).
+ * @return Ruta absoluta, hay que liberarla.
+ */
+char* reclamador_nuevo_path_papelera();
+
+/**
+ * @brief Encola un directorio de la papelera para que el reclamador libere sus bloques.
+ * El path y los nombres se copian.
+ */
+void reclamador_encolar(char* path, int query_id, char* nombre_file, char* nombre_tag);
+
+#endif
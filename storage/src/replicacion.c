@@ -0,0 +1,438 @@
+#include "replicacion.h"
+#include "storage_operaciones.h"
+#include "cache_bloques.h"
+#include "contenido_inline.h"
+#include "checkpoint.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+// Todas las colas, secuencias y sockets de las réplicas los protege mutex_replicacion
+static t_replica* replicas = NULL;
+static int cantidad_replicas = 0;
+static pthread_mutex_t mutex_replicacion = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_replicacion = PTHREAD_COND_INITIALIZER;
+static bool replicacion_activa = false;
+
+static void destruir_envio(void* arg) {
+    t_envio_replica* envio = arg;
+    free(envio->nombre_file);
+    free(envio->nombre_tag);
+    free(envio);
+}
+
+// Momento absoluto (para pthread_cond_timedwait) dentro de ms milisegundos
+static struct timespec dentro_de_ms(long ms) {
+    struct timespec hasta;
+    clock_gettime(CLOCK_REALTIME, &hasta);
+    hasta.tv_sec += ms / 1000;
+    hasta.tv_nsec += (ms % 1000) * 1000000;
+    if (hasta.tv_nsec >= 1000000000) {
+        hasta.tv_sec++;
+        hasta.tv_nsec -= 1000000000;
+    }
+    return hasta;
+}
+
+/**
+ * @brief Espera ms milisegundos o hasta que se frene la replicación (con mutex_replicacion tomado).
+ * @return false si se pidió frenar.
+ */
+static bool esperar_ms(long ms) {
+    struct timespec hasta = dentro_de_ms(ms);
+    if (replicacion_activa) pthread_cond_timedwait(&cond_replicacion, &mutex_replicacion, &hasta);
+    return replicacion_activa;
+}
+
+// Agrega a destino los subdirectorios de path (salteando . y ..)
+static void listar_subdirectorios(char* path, t_list* destino) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) return;
+
+    struct dirent* entrada;
+    while ((entrada = readdir(dir)) != NULL) {
+        if (strcmp(entrada->d_name, ".") == 0 || strcmp(entrada->d_name, "..") == 0) continue;
+        char* path_entrada = string_from_format("%s/%s", path, entrada->d_name);
+        struct stat st;
+        if (stat(path_entrada, &st) == 0 && S_ISDIR(st.st_mode)) {
+            list_add(destino, path_entrada);
+        } else {
+            free(path_entrada);
+        }
+    }
+    closedir(dir);
+}
+
+// Todos los File:Tags como "FILE/TAG" (relativos a files/), menos initial_file que tienen todos los Storage
+static t_list* listar_file_tags() {
+    t_list* files = list_create();
+    t_list* tags = list_create();
+    char* path_files = string_from_format("%s/files", storage_configs.puntomontaje);
+    listar_subdirectorios(path_files, files);
+    for (int f = 0; f < list_size(files); f++) listar_subdirectorios(list_get(files, f), tags);
+    list_destroy_and_destroy_elements(files, free);
+
+    t_list* file_tags = list_create();
+    for (int t = 0; t < list_size(tags); t++) {
+        char* file_tag = (char*) list_get(tags, t) + strlen(path_files) + 1;
+        if (strcmp(file_tag, "initial_file/BASE") != 0) list_add(file_tags, strdup(file_tag));
+    }
+    list_destroy_and_destroy_elements(tags, free);
+    free(path_files);
+    return file_tags;
+}
+
+/**
+ * @brief Lee el contenido entero de un File:Tag COMMITED (con lock_fs en lectura).
+ * @return El contenido (tamanio bytes), o NULL si ya no existe o no está COMMITED.
+ */
+static char* leer_file_tag_commited(char* nombre_file, char* nombre_tag, int* tamanio) {
+    char* path_metadata = string_from_format("%s/files/%s/%s/metadata.config", storage_configs.puntomontaje, nombre_file, nombre_tag);
+    char* contenido = NULL;
+
+    pthread_rwlock_rdlock(&lock_fs);
+    t_config* metadata = config_create(path_metadata);
+    if (metadata != NULL && config_has_property(metadata, "ESTADO") &&
+        strcmp(config_get_string_value(metadata, "ESTADO"), "COMMITED") == 0) {
+        *tamanio = config_get_int_value(metadata, "TAMAÑO");
+
+        if (metadata_es_inline(metadata)) {
+            contenido = contenido_inline_leer(metadata, *tamanio);
+        } else {
+            char** bloques_array = config_get_array_value(metadata, "BLOCKS");
+            int num_bloques = string_array_size(bloques_array);
+            *tamanio = num_bloques * superblock_configs.blocksize;
+            contenido = calloc(1, *tamanio > 0 ? *tamanio : 1);
+
+            bool acierto_cache;
+            for (int i = 0; i < num_bloques && contenido != NULL; i++) {
+                if (!leer_bloque_fisico(atoi(bloques_array[i]), contenido + i * superblock_configs.blocksize, false, &acierto_cache)) {
+                    log_error(logger_storage, "Replicación: no se pudo leer el bloque %s de %s:%s", bloques_array[i], nombre_file, nombre_tag);
+                    free(contenido);
+                    contenido = NULL;
+                }
+            }
+            string_array_destroy(bloques_array);
+        }
+    }
+    if (metadata != NULL) config_destroy(metadata);
+    pthread_rwlock_unlock(&lock_fs);
+
+    free(path_metadata);
+    return contenido;
+}
+
+/**
+ * @brief Manda una operación a la réplica y espera la respuesta.
+ * @return false si se cortó la conexión.
+ */
+static bool enviar_op(t_replica* replica, t_codigo_operacion codigo, t_op_storage* op, t_codigo_operacion* respuesta) {
+    enviar_paquete(replica->socket, empaquetar_buffer(codigo, serializar_op_storage(op, codigo)));
+    t_paquete* paquete_rta = recibir_paquete(replica->socket);
+    if (paquete_rta == NULL) return false;
+    *respuesta = paquete_rta->codigo_operacion;
+    liberar_paquete(paquete_rta);
+    return true;
+}
+
+/**
+ * @brief Rehace el File:Tag en la réplica: DELETE, CREATE, TRUNCATE, WRITE de los bloques
+ * con datos y COMMIT. Si el File:Tag ya no está COMMITED en el primario no se manda nada.
+ * @return false si se cortó la conexión.
+ */
+static bool enviar_file_tag(t_replica* replica, int query_id, char* nombre_file, char* nombre_tag) {
+    int tamanio = 0;
+    char* contenido = leer_file_tag_commited(nombre_file, nombre_tag, &tamanio);
+    if (contenido == NULL) return true;
+
+    t_op_storage op = { .query_id = query_id, .nombre_file = nombre_file, .nombre_tag = nombre_tag };
+    t_codigo_operacion respuesta;
+    int num_bloques = tamanio / superblock_configs.blocksize;
+
+    // 1. DELETE (si no existía, no importa) y CREATE
+    bool conectada = enviar_op(replica, DELETE, &op, &respuesta) && enviar_op(replica, CREATE, &op, &respuesta);
+    bool exito = conectada && respuesta == OP_OK;
+
+    // 2. TRUNCATE al tamaño del primario
+    if (exito && tamanio > 0) {
+        op.tamano = tamanio;
+        conectada = enviar_op(replica, TRUNCATE, &op, &respuesta);
+        exito = conectada && respuesta == OP_OK;
+    }
+
+    // 3. WRITE de los bloques con datos (los que están en cero ya apuntan al bloque 0)
+    for (int i = 0; exito && i < num_bloques; i++) {
+        char* bloque = contenido + i * superblock_configs.blocksize;
+        bool en_cero = true;
+        for (int b = 0; b < superblock_configs.blocksize && en_cero; b++) en_cero = bloque[b] == 0;
+        if (en_cero) continue;
+
+        op.direccion_base = i;
+        op.tamano_contenido = superblock_configs.blocksize;
+        op.contenido = bloque;
+        conectada = enviar_op(replica, WRITE, &op, &respuesta);
+        exito = conectada && respuesta == OP_OK;
+    }
+
+    // 4. COMMIT
+    if (exito) {
+        conectada = enviar_op(replica, COMMIT, &op, &respuesta);
+        exito = conectada && respuesta == OP_OK;
+    }
+
+    if (exito) {
+        log_info(logger_storage, "##%d Replicación: %s:%s enviado a la réplica %s:%s (%d bloques)",
+                 query_id, nombre_file, nombre_tag, replica->ip, replica->puerto, num_bloques);
+    } else if (conectada) {
+        log_error(logger_storage, "##%d Replicación: la réplica %s:%s rechazó %s:%s (código %d)",
+                  query_id, replica->ip, replica->puerto, nombre_file, nombre_tag, respuesta);
+    }
+    free(contenido);
+    return conectada;
+}
+
+/**
+ * @brief Conexión y handshake con la réplica (tiene que tener el mismo BLOCK_SIZE).
+ * @return El socket, o -1 si falló.
+ */
+static int conectar_replica(t_replica* replica) {
+    int socket_replica = crear_conexion(replica->ip, replica->puerto);
+    if (socket_replica < 0) return -1;
+
+    // Una réplica colgada no puede trabar este hilo: cada envío y respuesta tiene un límite
+    struct timeval limite = { .tv_sec = storage_configs.timeoutreplica / 1000,
+                              .tv_usec = (storage_configs.timeoutreplica % 1000) * 1000 };
+    setsockopt(socket_replica, SOL_SOCKET, SO_RCVTIMEO, &limite, sizeof(limite));
+    setsockopt(socket_replica, SOL_SOCKET, SO_SNDTIMEO, &limite, sizeof(limite));
+
+    enviar_paquete(socket_replica, empaquetar_buffer(HANDSHAKE_REPLICACION, serializar_worker(0)));
+    t_paquete* rta_handshake = recibir_paquete(socket_replica);
+    if (rta_handshake == NULL || rta_handshake->codigo_operacion != HANDSAHKE_STORAGE_RTA) {
+        log_error(logger_storage, "Replicación: la réplica %s:%s rechazó el handshake (¿tiene MODO_REPLICA?)", replica->ip, replica->puerto);
+        if (rta_handshake) liberar_paquete(rta_handshake);
+        close(socket_replica);
+        return -1;
+    }
+    uint32_t block_size = buffer_read_uint32(rta_handshake->buffer);
+    liberar_paquete(rta_handshake);
+
+    if (block_size != (uint32_t) superblock_configs.blocksize) {
+        log_error(logger_storage, "Replicación: la réplica %s:%s tiene BLOCK_SIZE %d y este Storage %d", replica->ip, replica->puerto, block_size, superblock_configs.blocksize);
+        close(socket_replica);
+        return -1;
+    }
+    return socket_replica;
+}
+
+// La réplica se cayó: se descarta su cola (al reconectarse se manda todo) y se destraba a los que esperaban
+static void desconectar_replica(t_replica* replica) {
+    log_warning(logger_storage, "Replicación: se perdió la conexión con la réplica %s:%s", replica->ip, replica->puerto);
+    pthread_mutex_lock(&mutex_replicacion);
+    close(replica->socket);
+    replica->socket = -1;
+    while (!queue_is_empty(replica->pendientes)) destruir_envio(queue_pop(replica->pendientes));
+    replica->aplicados = replica->encolados;
+    pthread_cond_broadcast(&cond_replicacion);
+    pthread_mutex_unlock(&mutex_replicacion);
+}
+
+/**
+ * @brief Manda todos los File:Tags COMMITED a una réplica recién conectada.
+ * @return false si se cortó la conexión o se frenó la replicación.
+ */
+static bool enviar_todo(t_replica* replica) {
+    t_list* file_tags = listar_file_tags();
+    bool seguir = true;
+    for (int i = 0; i < list_size(file_tags) && seguir; i++) {
+        char** file_tag = string_split(list_get(file_tags, i), "/");
+        seguir = enviar_file_tag(replica, 0, file_tag[0], file_tag[1]) &&
+                 __atomic_load_n(&replicacion_activa, __ATOMIC_RELAXED);
+        string_array_destroy(file_tag);
+    }
+    log_info(logger_storage, "## Replicación: réplica %s:%s sincronizada (%d File:Tags revisados)", replica->ip, replica->puerto, list_size(file_tags));
+    list_destroy_and_destroy_elements(file_tags, free);
+    return seguir;
+}
+
+static void* replicar(void* arg) {
+    t_replica* replica = arg;
+
+    pthread_mutex_lock(&mutex_replicacion);
+    while (replicacion_activa) {
+        // 1. Conectarse (y mandar todo) si la réplica está caída
+        if (replica->socket < 0) {
+            pthread_mutex_unlock(&mutex_replicacion);
+            int socket_replica = conectar_replica(replica);
+            pthread_mutex_lock(&mutex_replicacion);
+            if (socket_replica < 0) {
+                esperar_ms(REINTENTO_CONEXION_REPLICA_MS);
+                continue;
+            }
+            // Desde acá se encolan los cambios para esta réplica
+            replica->socket = socket_replica;
+            log_info(logger_storage, "## Replicación: conectado a la réplica %s:%s", replica->ip, replica->puerto);
+            pthread_mutex_unlock(&mutex_replicacion);
+            bool exito = enviar_todo(replica);
+            if (!exito && __atomic_load_n(&replicacion_activa, __ATOMIC_RELAXED)) desconectar_replica(replica);
+            pthread_mutex_lock(&mutex_replicacion);
+            continue;
+        }
+
+        // 2. Siguiente cambio del log
+        if (queue_is_empty(replica->pendientes)) {
+            pthread_cond_wait(&cond_replicacion, &mutex_replicacion);
+            continue;
+        }
+        t_envio_replica* envio = queue_pop(replica->pendientes);
+        pthread_mutex_unlock(&mutex_replicacion);
+
+        bool conectada;
+        if (envio->codigo == COMMIT) {
+            conectada = enviar_file_tag(replica, envio->query_id, envio->nombre_file, envio->nombre_tag);
+        } else {
+            t_op_storage op = { .query_id = envio->query_id, .nombre_file = envio->nombre_file, .nombre_tag = envio->nombre_tag };
+            t_codigo_operacion respuesta;
+            conectada = enviar_op(replica, DELETE, &op, &respuesta);
+            if (conectada) log_info(logger_storage, "##%d Replicación: DELETE de %s:%s enviado a la réplica %s:%s", envio->query_id, envio->nombre_file, envio->nombre_tag, replica->ip, replica->puerto);
+        }
+
+        if (!conectada) {
+            destruir_envio(envio);
+            desconectar_replica(replica);
+            pthread_mutex_lock(&mutex_replicacion);
+            continue;
+        }
+
+        // 3. Marcar como aplicado (destraba a replicacion_esperar)
+        pthread_mutex_lock(&mutex_replicacion);
+        if (replica->aplicados < envio->secuencia) replica->aplicados = envio->secuencia;
+        pthread_cond_broadcast(&cond_replicacion);
+        destruir_envio(envio);
+    }
+    pthread_mutex_unlock(&mutex_replicacion);
+    return NULL;
+}
+
+static void encolar(t_codigo_operacion codigo, int query_id, char* nombre_file, char* nombre_tag) {
+    if (cantidad_replicas == 0) return;
+
+    pthread_mutex_lock(&mutex_replicacion);
+    for (int i = 0; i < cantidad_replicas; i++) {
+        // Una réplica caída recibe todo al reconectarse
+        if (replicas[i].socket < 0) continue;
+
+        t_envio_replica* envio = malloc(sizeof(t_envio_replica));
+        envio->codigo = codigo;
+        envio->query_id = query_id;
+        envio->nombre_file = strdup(nombre_file);
+        envio->nombre_tag = strdup(nombre_tag);
+        envio->secuencia = ++replicas[i].encolados;
+        queue_push(replicas[i].pendientes, envio);
+    }
+    pthread_cond_broadcast(&cond_replicacion);
+    pthread_mutex_unlock(&mutex_replicacion);
+}
+
+void replicacion_encolar_commit(int query_id, char* nombre_file, char* nombre_tag) {
+    encolar(COMMIT, query_id, nombre_file, nombre_tag);
+}
+
+void replicacion_encolar_delete(int query_id, char* nombre_file, char* nombre_tag) {
+    encolar(DELETE, query_id, nombre_file, nombre_tag);
+}
+
+bool replicacion_esperar() {
+    if (cantidad_replicas == 0) return true;
+
+    bool confirmado = true;
+    struct timespec hasta = dentro_de_ms(storage_configs.timeoutreplica);
+    pthread_mutex_lock(&mutex_replicacion);
+    for (int i = 0; i < cantidad_replicas; i++) {
+        uint64_t objetivo = replicas[i].encolados;
+        int resultado = 0;
+        while (resultado != ETIMEDOUT && replicacion_activa && replicas[i].socket >= 0 && replicas[i].aplicados < objetivo) {
+            resultado = pthread_cond_timedwait(&cond_replicacion, &mutex_replicacion, &hasta);
+        }
+
+        // Atrasada (ej: sincronizándose entera) o colgada: se corta la conexión y su hilo la da
+        // por caída; al reconectarse se vacía y recibe todo de nuevo
+        if (resultado == ETIMEDOUT && replicas[i].socket >= 0 && replicas[i].aplicados < objetivo) {
+            log_warning(logger_storage, "Replicación: la réplica %s:%s no aplicó los cambios en %d ms. Se la desconecta.",
+                        replicas[i].ip, replicas[i].puerto, storage_configs.timeoutreplica);
+            shutdown(replicas[i].socket, SHUT_RDWR);
+            confirmado = false;
+        }
+    }
+    pthread_mutex_unlock(&mutex_replicacion);
+    return confirmado;
+}
+
+void replicacion_vaciar_replica() {
+    t_list* file_tags = listar_file_tags();
+    for (int i = 0; i < list_size(file_tags); i++) {
+        char** file_tag = string_split(list_get(file_tags, i), "/");
+        t_op_storage op = { .query_id = 0, .nombre_file = file_tag[0], .nombre_tag = file_tag[1] };
+        char* path_tag = string_from_format("%s/files/%s", storage_configs.puntomontaje, (char*) list_get(file_tags, i));
+
+        pthread_rwlock_rdlock(&lock_fs);
+        checkpoint_marcar_cambio(path_tag);
+        storage_op_delete(&op);
+        pthread_rwlock_unlock(&lock_fs);
+        free(path_tag);
+        string_array_destroy(file_tag);
+    }
+    log_info(logger_storage, "## Réplica vaciada (%d File:Tags): el primario manda todo de nuevo", list_size(file_tags));
+    list_destroy_and_destroy_elements(file_tags, free);
+}
+
+void inicializar_replicacion() {
+    if (storage_configs.replicas == NULL || string_array_size(storage_configs.replicas) == 0) return;
+    if (storage_configs.modoreplica) {
+        log_warning(logger_storage, "Una réplica no replica a su vez: se ignora REPLICAS.");
+        return;
+    }
+
+    cantidad_replicas = string_array_size(storage_configs.replicas);
+    replicas = calloc(cantidad_replicas, sizeof(t_replica));
+    replicacion_activa = true;
+    for (int i = 0; i < cantidad_replicas; i++) {
+        char** ip_puerto = string_split(storage_configs.replicas[i], ":");
+        replicas[i].ip = strdup(ip_puerto[0]);
+        replicas[i].puerto = strdup(ip_puerto[1] != NULL ? ip_puerto[1] : "");
+        string_array_destroy(ip_puerto);
+        replicas[i].socket = -1;
+        replicas[i].pendientes = queue_create();
+        pthread_create(&replicas[i].hilo, NULL, replicar, &replicas[i]);
+    }
+    log_info(logger_storage, "## Replicación activa hacia %d réplica(s)", cantidad_replicas);
+}
+
+void destruir_replicacion() {
+    if (cantidad_replicas == 0) return;
+
+    // Cortar las conexiones destraba a los hilos que esperan una respuesta
+    pthread_mutex_lock(&mutex_replicacion);
+    replicacion_activa = false;
+    for (int i = 0; i < cantidad_replicas; i++) {
+        if (replicas[i].socket >= 0) shutdown(replicas[i].socket, SHUT_RDWR);
+    }
+    pthread_cond_broadcast(&cond_replicacion);
+    pthread_mutex_unlock(&mutex_replicacion);
+
+    for (int i = 0; i < cantidad_replicas; i++) {
+        pthread_join(replicas[i].hilo, NULL);
+        if (replicas[i].socket >= 0) close(replicas[i].socket);
+        queue_destroy_and_destroy_elements(replicas[i].pendientes, destruir_envio);
+        free(replicas[i].ip);
+        free(replicas[i].puerto);
+    }
+    free(replicas);
+    replicas = NULL;
+    cantidad_replicas = 0;
+}
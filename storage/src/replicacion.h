@@ -0,0 +1,91 @@
+#ifndef STORAGE_REPLICACION_H
+#define STORAGE_REPLICACION_H
+
+#include <commons/string.h>
+#include <commons/config.h>
+#include <commons/collections/queue.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <utils/sockets.h>
+#include <utils/serializacion.h>
+#include "storage-configs.h"
+#include "storage-log.h"
+
+// Cada cuánto se reintenta conectar con una réplica caída (ms)
+#define REINTENTO_CONEXION_REPLICA_MS 1000
+
+/**
+ * @struct t_envio_replica
+ * @brief Un cambio del log de replicación: un File:Tag que pasó a COMMITED o se borró
+ *
+ * @param codigo COMMIT o DELETE
+ * @param secuencia Número del envío en la cola de su réplica (para esperar a que se aplique)
+ */
+typedef struct {
+    t_codigo_operacion codigo;
+    int query_id;
+    char* nombre_file;
+    char* nombre_tag;
+    uint64_t secuencia;
+} t_envio_replica;
+
+/**
+ * @struct t_replica
+ * @brief Réplica de solo lectura (REPLICAS) y su cola de envíos
+ *
+ * @param socket Conexión con la réplica (-1 mientras está caída)
+ * @param encolados Secuencia del último envío encolado
+ * @param aplicados Secuencia del último envío que la réplica ya aplicó
+ */
+typedef struct {
+    char* ip;
+    char* puerto;
+    int socket;
+    t_queue* pendientes;
+    uint64_t encolados;
+    uint64_t aplicados;
+    pthread_t hilo;
+} t_replica;
+
+/**
+ * @brief Con REPLICAS levanta un hilo por réplica.
+ *
+ * Cada hilo se conecta a su réplica (que la vacía), le manda todos los File:Tags COMMITED
+ * y después le manda, en orden, cada COMMIT y DELETE del primario. Los cambios viajan como
+ * operaciones comunes (DELETE, CREATE, TRUNCATE, WRITE y COMMIT) por esa conexión.
+ * Si la réplica se cae se descarta su cola: al reconectarse se manda todo de nuevo.
+ */
+void inicializar_replicacion();
+
+/**
+ * @brief Frena los hilos de replicación (lo que no se mandó se manda entero al próximo arranque).
+ */
+void destruir_replicacion();
+
+/**
+ * @brief Encola un File:Tag que pasó a COMMITED para todas las réplicas conectadas.
+ */
+void replicacion_encolar_commit(int query_id, char* nombre_file, char* nombre_tag);
+
+/**
+ * @brief Encola el DELETE de un File:Tag para todas las réplicas conectadas.
+ */
+void replicacion_encolar_delete(int query_id, char* nombre_file, char* nombre_tag);
+
+/**
+ * @brief Espera a que las réplicas conectadas apliquen todo lo encolado hasta ahora
+ * (un DELETE no termina hasta que las réplicas dejan de servir ese File:Tag).
+ * Llamarla sin lock_fs tomado.
+ * @return false si alguna réplica no aplicó a tiempo (se la desconecta, pero hasta que se
+ * dé cuenta puede seguir sirviendo lo viejo)
+ */
+bool replicacion_esperar();
+
+/**
+ * @brief En una réplica (MODO_REPLICA): borra todos los File:Tags menos initial_file, para
+ * que el primario que se acaba de conectar los mande de nuevo.
+ */
+void replicacion_vaciar_replica();
+
+#endif
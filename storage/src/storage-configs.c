@@ -34,6 +34,75 @@ int inicializar_configs(char* path){
     configcargado.retardoaccesobloque = cargar_variable_int(storage_tconfig, "RETARDO_ACCESO_BLOQUE");
     configcargado.loglevel = cargar_variable_string(storage_tconfig, "LOG_LEVEL");
 
+    //Parámetros opcionales de la caché de bloques y el readahead (si no están, quedan desactivados)
+    configcargado.cachebloques = config_has_property(storage_tconfig, "CACHE_BLOQUES") ?
+                                 cargar_variable_int(storage_tconfig, "CACHE_BLOQUES") : 0;
+    configcargado.readahead = config_has_property(storage_tconfig, "READAHEAD") ?
+                              cargar_variable_bool(storage_tconfig, "READAHEAD") : false;
+    configcargado.ventanareadaheadmax = config_has_property(storage_tconfig, "VENTANA_READAHEAD_MAX") ?
+                                        cargar_variable_int(storage_tconfig, "VENTANA_READAHEAD_MAX") : 8;
+
+    //Hilos para crear los bloques físicos en FRESH_START (opcional, 0 = uno por CPU)
+    configcargado.hilosformateo = config_has_property(storage_tconfig, "HILOS_FORMATEO") ?
+                                  cargar_variable_int(storage_tconfig, "HILOS_FORMATEO") : 0;
+
+    //Cada cuántos segundos se escribe el checkpoint (opcional, 0 = solo al apagar)
+    configcargado.checkpointintervalo = config_has_property(storage_tconfig, "CHECKPOINT_INTERVALO") ?
+                                        cargar_variable_int(storage_tconfig, "CHECKPOINT_INTERVALO") : 0;
+
+    //Hasta cuántos bytes un File:Tag guarda su contenido en el metadata (opcional, 0 = nunca)
+    configcargado.umbralinline = config_has_property(storage_tconfig, "UMBRAL_INLINE") ?
+                                 cargar_variable_int(storage_tconfig, "UMBRAL_INLINE") : 0;
+
+    //WRITE busca el contenido en el hash index antes de reservar un bloque (opcional)
+    configcargado.dedupenescritura = config_has_property(storage_tconfig, "DEDUP_EN_ESCRITURA") ?
+                                     cargar_variable_bool(storage_tconfig, "DEDUP_EN_ESCRITURA") : false;
+
+    //COMMIT no deduplica: encola el File:Tag para el hilo de dedup, que lee a lo sumo PRESUPUESTO_DEDUP bloques por segundo (opcional)
+    configcargado.dedupdiferida = config_has_property(storage_tconfig, "DEDUP_DIFERIDA") ?
+                                  cargar_variable_bool(storage_tconfig, "DEDUP_DIFERIDA") : false;
+    configcargado.presupuestodedup = config_has_property(storage_tconfig, "PRESUPUESTO_DEDUP") ?
+                                     cargar_variable_int(storage_tconfig, "PRESUPUESTO_DEDUP") : 100;
+
+    //Cada cuántos segundos el compactador junta los bloques de los File:Tags COMMITED (opcional, 0 = nunca)
+    configcargado.compactacionintervalo = config_has_property(storage_tconfig, "COMPACTACION_INTERVALO") ?
+                                          cargar_variable_int(storage_tconfig, "COMPACTACION_INTERVALO") : 0;
+    configcargado.presupuestocompactacion = config_has_property(storage_tconfig, "PRESUPUESTO_COMPACTACION") ?
+                                            cargar_variable_int(storage_tconfig, "PRESUPUESTO_COMPACTACION") : 50;
+
+    //Directorios entre los que se reparten los segmentos del formato SLAB (opcional, por defecto solo PUNTO_MONTAJE)
+    configcargado.directoriosdatos = config_has_property(storage_tconfig, "DIRECTORIOS_DATOS") ?
+                                     config_get_array_value(storage_tconfig, "DIRECTORIOS_DATOS") : NULL;
+    configcargado.cantidaddirectoriosdatos = configcargado.directoriosdatos != NULL ?
+                                             string_array_size(configcargado.directoriosdatos) : 0;
+
+    //Réplicas de solo lectura que reciben los File:Tags COMMITED, o si este Storage es una de ellas (opcional)
+    configcargado.replicas = config_has_property(storage_tconfig, "REPLICAS") ?
+                             config_get_array_value(storage_tconfig, "REPLICAS") : NULL;
+    configcargado.modoreplica = config_has_property(storage_tconfig, "MODO_REPLICA") ?
+                                cargar_variable_bool(storage_tconfig, "MODO_REPLICA") : false;
+    //Milisegundos que se espera a una réplica antes de darla por caída (opcional)
+    configcargado.timeoutreplica = config_has_property(storage_tconfig, "TIMEOUT_REPLICA") ?
+                                   cargar_variable_int(storage_tconfig, "TIMEOUT_REPLICA") : 5000;
+    if (configcargado.timeoutreplica < 1) configcargado.timeoutreplica = 1;
+
+    //Planificador de I/O entre Workers y límites de operaciones por segundo (opcional)
+    configcargado.planificadorio = config_has_property(storage_tconfig, "PLANIFICADOR_IO") ?
+                                   cargar_variable_bool(storage_tconfig, "PLANIFICADOR_IO") : false;
+    configcargado.operacionessimultaneas = config_has_property(storage_tconfig, "OPERACIONES_SIMULTANEAS") ?
+                                           cargar_variable_int(storage_tconfig, "OPERACIONES_SIMULTANEAS") : 4;
+    if (configcargado.operacionessimultaneas < 1) configcargado.operacionessimultaneas = 1;
+    configcargado.quantumio = config_has_property(storage_tconfig, "QUANTUM_IO") ?
+                              cargar_variable_int(storage_tconfig, "QUANTUM_IO") : 4;
+    if (configcargado.quantumio < 1) configcargado.quantumio = 1;
+    configcargado.agingio = config_has_property(storage_tconfig, "AGING_IO") ?
+                            cargar_variable_int(storage_tconfig, "AGING_IO") : 8;
+    if (configcargado.agingio < 1) configcargado.agingio = 1;
+    configcargado.limiteoperacionesworker = config_has_property(storage_tconfig, "LIMITE_OPERACIONES_WORKER") ?
+                                            cargar_variable_int(storage_tconfig, "LIMITE_OPERACIONES_WORKER") : 0;
+    configcargado.limitesoperacionesworkers = config_has_property(storage_tconfig, "LIMITES_OPERACIONES_WORKERS") ?
+                                              config_get_array_value(storage_tconfig, "LIMITES_OPERACIONES_WORKERS") : NULL;
+
     //Igualo el struct global a este, de esta forma puedo usar los datos en cualquier archivo del modulo
     storage_configs = configcargado;
     
@@ -45,6 +114,9 @@ void destruir_configs() {
     //Libero memoria
     free(storage_configs.puntomontaje);
     free(storage_configs.loglevel);
+    if (storage_configs.directoriosdatos != NULL) string_array_destroy(storage_configs.directoriosdatos);
+    if (storage_configs.replicas != NULL) string_array_destroy(storage_configs.replicas);
+    if (storage_configs.limitesoperacionesworkers != NULL) string_array_destroy(storage_configs.limitesoperacionesworkers);
 
     //Destruyo el config
     config_destroy(storage_tconfig);
@@ -79,6 +151,20 @@ int inicializar_superblock_configs(){
     superblockcargado.fssize = cargar_variable_int(superblock_tconfig, "FS_SIZE");
     superblockcargado.blocksize = cargar_variable_int(superblock_tconfig, "BLOCK_SIZE");
 
+    //Formato de los bloques físicos (opcional: ARCHIVOS o SLAB, por defecto ARCHIVOS)
+    superblockcargado.formatobloques = config_has_property(superblock_tconfig, "FORMATO_BLOQUES") ?
+                                       strdup(cargar_variable_string(superblock_tconfig, "FORMATO_BLOQUES")) : strdup("ARCHIVOS");
+    superblockcargado.tamaniosegmento = config_has_property(superblock_tconfig, "TAMANIO_SEGMENTO") ?
+                                        cargar_variable_int(superblock_tconfig, "TAMANIO_SEGMENTO") : 1048576;
+
+    //Compresión de los bloques físicos (opcional: NINGUNA o COLA_CEROS, por defecto NINGUNA)
+    superblockcargado.compresion = config_has_property(superblock_tconfig, "COMPRESION") ?
+                                   strdup(cargar_variable_string(superblock_tconfig, "COMPRESION")) : strdup("NINGUNA");
+
+    //Entre cuántos directorios de datos están repartidos los segmentos (lo escribe Storage al formatear en SLAB)
+    superblockcargado.cantidaddirectoriosdatos = config_has_property(superblock_tconfig, "CANTIDAD_DIRECTORIOS_DATOS") ?
+                                                 cargar_variable_int(superblock_tconfig, "CANTIDAD_DIRECTORIOS_DATOS") : 1;
+
     //Igualo el struct global a este, de esta forma puedo usar los datos en cualquier archivo del modulo
     superblock_configs = superblockcargado;
 
@@ -86,6 +172,9 @@ int inicializar_superblock_configs(){
 }
 
 void destruir_superblock_configs() {
+    free(superblock_configs.formatobloques);
+    free(superblock_configs.compresion);
+
     //Destruyo el config
     config_destroy(superblock_tconfig);
     fprintf(stderr, "Archivo de configuración de superblock.config destruido.\n");
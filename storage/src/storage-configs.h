@@ -29,6 +29,28 @@ extern t_config* superblock_tconfig;
  * @param retardooperacion
  * @param retardoaccesobloque
  * @param loglevel
+ * @param cachebloques Cantidad de bloques que se mantienen en la caché de bloques (0 = sin caché)
+ * @param readahead Si está activo, se prefetchean los próximos bloques en lecturas secuenciales
+ * @param ventanareadaheadmax Máxima cantidad de bloques a prefetchear por patrón secuencial
+ * @param hilosformateo Hilos que crean los bloques físicos en FRESH_START (0 = uno por CPU)
+ * @param checkpointintervalo Segundos entre checkpoints (0 = solo al apagar)
+ * @param umbralinline Tamaño máximo (bytes) de un File:Tag que se guarda dentro de su metadata (0 = desactivado)
+ * @param dedupenescritura Si está activo, WRITE reusa un bloque ya indexado con el mismo contenido en vez de escribir uno
+ * @param dedupdiferida Si está activo, COMMIT solo cambia el estado y la deduplicación la hace un hilo en segundo plano
+ * @param presupuestodedup Bloques por segundo que puede leer el hilo de dedup diferida (0 = sin límite)
+ * @param compactacionintervalo Segundos entre pasadas del compactador (0 = desactivado)
+ * @param presupuestocompactacion Bloques por segundo que puede mover el compactador (0 = sin límite)
+ * @param directoriosdatos DIRECTORIOS_DATOS: directorios (uno por disco) donde van los segmentos SLAB (NULL = PUNTO_MONTAJE)
+ * @param cantidaddirectoriosdatos Largo de directoriosdatos
+ * @param replicas REPLICAS: [ip:puerto,...] de las réplicas de solo lectura a las que se mandan los File:Tags COMMITED (NULL = ninguna)
+ * @param modoreplica Si está activo, este Storage es una réplica: solo acepta READ de los Workers y cambios del primario
+ * @param timeoutreplica Milisegundos que se espera cada respuesta de una réplica (y un DELETE a que la apliquen) antes de darla por caída
+ * @param planificadorio Si está activo, las operaciones de los Workers pasan por el planificador de I/O (deficit round-robin)
+ * @param operacionessimultaneas Operaciones que el planificador deja ejecutar a la vez
+ * @param quantumio Bloques que suma cada Worker por vuelta del round-robin
+ * @param agingio Turnos que un pedido ve pasar a otros más prioritarios antes de subir un nivel de prioridad
+ * @param limiteoperacionesworker Operaciones por segundo de cada Worker (0 = sin límite)
+ * @param limitesoperacionesworkers LIMITES_OPERACIONES_WORKERS: [id:ops,...] límites propios de algunos Workers (NULL = ninguno)
  * 
  * Esta estructura almacena la configuración necesaria para el
  * funcionamiento del storage
@@ -40,6 +62,28 @@ typedef struct storageconfigs {
     int retardooperacion;
     int retardoaccesobloque;
     char* loglevel;
+    int cachebloques;
+    bool readahead;
+    int ventanareadaheadmax;
+    int hilosformateo;
+    int checkpointintervalo;
+    int umbralinline;
+    bool dedupenescritura;
+    bool dedupdiferida;
+    int presupuestodedup;
+    int compactacionintervalo;
+    int presupuestocompactacion;
+    char** directoriosdatos;
+    int cantidaddirectoriosdatos;
+    char** replicas;
+    bool modoreplica;
+    int timeoutreplica;
+    bool planificadorio;
+    int operacionessimultaneas;
+    int quantumio;
+    int agingio;
+    int limiteoperacionesworker;
+    char** limitesoperacionesworkers;
 } storageconfigs;
 
 /**
@@ -80,11 +124,19 @@ void destruir_configs();
  * 
  * @param fssize
  * @param blocksize
+ * @param formatobloques "ARCHIVOS" (un archivo por bloque) o "SLAB" (bloques empaquetados en segmentos)
+ * @param tamaniosegmento Bytes por segmento en el formato SLAB
+ * @param compresion "NINGUNA" o "COLA_CEROS" (no se guardan los ceros del final de cada bloque)
+ * @param cantidaddirectoriosdatos Directorios de datos con los que se formateó el SLAB (tiene que coincidir con DIRECTORIOS_DATOS)
  */
 
 typedef struct superblockconfigs {
     int fssize;
     int blocksize;
+    char* formatobloques;
+    int tamaniosegmento;
+    char* compresion;
+    int cantidaddirectoriosdatos;
 } superblockconfigs;
 
 /**
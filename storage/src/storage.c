@@ -1,13 +1,71 @@
 #include "storage.h"
 #include "fresh_start.h"
 #include "storage_conexiones.h"
+#include "cache_bloques.h"
+#include "readahead.h"
+#include "reclamador.h"
+#include "hash_index.h"
+#include "checkpoint.h"
+#include "crecimiento_fs.h"
+#include "bloques_fisicos.h"
+#include "migracion_bloques.h"
+#include "dedup_diferida.h"
+#include "compactador.h"
+#include "replicacion.h"
+#include "planificador_io.h"
+#include <signal.h>
+
+/**
+ * @brief Hilo que atiende SIGINT / SIGTERM: deja el FS consistente y guarda el checkpoint
+ * antes de salir. SIGHUP agranda el FS al FS_SIZE actual de superblock.config.
+ * Las señales están bloqueadas en el resto de los hilos.
+ */
+static void* atender_senales(void* arg) {
+    sigset_t* senales = arg;
+    int senal;
+
+    while (1) {
+        if (sigwait(senales, &senal) != 0) continue;
+
+        if (senal == SIGHUP) {
+            crecer_fs();
+            continue;
+        }
+
+        if (senal == SIGINT || senal == SIGTERM) {
+            log_info(logger_storage, "## Storage finalizando (señal %d).", senal);
+            storage_dejar_de_atender(); // Primero se vacían las operaciones: usan todo lo que sigue
+            destruir_replicacion();
+            destruir_compactador();
+            destruir_dedup_diferida(); // Lo pendiente queda marcado para el próximo arranque
+            destruir_reclamador();  // Termina lo que quedó en la papelera
+            destruir_readahead();
+            checkpoint_final();     // No suelta lock_fs: no entra ninguna operación más
+            hash_index_guardar();
+            destruir_bloques_fisicos();
+            destruir_bitmap();
+            destruir_logger();
+            exit(EXIT_SUCCESS);
+        }
+    }
+    return NULL;
+}
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Uso: %s [archivo_config]\n", argv[0]);
+    bool migrar = argc == 3 && (strcmp(argv[2], "--migrar-a-slab") == 0 || strcmp(argv[2], "--migrar-a-archivos") == 0);
+    if (argc != 2 && !migrar) {
+        fprintf(stderr, "Uso: %s [archivo_config] [--migrar-a-slab | --migrar-a-archivos]\n", argv[0]);
         return EXIT_FAILURE;
     }
 
+    // Las señales de apagado (y SIGHUP para crecer el FS) las atiende un solo hilo (los que se crean después heredan la máscara)
+    static sigset_t senales;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGINT);
+    sigaddset(&senales, SIGTERM);
+    sigaddset(&senales, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &senales, NULL);
+
     // Cargar configuración y logger
     inicializar_configs(argv[1]);
     inicializar_logger_storage(storage_configs.loglevel);
@@ -15,10 +73,46 @@ int main(int argc, char* argv[]) {
     log_info(logger_storage, "## Storage inicializado.");
 
     inicializar_superblock_configs(); 
+
+    // Migración del formato de los bloques físicos (con Storage apagado)
+    if (migrar) {
+        int resultado = migrar_formato_bloques(strcmp(argv[2], "--migrar-a-slab") == 0 ? FORMATO_SLAB : FORMATO_ARCHIVOS);
+        destruir_logger();
+        return resultado;
+    }
     
     // Inicializar el File System si es FRESH_START
     inicializar_fs(); 
 
+    // Índice de deduplicación en memoria (necesita el bitmap ya cargado)
+    inicializar_hash_index(superblock_configs.fssize / superblock_configs.blocksize);
+
+    // Caché de bloques y readahead (opcionales, según config)
+    inicializar_cache_bloques(storage_configs.cachebloques, superblock_configs.blocksize);
+    inicializar_readahead();
+
+    // Checkpoint: arranque rápido o escaneo de files/ (antes de que arranque el reclamador)
+    inicializar_checkpoint();
+
+    pthread_t hilo_senales;
+    pthread_create(&hilo_senales, NULL, atender_senales, &senales);
+    pthread_detach(hilo_senales);
+
+    // Reclamador de bloques de DELETE / TRUNCATE (retoma lo que quedó en la papelera)
+    inicializar_reclamador();
+
+    // Dedup en segundo plano de los COMMIT (opcional, DEDUP_DIFERIDA)
+    inicializar_dedup_diferida();
+
+    // Compactador de bloques físicos de los File:Tags COMMITED (opcional, COMPACTACION_INTERVALO)
+    inicializar_compactador();
+
+    // Turnos y límites de las operaciones de los Workers (opcional, PLANIFICADOR_IO)
+    inicializar_planificador_io();
+
+    // Envío de los File:Tags COMMITED a las réplicas de solo lectura (opcional, REPLICAS)
+    inicializar_replicacion();
+
     // Iniciar el servidor
     char* puerto_str = string_itoa(storage_configs.puertoescucha);
     int socket_servidor = iniciar_servidor(puerto_str);
@@ -37,6 +131,17 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    destruir_replicacion();
+    destruir_planificador_io();
+    destruir_compactador();
+    destruir_dedup_diferida();
+    destruir_reclamador();
+    destruir_readahead();
+    checkpoint_escribir();
+    destruir_checkpoint();
+    destruir_cache_bloques();
+    destruir_hash_index();
+    destruir_bloques_fisicos();
     destruir_bitmap();
     destruir_logger();
     destruir_configs();
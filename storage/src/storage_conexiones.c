@@ -1,10 +1,72 @@
 #include "storage_conexiones.h"
+#include "readahead.h"
+#include "checkpoint.h"
+#include "replicacion.h"
+#include "planificador_io.h"
 #include <pthread.h>
 
 // --- Variables Globales para contar Workers ---
 static int cantidad_workers_conectados = 0;
 pthread_mutex_t mutex_conteo_workers = PTHREAD_MUTEX_INITIALIZER;
 
+// Operaciones recibidas que todavía no terminaron (la compactación se frena mientras haya).
+// Al apagar Storage se dejan de atender y se espera a que terminen las que están en curso
+static int operaciones_en_curso = 0;
+static bool atendiendo_operaciones = true;
+static pthread_mutex_t mutex_operaciones = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_sin_operaciones = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Anota para el próximo checkpoint los File:Tags que toca la operación.
+ */
+static void marcar_cambios_checkpoint(t_codigo_operacion codigo, t_op_storage* op) {
+    if (op == NULL) {
+        checkpoint_marcar_sucio();
+        return;
+    }
+    char* path_tag = string_from_format("%s/files/%s/%s", storage_configs.puntomontaje, op->nombre_file, op->nombre_tag);
+    checkpoint_marcar_cambio(path_tag);
+    free(path_tag);
+
+    if (codigo == TAG) {
+        char* path_destino = string_from_format("%s/files/%s/%s", storage_configs.puntomontaje,
+                                                op->nombre_file_destino, op->nombre_tag_destino);
+        checkpoint_marcar_cambio(path_destino);
+        free(path_destino);
+    }
+}
+
+int storage_operaciones_en_curso() {
+    return __atomic_load_n(&operaciones_en_curso, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Cuenta una operación nueva.
+ * @return false si Storage se está apagando (la operación no se ejecuta).
+ */
+static bool empezar_operacion() {
+    pthread_mutex_lock(&mutex_operaciones);
+    bool atendida = atendiendo_operaciones;
+    if (atendida) __atomic_add_fetch(&operaciones_en_curso, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&mutex_operaciones);
+    return atendida;
+}
+
+static void terminar_operacion() {
+    pthread_mutex_lock(&mutex_operaciones);
+    if (__atomic_sub_fetch(&operaciones_en_curso, 1, __ATOMIC_RELAXED) == 0) {
+        pthread_cond_broadcast(&cond_sin_operaciones);
+    }
+    pthread_mutex_unlock(&mutex_operaciones);
+}
+
+void storage_dejar_de_atender() {
+    pthread_mutex_lock(&mutex_operaciones);
+    atendiendo_operaciones = false;
+    while (operaciones_en_curso > 0) pthread_cond_wait(&cond_sin_operaciones, &mutex_operaciones);
+    pthread_mutex_unlock(&mutex_operaciones);
+}
+
 // Renombramos "atender_worker" a "gestionar_conexion_worker"
 void* gestionar_conexion_worker(void* arg) {
     int socket_worker = *((int*) arg);
@@ -13,7 +75,10 @@ void* gestionar_conexion_worker(void* arg) {
     // --- 1. Handshake Inicial ---
     t_paquete* paquete_handshake = recibir_paquete(socket_worker);
     uint32_t worker_id;
-    if (paquete_handshake == NULL || paquete_handshake->codigo_operacion != HANDSHAKE_WORKER) {
+    // Una réplica (MODO_REPLICA) también acepta la conexión del Storage primario
+    bool es_primario = paquete_handshake != NULL && storage_configs.modoreplica &&
+                       paquete_handshake->codigo_operacion == HANDSHAKE_REPLICACION;
+    if (paquete_handshake == NULL || (paquete_handshake->codigo_operacion != HANDSHAKE_WORKER && !es_primario)) {
         log_error(logger_storage, "## Se desconecta un Worker (falló el handshake inicial).");
         if (paquete_handshake) liberar_paquete(paquete_handshake);
         close(socket_worker);
@@ -23,13 +88,25 @@ void* gestionar_conexion_worker(void* arg) {
     liberar_paquete(paquete_handshake);
 
     //Cant workers
-    pthread_mutex_lock(&mutex_conteo_workers);
-    cantidad_workers_conectados++;
-    int total_actual = cantidad_workers_conectados; // Copia local
-    pthread_mutex_unlock(&mutex_conteo_workers);
+    int total_actual = 0;
+    if (es_primario) {
+        // El primario manda todo de nuevo: se empieza de cero
+        log_info(logger_storage, "## Se conecta el Storage primario (replicación)");
+        if (!empezar_operacion()) {
+            close(socket_worker);
+            return NULL;
+        }
+        replicacion_vaciar_replica();
+        terminar_operacion();
+    } else {
+        pthread_mutex_lock(&mutex_conteo_workers);
+        cantidad_workers_conectados++;
+        total_actual = cantidad_workers_conectados; // Copia local
+        pthread_mutex_unlock(&mutex_conteo_workers);
 
-    // Logueamos con el valor real
-    log_info(logger_storage, "## Se conecta el Worker %d Cantidad de Workers: %d", worker_id, total_actual);
+        // Logueamos con el valor real
+        log_info(logger_storage, "## Se conecta el Worker %d Cantidad de Workers: %d", worker_id, total_actual);
+    }
 
     t_buffer* buffer_rta_handshake = buffer_create(sizeof(uint32_t));
     buffer_add_uint32(buffer_rta_handshake, superblock_configs.blocksize);
@@ -42,6 +119,10 @@ void* gestionar_conexion_worker(void* arg) {
     while(1) {
         t_paquete* paquete = recibir_paquete(socket_worker);
 
+        if (paquete == NULL && es_primario) {
+            log_warning(logger_storage, "## Se desconecta el Storage primario: se siguen sirviendo los File:Tags replicados");
+            break;
+        }
         if (paquete == NULL) {
             pthread_mutex_lock(&mutex_conteo_workers);
             cantidad_workers_conectados--;
@@ -49,16 +130,43 @@ void* gestionar_conexion_worker(void* arg) {
             pthread_mutex_unlock(&mutex_conteo_workers);
 
             log_info(logger_storage, "## Se desconecta el Worker %d Cantidad de Workers: %d", worker_id, total_actual);
+            readahead_olvidar_worker(worker_id);
             break; // no seguir usando un paquete nulo
         }
 
+        // Storage se está apagando: no se empieza nada más
+        if (!empezar_operacion()) {
+            liberar_paquete(paquete);
+            break;
+        }
+
         t_codigo_operacion op_respuesta = OP_OK; 
         
         t_op_storage* op_storage = deserializar_op_storage(paquete->buffer, paquete->codigo_operacion);
         
-        // op_storage->worker_id = worker_id; 
+        if (op_storage != NULL) op_storage->worker_id = worker_id;
+
+        // Réplica: los Workers solo leen (que lo leído esté COMMITED se chequea junto con la lectura)
+        bool lectura_en_replica = storage_configs.modoreplica && !es_primario;
+        if (lectura_en_replica && op_storage != NULL && paquete->codigo_operacion != READ) {
+            log_warning(logger_storage, "##%d Réplica de solo lectura: se rechaza la operación %d del Worker %d", op_storage->query_id, paquete->codigo_operacion, worker_id);
+            destruir_op_storage(op_storage);
+            liberar_paquete(paquete);
+            terminar_operacion();
+            enviar_paquete(socket_worker, empaquetar_buffer(ESCRITURA_NO_PERMITIDA, NULL));
+            continue;
+        }
+
+        // Turno del planificador de I/O (el retardo de la operación ya cuenta como I/O). Lo que
+        // manda el primario no compite con las lecturas de los Workers: si esperara detrás de
+        // ellas, los DELETE del primario se quedarían esperando a la réplica hasta el timeout
+        if (!es_primario) planificador_io_entrar(worker_id, paquete->codigo_operacion, op_storage);
         usleep(storage_configs.retardooperacion*1000);
 
+        // Las operaciones van en paralelo entre ellas; solo el checkpoint las frena
+        pthread_rwlock_rdlock(&lock_fs);
+        if (paquete->codigo_operacion != READ) marcar_cambios_checkpoint(paquete->codigo_operacion, op_storage);
+
         switch (paquete->codigo_operacion) {
             
             case CREATE:
@@ -87,7 +195,14 @@ void* gestionar_conexion_worker(void* arg) {
 
             case READ: {
                 char* contenido_leido = NULL;
-                op_respuesta = storage_op_read(op_storage, &contenido_leido);
+                int tamanio_leido = 0;
+                // En una réplica solo se sirven File:Tags que ya terminaron de llegar (COMMITED); con el
+                // mismo lock_fs que la lectura, así no se cuela un DELETE o un reenvío del primario
+                if (lectura_en_replica && !storage_file_tag_commited(op_storage->nombre_file, op_storage->nombre_tag)) {
+                    op_respuesta = FILE_TAG_INEXISTENTE;
+                    break;
+                }
+                op_respuesta = storage_op_read(op_storage, &contenido_leido, &tamanio_leido);
 
                 if (op_respuesta == OP_OK) {
                     // --- Enviar respuesta de LECTURA ---
@@ -95,14 +210,17 @@ void* gestionar_conexion_worker(void* arg) {
                     t_op_storage op_rta;
                     op_rta.contenido = contenido_leido; 
                     
-                    // Como leemos bloques completos, el tamaño es el BLOCK_SIZE
-                    op_rta.tamano_contenido = superblock_configs.blocksize;
+                    // Solo los bytes pedidos (el bloque entero si no se pidió un rango)
+                    op_rta.tamano_contenido = tamanio_leido;
 
                     t_buffer* buffer_rta = serializar_op_storage(&op_rta, READ_RTA);
                     t_paquete* paq_rta = empaquetar_buffer(READ_RTA, buffer_rta);
                     enviar_paquete(socket_worker, paq_rta);
                     
                     free(contenido_leido);
+                    pthread_rwlock_unlock(&lock_fs);
+                    if (!es_primario) planificador_io_salir();
+                    terminar_operacion();
                     
                     // Liberamos y saltamos la respuesta OK/ERROR default
                     destruir_op_storage(op_storage);
@@ -122,6 +240,16 @@ void* gestionar_conexion_worker(void* arg) {
                 op_respuesta = OP_ERROR; 
                 break;
         }
+        pthread_rwlock_unlock(&lock_fs);
+        if (!es_primario) planificador_io_salir();
+
+        // Un DELETE termina cuando las réplicas ya no sirven ese File:Tag; si alguna no lo
+        // confirmó, el Worker se entera para no darlo por borrado en todos lados
+        if (paquete->codigo_operacion == DELETE && op_respuesta == OP_OK && !replicacion_esperar()) {
+            log_warning(logger_storage, "DELETE %s:%s sin confirmar en las réplicas.", op_storage->nombre_file, op_storage->nombre_tag);
+            op_respuesta = OP_ERROR;
+        }
+        terminar_operacion();
         
         destruir_op_storage(op_storage);
         liberar_paquete(paquete); 
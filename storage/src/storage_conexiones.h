@@ -15,4 +15,15 @@
  */
 void* gestionar_conexion_worker(void* arg);
 
+/**
+ * @brief Cantidad de operaciones de Workers que están en curso (para medir la carga).
+ */
+int storage_operaciones_en_curso();
+
+/**
+ * @brief Apagado: deja de aceptar operaciones y espera a que terminen las que están en curso.
+ * Después de esto ningún hilo de Worker toca el FS ni los componentes de Storage.
+ */
+void storage_dejar_de_atender();
+
 #endif
\ No newline at end of file
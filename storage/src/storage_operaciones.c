@@ -1,5 +1,14 @@
 #include "storage_operaciones.h"
 #include "bitmap.h"
+#include "cache_bloques.h"
+#include "readahead.h"
+#include "reclamador.h"
+#include "hash_index.h"
+#include "bloques_fisicos.h"
+#include "contenido_inline.h"
+#include "dedup_diferida.h"
+#include "replicacion.h"
+#include <errno.h>
 
 /**
  * @brief Función auxiliar para validar si un directorio existe.
@@ -55,6 +64,52 @@ t_codigo_operacion storage_op_create(t_op_storage* op) {
     return OP_OK;
 }
 
+/**
+ * @brief Pasa el contenido inline de un File:Tag a bloques físicos reales (uno por cada
+ * BLOCK_SIZE del tamaño actual). Deja BLOCKS armado en el metadata y saca el contenido inline.
+ * @return false si no hay lugar (no queda nada reservado).
+ */
+static bool promover_contenido_inline(t_op_storage* op, t_config* metadata, char* path_tag) {
+    int tamanio_actual = config_get_int_value(metadata, "TAMAÑO");
+    int cantidad_bloques = tamanio_actual / superblock_configs.blocksize;
+    char* contenido = contenido_inline_leer(metadata, tamanio_actual);
+    char** bloques = calloc(cantidad_bloques + 1, sizeof(char*));
+    bool exito = true;
+
+    for (int i = 0; i < cantidad_bloques; i++) {
+        int nro_bloque_fisico = reservar_bloque_real(op->query_id);
+        if (nro_bloque_fisico == -1) {
+            // Rollback de lo que se llegó a reservar
+            for (int j = 0; j < i; j++) {
+                bloque_fisico_desenlazar(atoi(bloques[j]), path_tag, j);
+                liberar_bloque(atoi(bloques[j]));
+            }
+            exito = false;
+            break;
+        }
+        escribir_en_bloque_fisico(nro_bloque_fisico, contenido + i * superblock_configs.blocksize,
+                                  superblock_configs.blocksize, superblock_configs.blocksize);
+        cache_invalidar_bloque(nro_bloque_fisico);
+        bloque_fisico_enlazar(nro_bloque_fisico, path_tag, i);
+        bloques[i] = string_itoa(nro_bloque_fisico);
+        log_info(logger_storage, "##%d Hard Link Agregado: %s:%s, Bloque Lógico %d -> Bloque Físico %d",
+                 op->query_id, op->nombre_file, op->nombre_tag, i, nro_bloque_fisico);
+    }
+
+    if (exito) {
+        char* bloques_str = array_to_blocks_string(bloques, cantidad_bloques);
+        config_set_value(metadata, "BLOCKS", bloques_str);
+        contenido_inline_guardar(metadata, NULL, 0);
+        free(bloques_str);
+        log_info(logger_storage, "##%d %s:%s deja de ser inline: %d bloques físicos",
+                 op->query_id, op->nombre_file, op->nombre_tag, cantidad_bloques);
+    }
+
+    string_array_destroy(bloques);
+    free(contenido);
+    return exito;
+}
+
 t_codigo_operacion storage_op_truncate(t_op_storage* op) {
     
     // 0. Validar que el tamaño sea múltiplo de BLOCK_SIZE
@@ -88,63 +143,80 @@ t_codigo_operacion storage_op_truncate(t_op_storage* op) {
         return ESCRITURA_NO_PERMITIDA; 
     }
 
+    // 3.b. File:Tags chicos (UMBRAL_INLINE): el contenido vive en el metadata, sin bloques
+    bool es_inline = metadata_es_inline(metadata);
+    int tamanio_actual = config_get_int_value(metadata, "TAMAÑO");
+    if ((es_inline && (op->tamano == 0 || tamanio_entra_inline(op->tamano))) ||
+        (tamanio_actual == 0 && tamanio_entra_inline(op->tamano))) {
+        char* contenido = contenido_inline_leer(metadata, op->tamano); // Se corta o se completa con ceros
+        contenido_inline_guardar(metadata, contenido, op->tamano);
+        char* tamano_str = string_itoa(op->tamano);
+        config_set_value(metadata, "TAMAÑO", tamano_str);
+        config_save(metadata);
+
+        log_info(logger_storage, "##%d File Truncado %s:%s Tamaño: %d", op->query_id, op->nombre_file, op->nombre_tag, op->tamano);
+
+        free(tamano_str); free(contenido);
+        config_destroy(metadata);
+        free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
+        return OP_OK;
+    }
+    // Crece por encima del umbral: primero pasa a bloques reales y sigue como cualquier otro
+    if (es_inline && !promover_contenido_inline(op, metadata, path_tag)) {
+        config_destroy(metadata);
+        free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
+        return ESPACIO_INSUFICIENTE;
+    }
+
     // 4. Calcular bloques
     char** bloques_actuales_array = config_get_array_value(metadata, "BLOCKS");
     int bloques_actuales_count = string_array_size(bloques_actuales_array);
     int bloques_nuevos_count = op->tamano / superblock_configs.blocksize;
     int diff = bloques_nuevos_count - bloques_actuales_count;
 
-    char* path_bloque_fisico_0 = string_from_format("%s/physical_blocks/block0000.dat", storage_configs.puntomontaje);
-
     // 5. Aplicar lógica
     if (diff > 0) {
         // --- AGRANDAR ---
         for (int i = 0; i < diff; i++) {
             int nro_bloque_logico = bloques_actuales_count + i;
-            char* nombre_logico = string_from_format("%06d.dat", nro_bloque_logico);
-            char* path_bloque_logico = string_from_format("%s/%s", path_logical_blocks_dir, nombre_logico);
 
             // Crear hard link al bloque físico 0 
-            if (link(path_bloque_fisico_0, path_bloque_logico) == -1) {
+            if (!bloque_fisico_enlazar(0, path_tag, nro_bloque_logico)) {
                  log_error(logger_storage, "Error al crear hard link para bloque lógico %d", nro_bloque_logico);
             } else {
                  log_info(logger_storage, "##%d Hard Link Agregado: %s:%s, Bloque Lógico %d -> Bloque Físico 0",
                           op->query_id, op->nombre_file, op->nombre_tag, nro_bloque_logico);
             }
-            free(nombre_logico);
-            free(path_bloque_logico);
         }
     } 
     else if (diff < 0) {
         // --- ACHICAR ---
-        for (int i = bloques_actuales_count - 1; i >= bloques_nuevos_count; i--) {
-            char* nro_bloque_fisico_str = bloques_actuales_array[i];
-            char* nombre_logico = string_from_format("%06d.dat", i);
-            char* path_bloque_logico = string_from_format("%s/%s", path_logical_blocks_dir, nombre_logico);
-            char* path_bloque_fisico = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                                         storage_configs.puntomontaje, 
-                                                         atoi(nro_bloque_fisico_str));
-            
-            // Eliminar hard link
-            if (unlink(path_bloque_logico) == -1) {
-                log_error(logger_storage, "Error al eliminar hard link para bloque lógico %d", i);
-            } else {
-                 log_info(logger_storage, "##%d Hard Link Eliminado: %s:%s, Bloque Lógico %d (apuntaba a Físico %s)",
-                          op->query_id, op->nombre_file, op->nombre_tag, i, nro_bloque_fisico_str);
-            }
+        // Los hard links de la cola se mueven a la papelera y el reclamador libera los
+        // bloques físicos en segundo plano. Mover el link no cambia las referencias, así
+        // que los bloques siguen ocupados hasta que el reclamador los procese.
+        char* path_papelera = reclamador_nuevo_path_papelera();
+        char* path_papelera_bloques = string_from_format("%s/logical_blocks", path_papelera);
+        mkdir(path_papelera, 0777);
+        mkdir(path_papelera_bloques, 0777);
+
+        // Primero la metadata: si Storage se cae a mitad de camino, el reclamador sabe qué hay
+        char* bloques_a_reclamar = array_to_blocks_string(bloques_actuales_array + bloques_nuevos_count, -diff);
+        char* path_papelera_metadata = string_from_format("%s/metadata.config", path_papelera);
+        FILE* archivo_papelera = fopen(path_papelera_metadata, "w");
+        if (archivo_papelera != NULL) {
+            fprintf(archivo_papelera, "BLOCKS=%s\nPRIMER_BLOQUE_LOGICO=%d\n", bloques_a_reclamar, bloques_nuevos_count);
+            fclose(archivo_papelera);
+        }
 
-            // --- Lógica de liberación de bloque físico ---
-            struct stat st;
-            if (stat(path_bloque_fisico, &st) == 0) {
-                // Si nlink == 1 y NO es el bloque 0, liberar
-                if (st.st_nlink == 1 && atoi(nro_bloque_fisico_str) != 0) {
-                    int bloque_a_liberar = atoi(nro_bloque_fisico_str);
-                    liberar_bloque(bloque_a_liberar);       
-                    log_info(logger_storage, "##%d Bloque Físico Liberado %d", op->query_id, bloque_a_liberar);
-                }
+        for (int i = bloques_nuevos_count; i < bloques_actuales_count; i++) {
+            if (!bloque_fisico_mover_enlace(path_tag, i, path_papelera, i - bloques_nuevos_count)) {
+                log_error(logger_storage, "Error al mover a la papelera el hard link del bloque lógico %d", i);
             }
-            free(nombre_logico); free(path_bloque_logico); free(path_bloque_fisico);
         }
+        reclamador_encolar(path_papelera, op->query_id, op->nombre_file, op->nombre_tag);
+
+        free(bloques_a_reclamar); free(path_papelera_metadata);
+        free(path_papelera); free(path_papelera_bloques);
     }
 
     // 6. Actualizar y guardar metadata 
@@ -157,7 +229,7 @@ t_codigo_operacion storage_op_truncate(t_op_storage* op) {
     
     log_info(logger_storage, "##%d File Truncado %s:%s Tamaño: %d", op->query_id, op->nombre_file, op->nombre_tag, op->tamano);
     
-    free(tamano_str); free(nuevo_array_str); free(path_bloque_fisico_0);
+    free(tamano_str); free(nuevo_array_str);
     string_array_destroy(bloques_actuales_array);
     config_destroy(metadata);
     free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
@@ -224,25 +296,22 @@ t_codigo_operacion storage_op_tag(t_op_storage* op) {
     fprintf(f_metadata_destino, "TAMAÑO=%s\n", tamano_str);
     fprintf(f_metadata_destino, "ESTADO=WORK_IN_PROGRESS\n");
     fprintf(f_metadata_destino, "BLOCKS=%s\n", bloques_str);
+    if (metadata_es_inline(metadata_origen)) {
+        fprintf(f_metadata_destino, "%s=%s\n", CLAVE_CONTENIDO_INLINE,
+                config_get_string_value(metadata_origen, CLAVE_CONTENIDO_INLINE));
+    }
     fclose(f_metadata_destino);
 
     // 7. Replicar los hard links en el directorio de destino
     for (int i = 0; i < num_bloques; i++) {
         char* nro_bloque_fisico_str = bloques_array[i];
-        char* nombre_logico_destino = string_from_format("%06d.dat", i);
-        char* path_bloque_logico_destino = string_from_format("%s/%s", path_logical_blocks_destino, nombre_logico_destino);
-        char* path_bloque_fisico = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                                     storage_configs.puntomontaje, 
-                                                     atoi(nro_bloque_fisico_str));
 
-        if (link(path_bloque_fisico, path_bloque_logico_destino) == -1) {
+        if (!bloque_fisico_enlazar(atoi(nro_bloque_fisico_str), path_tag_destino, i)) {
             log_error(logger_storage, "Error al replicar hard link para bloque lógico %d (físico %s)", i, nro_bloque_fisico_str);
         } else {
             log_info(logger_storage, "##%d Hard Link Agregado: %s:%s, Bloque Lógico %d -> Bloque Físico %s",
                      op->query_id, op->nombre_file_destino, op->nombre_tag_destino, i, nro_bloque_fisico_str);
         }
-        
-        free(nombre_logico_destino); free(path_bloque_logico_destino); free(path_bloque_fisico);
     }
 
     // 8. Loguear éxito y liberar memoria
@@ -267,53 +336,25 @@ t_codigo_operacion storage_op_delete(t_op_storage* op) {
     char* path_metadata = string_from_format("%s/metadata.config", path_tag);
     char* path_logical_blocks_dir = string_from_format("%s/logical_blocks", path_tag);
 
-    // 2. Validar y leer metadata
-    t_config* metadata = config_create(path_metadata);
-    if (metadata == NULL) {
+    // 2. Validar que exista
+    if (access(path_metadata, F_OK) != 0) {
         log_error(logger_storage, "##%d Error: No se encontró File/Tag %s:%s para eliminar", op->query_id, op->nombre_file, op->nombre_tag);
         free(path_file); free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
         return FILE_TAG_INEXISTENTE; 
     }
 
-    // 3. Eliminar Links y Chequear Físicos
-    char** bloques_array = config_get_array_value(metadata, "BLOCKS");
-    int num_bloques = string_array_size(bloques_array);
-
-    for (int i = 0; i < num_bloques; i++) {
-        char* nro_bloque_fisico_str = bloques_array[i];
-        char* nombre_logico = string_from_format("%06d.dat", i);
-        char* path_bloque_logico = string_from_format("%s/%s", path_logical_blocks_dir, nombre_logico);
-        char* path_bloque_fisico = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                                     storage_configs.puntomontaje, 
-                                                     atoi(nro_bloque_fisico_str));
-
-        // 3.a. Eliminar el hard link
-        if (unlink(path_bloque_logico) == -1) {
-            log_error(logger_storage, "Error al eliminar hard link para bloque lógico %d", i);
-        } else {
-             log_info(logger_storage, "##%d Hard Link Eliminado: %s:%s, Bloque Lógico %d (apuntaba a Físico %s)",
-                      op->query_id, op->nombre_file, op->nombre_tag, i, nro_bloque_fisico_str);
-        }
-
-        struct stat st;
-        if (stat(path_bloque_fisico, &st) == 0) {
-            // Liberar si nlink == 1 y no es bloque 0
-            if (st.st_nlink == 1 && atoi(nro_bloque_fisico_str) != 0) {
-                log_info(logger_storage, "Bloque físico %s ya no está referenciado. Liberando...", nro_bloque_fisico_str);
-                liberar_bloque(atoi(nro_bloque_fisico_str));            
-                log_info(logger_storage, "##%d Bloque Físico Liberado %s", op->query_id, nro_bloque_fisico_str);
-            }
-        }
-        free(nombre_logico); free(path_bloque_logico); free(path_bloque_fisico);
+    // 3. Mover el Tag entero a la papelera (rename es atómico: desde acá el Tag ya no existe).
+    //    Los hard links y los bloques físicos los libera el reclamador en segundo plano.
+    char* path_papelera = reclamador_nuevo_path_papelera();
+    if (rename(path_tag, path_papelera) == -1) {
+        log_error(logger_storage, "##%d Error: No se pudo eliminar %s:%s (%s)", op->query_id, op->nombre_file, op->nombre_tag, strerror(errno));
+        free(path_papelera);
+        free(path_file); free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
+        return OP_ERROR;
     }
-
-    // 4. Eliminar los archivos y directorios
-    string_array_destroy(bloques_array);
-    config_destroy(metadata);
-
-    unlink(path_metadata); // Borra metadata.config
-    rmdir(path_logical_blocks_dir); // Borra /logical_blocks (debe estar vacío)
-    rmdir(path_tag); // Borra /TAG (debe estar vacío)
+    reclamador_encolar(path_papelera, op->query_id, op->nombre_file, op->nombre_tag);
+    free(path_papelera);
+    replicacion_encolar_delete(op->query_id, op->nombre_file, op->nombre_tag);
 
     // Opcional: Borrar dir del File si está vacío
     DIR* dir = opendir(path_file);
@@ -335,6 +376,62 @@ t_codigo_operacion storage_op_delete(t_op_storage* op) {
     return OP_OK;
 }
 
+bool deduplicar_file_tag(int query_id, char* nombre_file, char* nombre_tag, char* path_tag,
+                         char** bloques_array, int desde, int hasta, char** hashes) {
+    bool modificado = false;
+
+    for (int i = desde; i < hasta; i++) {
+        int nro_bloque_fisico_actual = atoi(bloques_array[i]);
+        
+        // a. Calcular MD5 (salvo que ya venga calculado)
+        char* hash_actual = hashes != NULL ? hashes[i - desde] : calcular_hash_bloque_fisico(nro_bloque_fisico_actual);
+        if (hash_actual == NULL) {
+            if (hashes == NULL) log_error(logger_storage, "##%d Deduplicación: No se pudo leer el bloque físico block%04d", query_id, nro_bloque_fisico_actual);
+            continue;
+        }
+
+        // b. Buscar hash en index (si hay otro bloque igual, el link ya queda apuntando a ese)
+        int nro_bloque_existente = hash_index_buscar_y_enlazar(hash_actual, nro_bloque_fisico_actual, path_tag, i);
+
+        if (nro_bloque_existente != -1 && nro_bloque_existente != nro_bloque_fisico_actual) {
+            // --- Deduplicación --- 
+            log_info(logger_storage, "##%d Deduplicación: Bloque Lógico %d (hash: %s) puede usar bloque físico block%04d",
+                     query_id, i, hash_actual, nro_bloque_existente);
+
+            chequear_y_liberar_bloque_fisico(query_id, bloques_array[i]);
+            
+            // 3. Actualizar array en memoria para guardar en metadata
+            free(bloques_array[i]);
+            bloques_array[i] = string_itoa(nro_bloque_existente); 
+            modificado = true;
+
+            log_info(logger_storage, "##%d Deduplicación de Bloque: %s:%s Bloque Lógico %d se reasigna de %d a %d",
+                     query_id, nombre_file, nombre_tag, i, nro_bloque_fisico_actual, nro_bloque_existente);
+
+        } else if (nro_bloque_existente == -1) {
+            // --- Hash no existe, agregarlo --- 
+            log_info(logger_storage, "Hash %s no encontrado. Agregando al índice (Bloque: block%04d)", hash_actual, nro_bloque_fisico_actual);
+            hash_index_agregar(hash_actual, nro_bloque_fisico_actual);
+        }
+        
+        if (hashes == NULL) free(hash_actual);
+    }
+    return modificado;
+}
+
+bool storage_file_tag_commited(char* nombre_file, char* nombre_tag) {
+    char* path_metadata = string_from_format("%s/files/%s/%s/metadata.config",
+                                             storage_configs.puntomontaje, nombre_file, nombre_tag);
+    t_config* metadata = config_create(path_metadata);
+    free(path_metadata);
+    if (metadata == NULL) return false;
+
+    bool commited = config_has_property(metadata, "ESTADO") &&
+                    strcmp(config_get_string_value(metadata, "ESTADO"), "COMMITED") == 0;
+    config_destroy(metadata);
+    return commited;
+}
+
 t_codigo_operacion storage_op_commit(t_op_storage* op) {
     log_info(logger_storage, "Iniciando COMMIT para %s:%s", op->nombre_file, op->nombre_tag);
 
@@ -343,13 +440,12 @@ t_codigo_operacion storage_op_commit(t_op_storage* op) {
                                       storage_configs.puntomontaje, op->nombre_file, op->nombre_tag);
     char* path_metadata = string_from_format("%s/metadata.config", path_tag);
     char* path_logical_blocks_dir = string_from_format("%s/logical_blocks", path_tag);
-    char* path_hash_index = string_from_format("%s/blocks_hash_index.config", storage_configs.puntomontaje);
 
     // 2. Abrir metadata
     t_config* metadata = config_create(path_metadata);
     if (metadata == NULL) {
         log_error(logger_storage, "##%d Error COMMIT: Metadata no encontrada", op->query_id);
-        free(path_tag); free(path_metadata); free(path_logical_blocks_dir); free(path_hash_index);
+        free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
         return FILE_TAG_INEXISTENTE; 
     }
 
@@ -357,94 +453,23 @@ t_codigo_operacion storage_op_commit(t_op_storage* op) {
     if (strcmp(estado, "COMMITED") == 0) {
         log_info(logger_storage, "##%d File:Tag %s:%s ya estaba en estado COMMITED. No se hace nada.", op->query_id, op->nombre_file, op->nombre_tag);
         config_destroy(metadata);
-        free(path_tag); free(path_metadata); free(path_logical_blocks_dir); free(path_hash_index);
+        free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
         return OP_OK; 
     }
 
-    // 3. Abrir hash index
-    t_config* hash_index_config = config_create(path_hash_index);
-    if (hash_index_config == NULL) {
-         log_error(logger_storage, "##%d Error: No se pudo abrir blocks_hash_index.config", op->query_id);
-         config_destroy(metadata);
-         free(path_tag); free(path_metadata); free(path_logical_blocks_dir); free(path_hash_index);
-         return FILE_TAG_INEXISTENTE;
-    }
-
-    // 4. Iterar bloques lógicos
+    // 3. El hash index ya está en memoria (hash_index.c), no hace falta abrir el archivo
     char** bloques_array = config_get_array_value(metadata, "BLOCKS");
     int num_bloques = string_array_size(bloques_array);
     bool metadata_modificado = false; // Flag para saber si debemos guardar
 
-    for (int i = 0; i < num_bloques; i++) {
-        char* nro_bloque_fisico_actual_str = bloques_array[i];
-        char* nombre_bloque_fisico_actual = string_from_format("block%04d", atoi(nro_bloque_fisico_actual_str));
-        char* path_bloque_fisico_actual = string_from_format("%s/physical_blocks/%s.dat", 
-                                                            storage_configs.puntomontaje,
-                                                            nombre_bloque_fisico_actual);
-        
-        // --- 4.a. Calcular MD5 (Bloque corregido) ---
-        char* hash_actual;
-        int fd_bloque = open(path_bloque_fisico_actual, O_RDONLY);
-        if (fd_bloque == -1) {
-            log_error(logger_storage, "##%d COMMIT: No se pudo abrir el bloque físico %s", op->query_id, nombre_bloque_fisico_actual);
-            hash_actual = string_duplicate(""); // Hash vacío para evitar fallos
-        } else {
-            // Mapeamos el archivo (bloque) a memoria
-            void* buffer_bloque = mmap(NULL, superblock_configs.blocksize, PROT_READ, MAP_SHARED, fd_bloque, 0);
-            if (buffer_bloque == MAP_FAILED) {
-                log_error(logger_storage, "##%d COMMIT: No se pudo mapear el bloque %s", op->query_id, nombre_bloque_fisico_actual);
-                hash_actual = string_duplicate("");
-            } else {
-                hash_actual = crypto_md5(buffer_bloque, superblock_configs.blocksize);
-                munmap(buffer_bloque, superblock_configs.blocksize); // Liberamos el mapeo
-            }
-            close(fd_bloque); // Cerramos el archivo
-        }
-        // --- Fin bloque MD5 ---
-
-        // 4.b. Buscar hash en index 
-        char* nombre_bloque_existente = config_get_string_value(hash_index_config, hash_actual);
-
-        if (nombre_bloque_existente != NULL && strcmp(nombre_bloque_existente, nombre_bloque_fisico_actual) != 0) {
-            // --- Deduplicación --- 
-            log_info(logger_storage, "##%d Deduplicación: Bloque Lógico %d (hash: %s) puede usar bloque físico %s",
-                     op->query_id, i, hash_actual, nombre_bloque_existente);
-
-            char* nro_bloque_fisico_existente_str = string_substring(nombre_bloque_existente, 5, 4); 
-            char* path_bloque_fisico_existente = string_from_format("%s/physical_blocks/%s.dat", 
-                                                                   storage_configs.puntomontaje,
-                                                                   nombre_bloque_existente);
-            char* path_bloque_logico = string_from_format("%s/%06d.dat", path_logical_blocks_dir, i);
-
-            unlink(path_bloque_logico); // 1. Eliminar link actual
-            link(path_bloque_fisico_existente, path_bloque_logico); // 2. Crear nuevo link
-            
-            chequear_y_liberar_bloque_fisico(op->query_id, nro_bloque_fisico_actual_str);
-            
-            // 4. Actualizar array en memoria para guardar en metadata
-            free(bloques_array[i]);
-            bloques_array[i] = string_itoa(atoi(nro_bloque_fisico_existente_str)); 
-            metadata_modificado = true; // Marcamos que el metadata cambió
-
-            log_info(logger_storage, "##%d Deduplicación de Bloque: %s:%s Bloque Lógico %d se reasigna de %s a %s",
-                     op->query_id, op->nombre_file, op->nombre_tag, i, nro_bloque_fisico_actual_str, nro_bloque_fisico_existente_str);
-
-            free(nro_bloque_fisico_existente_str);
-            free(path_bloque_fisico_existente);
-            free(path_bloque_logico);
-
-        } else if (nombre_bloque_existente == NULL) {
-            // --- Hash no existe, agregarlo --- 
-            log_info(logger_storage, "Hash %s no encontrado. Agregando al índice (Bloque: %s)", hash_actual, nombre_bloque_fisico_actual);
-            config_set_value(hash_index_config, hash_actual, nombre_bloque_fisico_actual);
-        }
-        
-        free(nombre_bloque_fisico_actual); free(path_bloque_fisico_actual); free(hash_actual);
+    // 4. Deduplicar los bloques lógicos (con DEDUP_DIFERIDA lo hace después el hilo de dedup)
+    if (!storage_configs.dedupdiferida) {
+        metadata_modificado = deduplicar_file_tag(op->query_id, op->nombre_file, op->nombre_tag, path_tag,
+                                                  bloques_array, 0, num_bloques, NULL);
     }
     
-    // 5. Guardar cambios en hash_index_config
-    config_save(hash_index_config);
-    config_destroy(hash_index_config);
+    // 5. Guardar cambios del hash index
+    hash_index_guardar();
 
     // 6. Actualizar y guardar metadata
     config_set_value(metadata, "ESTADO", "COMMITED"); 
@@ -454,6 +479,10 @@ t_codigo_operacion storage_op_commit(t_op_storage* op) {
         free(nuevo_blocks_config_str);
     }
     config_save(metadata);
+    if (storage_configs.dedupdiferida && num_bloques > 0) {
+        dedup_diferida_encolar(op->query_id, op->nombre_file, op->nombre_tag);
+    }
+    replicacion_encolar_commit(op->query_id, op->nombre_file, op->nombre_tag);
     
     log_info(logger_storage, "##%d Commit de File: Tag %s:%s", 
              op->query_id, op->nombre_file, op->nombre_tag); 
@@ -464,11 +493,64 @@ t_codigo_operacion storage_op_commit(t_op_storage* op) {
     free(path_tag); 
     free(path_metadata); 
     free(path_logical_blocks_dir);
-    free(path_hash_index);
 
     return OP_OK;
 }
 
+/**
+ * @brief WRITE sobre un File:Tag inline: mismo resultado que en bloques (cada bloque
+ * lógico tocado se pisa entero y se completa con ceros) pero sin I/O de bloques.
+ */
+static t_codigo_operacion escribir_inline(t_op_storage* op, t_config* metadata) {
+    int tamanio = config_get_int_value(metadata, "TAMAÑO");
+    int bloques_totales = tamanio / superblock_configs.blocksize;
+    int bloques_necesarios = (op->tamano_contenido + superblock_configs.blocksize - 1) / superblock_configs.blocksize;
+
+    if (op->direccion_base + bloques_necesarios > bloques_totales) {
+        log_error(logger_storage, "##%d Error WRITE: Se intenta escribir fuera del tamaño del archivo. (Inicio: %d, Req: %d, Disp: %d)", 
+                  op->query_id, op->direccion_base, bloques_necesarios, bloques_totales);
+        return LECTURA_O_ESCRITURA_FUERA_DE_LIMITE;
+    }
+
+    char* contenido = contenido_inline_leer(metadata, tamanio);
+    for (int escritos = 0, bloque = op->direccion_base; escritos < op->tamano_contenido; bloque++) {
+        int bytes_ahora = op->tamano_contenido - escritos < superblock_configs.blocksize
+                          ? op->tamano_contenido - escritos : superblock_configs.blocksize;
+        char* destino = contenido + bloque * superblock_configs.blocksize;
+        memset(destino, 0, superblock_configs.blocksize);
+        memcpy(destino, (char*) op->contenido + escritos, bytes_ahora);
+        escritos += bytes_ahora;
+
+        log_info(logger_storage, "##%d Bloque Lógico Escrito %s:%s Número de Bloque: %d", 
+                 op->query_id, op->nombre_file, op->nombre_tag, bloque);
+    }
+
+    contenido_inline_guardar(metadata, contenido, tamanio);
+    config_save(metadata);
+    free(contenido);
+    return OP_OK;
+}
+
+/**
+ * @brief Deduplicación en línea (DEDUP_EN_ESCRITURA): busca en el hash index un bloque
+ * con el mismo contenido que quedaría escrito (el pedazo completado con ceros).
+ *
+ * El índice solo tiene bloques de File:Tags COMMITED, que no se modifican más, así que
+ * el bloque encontrado se puede compartir: si después se escribe, el WRITE hace CoW.
+ * Si lo encuentra, el bloque lógico ya queda enlazado a él (ver hash_index_buscar_y_enlazar).
+ * @return Número de bloque físico, o -1 si no hay ninguno.
+ */
+static int buscar_bloque_duplicado(void* contenido, int tamano_contenido, int nro_bloque_actual,
+                                   char* path_tag, int nro_bloque_logico) {
+    char* bloque = calloc(1, superblock_configs.blocksize);
+    memcpy(bloque, contenido, tamano_contenido);
+    char* hash = crypto_md5(bloque, superblock_configs.blocksize);
+    int nro_bloque = hash_index_buscar_y_enlazar(hash, nro_bloque_actual, path_tag, nro_bloque_logico);
+    free(hash);
+    free(bloque);
+    return nro_bloque;
+}
+
 t_codigo_operacion storage_op_write(t_op_storage* op) {
     // Bloque lógico inicial donde empezamos a escribir
     int nro_bloque_logico_inicial = op->direccion_base; 
@@ -493,6 +575,13 @@ t_codigo_operacion storage_op_write(t_op_storage* op) {
         free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
         return ESCRITURA_NO_PERMITIDA; 
     }
+
+    if (metadata_es_inline(metadata)) {
+        t_codigo_operacion resultado = escribir_inline(op, metadata);
+        config_destroy(metadata);
+        free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
+        return resultado;
+    }
     
     char** bloques_array = config_get_array_value(metadata, "BLOCKS");
     int num_bloques_total = string_array_size(bloques_array);
@@ -526,23 +615,36 @@ t_codigo_operacion storage_op_write(t_op_storage* op) {
         // Puntero al pedazo de contenido actual
         void* contenido_actual = op->contenido + bytes_escritos;
 
-        // Path del bloque lógico actual
-        char* path_bloque_logico = string_from_format("%s/%06d.dat", path_logical_blocks_dir, bloque_logico_actual);
-
         // Obtenemos el físico actual del array en memoria
         char* nro_bloque_fisico_actual_str = bloques_array[bloque_logico_actual];
         int nro_bloque_fisico_actual = atoi(nro_bloque_fisico_actual_str);
 
-        char* path_bloque_fisico_actual = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                                            storage_configs.puntomontaje, 
-                                                            nro_bloque_fisico_actual);
-        
-        // Verificamos nlink para Copy-On-Write
-        struct stat st;
-        stat(path_bloque_fisico_actual, &st);
+        // Si el contenido ya está en el índice no se escribe nada: se apunta a ese bloque
+        int nro_bloque_duplicado = storage_configs.dedupenescritura
+                                   ? buscar_bloque_duplicado(contenido_actual, bytes_a_escribir_ahora, nro_bloque_fisico_actual,
+                                                             path_tag, bloque_logico_actual) : -1;
+
+        // Verificamos las referencias para Copy-On-Write
+        int referencias = nro_bloque_duplicado == -1 ? bloque_fisico_referencias(nro_bloque_fisico_actual) : 0;
+
+        // CASO 0: DEDUPLICACIÓN EN LÍNEA (el contenido ya existe en otro bloque)
+        if (nro_bloque_duplicado == nro_bloque_fisico_actual) {
+            log_info(logger_storage, "##%d WRITE (dedup): Bloque Lógico %d ya tiene ese contenido (Físico %d)", 
+                     op->query_id, bloque_logico_actual, nro_bloque_fisico_actual);
+        }
+        else if (nro_bloque_duplicado != -1) {
+            // El link ya apunta al duplicado: solo queda soltar el bloque viejo
+            chequear_y_liberar_bloque_fisico(op->query_id, nro_bloque_fisico_actual_str);
+
+            free(bloques_array[bloque_logico_actual]);
+            bloques_array[bloque_logico_actual] = string_itoa(nro_bloque_duplicado);
 
-        // CASO A: COPY-ON-WRITE (Bloque compartido o Bloque 0)
-        if (st.st_nlink > 2 || nro_bloque_fisico_actual == 0) {
+            log_info(logger_storage, "##%d Deduplicación en escritura: %s:%s Bloque Lógico %d se reasigna de %d a %d",
+                     op->query_id, op->nombre_file, op->nombre_tag, bloque_logico_actual, nro_bloque_fisico_actual, nro_bloque_duplicado);
+        }
+        // CASO A: COPY-ON-WRITE (Bloque compartido o Bloque 0). Las referencias se vuelven a leer con
+        // el índice tomado: una deduplicación de otro Worker lo pudo haber enlazado recién
+        else if (referencias > 1 || nro_bloque_fisico_actual == 0 || !hash_index_tomar_para_escribir(nro_bloque_fisico_actual)) {
             log_info(logger_storage, "##%d WRITE (CoW): Bloque Lógico %d apunta a Físico %d (compartido). Separando...", 
                      op->query_id, bloque_logico_actual, nro_bloque_fisico_actual);
 
@@ -550,22 +652,18 @@ t_codigo_operacion storage_op_write(t_op_storage* op) {
             
             if (nuevo_nro_bloque_fisico == -1) { 
                 // Fallo crítico: Limpieza y retorno
-                free(path_bloque_logico); free(path_bloque_fisico_actual);
                 string_array_destroy(bloques_array); config_destroy(metadata);
                 free(path_tag); free(path_metadata); free(path_logical_blocks_dir);
                 return ESPACIO_INSUFICIENTE; 
             }
             
-            char* path_nuevo_bloque_fisico = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                                                storage_configs.puntomontaje, 
-                                                                nuevo_nro_bloque_fisico);
-            
             // Escribimos en el NUEVO bloque
-            escribir_en_bloque_fisico(path_nuevo_bloque_fisico, contenido_actual, bytes_a_escribir_ahora, superblock_configs.blocksize);
+            escribir_en_bloque_fisico(nuevo_nro_bloque_fisico, contenido_actual, bytes_a_escribir_ahora, superblock_configs.blocksize);
+            cache_invalidar_bloque(nuevo_nro_bloque_fisico);
 
             // Actualizamos Hard Link
-            unlink(path_bloque_logico); 
-            link(path_nuevo_bloque_fisico, path_bloque_logico); 
+            bloque_fisico_desenlazar(nro_bloque_fisico_actual, path_tag, bloque_logico_actual);
+            bloque_fisico_enlazar(nuevo_nro_bloque_fisico, path_tag, bloque_logico_actual);
             
             // Actualizamos el Array en memoria (Importante para la metadata final)
             free(bloques_array[bloque_logico_actual]);
@@ -574,24 +672,19 @@ t_codigo_operacion storage_op_write(t_op_storage* op) {
             // Liberamos referencia al viejo si corresponde
             chequear_y_liberar_bloque_fisico(op->query_id, nro_bloque_fisico_actual_str);
             
-            free(path_nuevo_bloque_fisico);
-            
         } 
-        // CASO B: ESCRITURA DIRECTA (bloque no compartido)
+        // CASO B: ESCRITURA DIRECTA (bloque no compartido, ya fuera del índice)
         else {
             log_info(logger_storage, "##%d WRITE: Escribiendo directo en Bloque Lógico %d (Físico %d)", 
                      op->query_id, bloque_logico_actual, nro_bloque_fisico_actual);
             
-            escribir_en_bloque_fisico(path_bloque_fisico_actual, contenido_actual, bytes_a_escribir_ahora, superblock_configs.blocksize);
+            escribir_en_bloque_fisico(nro_bloque_fisico_actual, contenido_actual, bytes_a_escribir_ahora, superblock_configs.blocksize);
+            cache_invalidar_bloque(nro_bloque_fisico_actual);
         }
 
         log_info(logger_storage, "##%d Bloque Lógico Escrito %s:%s Número de Bloque: %d", 
              op->query_id, op->nombre_file, op->nombre_tag, bloque_logico_actual);
 
-        // Limpieza de iteración
-        free(path_bloque_logico);
-        free(path_bloque_fisico_actual);
-
         // Avanzamos contadores
         bytes_escritos += bytes_a_escribir_ahora;
         bloque_logico_actual++;
@@ -612,8 +705,17 @@ t_codigo_operacion storage_op_write(t_op_storage* op) {
     return OP_OK;
 }
 
-t_codigo_operacion storage_op_read(t_op_storage* op, char** contenido_leido) {
-    int nro_bloque_logico = op->direccion_base; 
+t_codigo_operacion storage_op_read(t_op_storage* op, char** contenido_leido, int* tamanio_leido) {
+    int tam_bloque = superblock_configs.blocksize;
+
+    // Rango pedido: tamano bytes desde desplazamiento (relativo al bloque direccion_base); 0 = el bloque entero
+    if (op->tamano == 0) op->desplazamiento = 0;
+    if (op->desplazamiento >= (uint32_t) tam_bloque) {
+        log_error(logger_storage, "##%d READ Error: desplazamiento %u fuera del bloque (Tamaño de bloque: %d)", op->query_id, op->desplazamiento, tam_bloque);
+        return LECTURA_O_ESCRITURA_FUERA_DE_LIMITE;
+    }
+    uint64_t tamanio_pedido = op->tamano > 0 ? op->tamano : (uint64_t) tam_bloque;
+    uint64_t inicio_pedido = (uint64_t) op->direccion_base * tam_bloque + op->desplazamiento;
 
     // 1. Armar paths
     char* path_tag = string_from_format("%s/files/%s/%s", 
@@ -627,52 +729,100 @@ t_codigo_operacion storage_op_read(t_op_storage* op, char** contenido_leido) {
         free(path_tag); free(path_metadata);
         return FILE_TAG_INEXISTENTE; // Error: File / Tag inexistente
     }
+
+    // 2.a. El rango tiene que caer entero dentro del File:Tag (antes de calcular nada con él)
+    uint64_t tamanio_tag_total = config_get_int_value(metadata, "TAMAÑO");
+    if (tamanio_pedido > tamanio_tag_total || inicio_pedido + tamanio_pedido > tamanio_tag_total) {
+        log_error(logger_storage, "##%d READ Error: rango de %lu bytes desde el byte %lu fuera de límite (Tamaño: %lu bytes)",
+                  op->query_id, (unsigned long) tamanio_pedido, (unsigned long) inicio_pedido, (unsigned long) tamanio_tag_total);
+        config_destroy(metadata);
+        free(path_tag); free(path_metadata);
+        return LECTURA_O_ESCRITURA_FUERA_DE_LIMITE;
+    }
+    int tamanio = tamanio_pedido;
+    long inicio = inicio_pedido;
+    int primer_bloque = inicio / tam_bloque;
+    int ultimo_bloque = (inicio + tamanio - 1) / tam_bloque;
+
+    // 2.b. File:Tag inline: se lee del metadata, sin I/O de bloques
+    if (metadata_es_inline(metadata)) {
+        int tamanio_tag = config_get_int_value(metadata, "TAMAÑO");
+        if (ultimo_bloque >= tamanio_tag / tam_bloque) {
+            log_error(logger_storage, "##%d READ Error: Bloque lógico %d fuera de límite (Tamaño: %d bloques)", op->query_id, ultimo_bloque, tamanio_tag / tam_bloque);
+            config_destroy(metadata);
+            free(path_tag); free(path_metadata);
+            return LECTURA_O_ESCRITURA_FUERA_DE_LIMITE;
+        }
+
+        char* contenido = contenido_inline_leer(metadata, tamanio_tag);
+        *contenido_leido = malloc(tamanio + 1);
+        memcpy(*contenido_leido, contenido + inicio, tamanio);
+        (*contenido_leido)[tamanio] = '\0';
+        *tamanio_leido = tamanio;
+        free(contenido);
+
+        for (int nro_bloque_logico = primer_bloque; nro_bloque_logico <= ultimo_bloque; nro_bloque_logico++) {
+            log_info(logger_storage, "##%d Bloque Lógico Leído %s:%s Número de Bloque: %d", 
+                     op->query_id, op->nombre_file, op->nombre_tag, nro_bloque_logico);
+        }
+        config_destroy(metadata);
+        free(path_tag); free(path_metadata);
+        return OP_OK;
+    }
     
     // 3. Chequear fuera de límite
     char** bloques_array = config_get_array_value(metadata, "BLOCKS");
     int num_bloques = string_array_size(bloques_array);
 
-    if (nro_bloque_logico >= num_bloques) {
-        log_error(logger_storage, "##%d READ Error: Bloque lógico %d fuera de límite (Tamaño: %d bloques)", op->query_id, nro_bloque_logico, num_bloques);
+    if (ultimo_bloque >= num_bloques) {
+        log_error(logger_storage, "##%d READ Error: Bloque lógico %d fuera de límite (Tamaño: %d bloques)", op->query_id, ultimo_bloque, num_bloques);
         config_destroy(metadata);
         string_array_destroy(bloques_array);
         free(path_tag); free(path_metadata);
         return LECTURA_O_ESCRITURA_FUERA_DE_LIMITE; // Error: Lectura o escritura fuera de limite
     }
-    
-    // 4. Leer el bloque físico
-    char* nro_bloque_fisico_str = bloques_array[nro_bloque_logico];
-    char* path_bloque_fisico = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                                    storage_configs.puntomontaje, 
-                                                    atoi(nro_bloque_fisico_str));
-
-    usleep(storage_configs.retardoaccesobloque * 1000);
 
-    int fd = open(path_bloque_fisico, O_RDONLY);
-    void* buffer_bloque = mmap(NULL, superblock_configs.blocksize, PROT_READ, MAP_SHARED, fd, 0);
-    
-    if (buffer_bloque == MAP_FAILED) {
-        log_error(logger_storage, "##%d READ Error: mmap falló para bloque %s", op->query_id, nro_bloque_fisico_str);
-        close(fd);
-        config_destroy(metadata); string_array_destroy(bloques_array);
-        free(path_tag); free(path_metadata); free(path_bloque_fisico);
-        return OP_ERROR;
-    }
+    *contenido_leido = malloc(tamanio + 1);
+    (*contenido_leido)[tamanio] = '\0'; 
+    char* bloque = malloc(tam_bloque);
+
+    // 4. Leer cada bloque físico del rango (caché -> lectura en vuelo de otro pedido -> disco)
+    //    y copiar solo la parte pedida
+    for (int nro_bloque_logico = primer_bloque; nro_bloque_logico <= ultimo_bloque; nro_bloque_logico++) {
+        char* nro_bloque_fisico_str = bloques_array[nro_bloque_logico];
+        int nro_bloque_fisico = atoi(nro_bloque_fisico_str);
+
+        bool acierto_cache = false;
+        if (!leer_bloque_fisico(nro_bloque_fisico, bloque, false, &acierto_cache)) {
+            log_error(logger_storage, "##%d READ Error: no se pudo leer el bloque %s", op->query_id, nro_bloque_fisico_str);
+            free(bloque);
+            free(*contenido_leido); *contenido_leido = NULL;
+            config_destroy(metadata); string_array_destroy(bloques_array);
+            free(path_tag); free(path_metadata);
+            return OP_ERROR;
+        }
+        if (acierto_cache) {
+            log_debug(logger_storage, "##%d READ: Bloque Físico %d servido desde caché", op->query_id, nro_bloque_fisico);
+        }
 
-    // 5. Copiar contenido al out-parameter
-    *contenido_leido = malloc(superblock_configs.blocksize + 1);
-    memcpy(*contenido_leido, buffer_bloque, superblock_configs.blocksize);
-    (*contenido_leido)[superblock_configs.blocksize] = '\0'; 
+        // 5. Copiar la parte del rango que cae en este bloque al out-parameter
+        long inicio_bloque = (long) nro_bloque_logico * tam_bloque;
+        long desde = inicio > inicio_bloque ? inicio : inicio_bloque;
+        long hasta = inicio + tamanio < inicio_bloque + tam_bloque ? inicio + tamanio : inicio_bloque + tam_bloque;
+        memcpy(*contenido_leido + (desde - inicio), bloque + (desde - inicio_bloque), hasta - desde);
 
-    // 6. Liberar y loguear
-    munmap(buffer_bloque, superblock_configs.blocksize);
-    close(fd);
-    
-    log_info(logger_storage, "##%d Bloque Lógico Leído %s:%s Número de Bloque: %d", 
-             op->query_id, op->nombre_file, op->nombre_tag, nro_bloque_logico);
+        // 6. Avisar al readahead para que se adelante si el patrón es secuencial
+        readahead_registrar_lectura(op->worker_id, op->nombre_file, op->nombre_tag,
+                                    nro_bloque_logico, bloques_array, num_bloques, acierto_cache);
+        
+        log_info(logger_storage, "##%d Bloque Lógico Leído %s:%s Número de Bloque: %d", 
+                 op->query_id, op->nombre_file, op->nombre_tag, nro_bloque_logico);
+    }
+    *tamanio_leido = tamanio;
     
+    free(bloque);
     config_destroy(metadata); string_array_destroy(bloques_array);
-    free(path_tag); free(path_metadata); free(path_bloque_fisico);
+    free(path_tag); free(path_metadata);
     
     return OP_OK;
 }
@@ -697,29 +847,27 @@ char* build_blocks_string(char** bloques_actuales, int count_actual, int count_n
 }
 
 /**
- * @brief Chequea el nlink de un bloque físico y lo marca como libre si ya no se usa.
+ * @brief Chequea las referencias de un bloque físico y lo marca como libre si ya no se usa.
  */
 void chequear_y_liberar_bloque_fisico(int query_id, char* nro_bloque_fisico_str) {
     int nro_bloque_fisico = atoi(nro_bloque_fisico_str);
     if (nro_bloque_fisico == 0) return; 
 
-    char* path_bloque_fisico = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                                 storage_configs.puntomontaje, nro_bloque_fisico);
-    struct stat st;
-    if (stat(path_bloque_fisico, &st) == 0) {
-        // nlink == 1 significa que solo existe el archivo en /physical_blocks
-        if (st.st_nlink == 1) { 
+    // Si queda sin referencias sale del índice antes de liberarlo (nadie lo puede deduplicar en el medio)
+    int referencias = hash_index_reclamar_bloque(nro_bloque_fisico);
+    if (referencias >= 0) {
+        // Sin referencias: ningún bloque lógico apunta a este bloque físico
+        if (referencias == 0) { 
             log_info(logger_storage, "Bloque físico %d ya no está referenciado. Liberando...", nro_bloque_fisico);
         
             liberar_bloque(nro_bloque_fisico);
+            cache_invalidar_bloque(nro_bloque_fisico);
             log_info(logger_storage, "##%d Bloque Físico Liberado %d", query_id, nro_bloque_fisico);
         }
     }
     else {
-        log_warning(logger_storage, "No se pudo obtener stat() del bloque físico %d", nro_bloque_fisico);
+        log_warning(logger_storage, "No se pudieron obtener las referencias del bloque físico %d", nro_bloque_fisico);
     }
-    
-    free(path_bloque_fisico);
 }
 
 // Simplemente une un array de strings con comas, [a,b,c]
@@ -734,27 +882,16 @@ char* array_to_blocks_string(char** bloques_array, int count) {
     return nuevo_array_str;
 }
 
-void escribir_en_bloque_fisico(char* path_bloque_fisico, void* contenido, int tamano_contenido, int block_size) {
+void escribir_en_bloque_fisico(int nro_bloque_fisico, void* contenido, int tamano_contenido, int block_size) {
     usleep(storage_configs.retardoaccesobloque * 1000);
 
-    int fd = open(path_bloque_fisico, O_RDWR);
-    if (fd == -1) {
-        log_error(logger_storage, "WRITE_HELPER: No se pudo abrir %s", path_bloque_fisico);
-        return;
-    }
-    
-    void* buffer_bloque = mmap(NULL, block_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (buffer_bloque == MAP_FAILED) { close(fd); return; }
-
     // Usamos el tamaño que nos pasan, validando que no se pase del block_size
     int bytes_a_copiar = (tamano_contenido < block_size) ? tamano_contenido : block_size;
-    
-    memset(buffer_bloque, 0, block_size); // Limpiamos basura anterior
-    memcpy(buffer_bloque, contenido, bytes_a_copiar); // Copiamos bytes crudos
 
-    msync(buffer_bloque, block_size, MS_SYNC);
-    munmap(buffer_bloque, block_size);
-    close(fd);
+    // El resto del bloque queda en cero (limpiamos basura anterior)
+    if (!bloque_fisico_escribir(nro_bloque_fisico, contenido, bytes_a_copiar, true)) {
+        log_error(logger_storage, "WRITE_HELPER: No se pudo escribir el bloque físico %d", nro_bloque_fisico);
+    }
 }
 
 int reservar_bloque_real(int query_id) {
@@ -768,24 +905,13 @@ int reservar_bloque_real(int query_id) {
 
     // Ya no hace falta llamar a 'marcar_bloque_ocupado' porque reservar_bloque_libre ya lo hizo.
 
-    // 3. Asegurar archivo físico
-    char* path_bloque = string_from_format("%s/physical_blocks/block%04d.dat", 
-                                          storage_configs.puntomontaje, 
-                                          bloque_libre);
-    
-    int fd = open(path_bloque, O_RDWR | O_CREAT, 0666);
-    if (fd == -1) {
+    // 3. Asegurar bloque físico en disco
+    if (!bloque_fisico_preparar(bloque_libre)) {
         log_error(logger_storage, "##%d ERROR: No se pudo crear archivo físico para bloque %d", query_id, bloque_libre);
         liberar_bloque(bloque_libre); // Rollback
-        free(path_bloque);
         return -1;
     }
 
-    // Aseguramos el tamaño
-    ftruncate(fd, superblock_configs.blocksize);
-    close(fd);
-
     log_info(logger_storage, "##%d Bloque Físico Reservado %d (Real)", query_id, bloque_libre);
-    free(path_bloque);
     return bloque_libre;
 }
\ No newline at end of file
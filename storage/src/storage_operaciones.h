@@ -49,6 +49,24 @@ t_codigo_operacion storage_op_delete(t_op_storage* op);
  */
 t_codigo_operacion storage_op_commit(t_op_storage* op);
 
+/**
+ * @brief true si el File:Tag existe y está COMMITED.
+ */
+bool storage_file_tag_commited(char* nombre_file, char* nombre_tag);
+
+/**
+ * @brief Pasada de deduplicación sobre los bloques lógicos [desde, hasta) de un File:Tag
+ * COMMITED: cada bloque cuyo md5 ya está en el hash index pasa a apuntar a ese bloque
+ * (y el propio se libera si quedó sin referencias); los demás se agregan al índice.
+ * La usa COMMIT, o el hilo de dedup diferida si DEDUP_DIFERIDA está activo.
+ * @param bloques_array BLOCKS del metadata; se actualiza en el lugar
+ * @param hashes md5 ya calculados de los bloques [desde, hasta) (NULL: se calculan acá).
+ * Los bloques con hash NULL se saltean.
+ * @return true si cambió algún bloque (hay que guardar BLOCKS)
+ */
+bool deduplicar_file_tag(int query_id, char* nombre_file, char* nombre_tag, char* path_tag,
+                         char** bloques_array, int desde, int hasta, char** hashes);
+
 /**
  * @brief Ejecuta la lógica de creación de un nuevo Tag desde uno existente.
  * (Próximo paso a implementar)
@@ -62,13 +80,15 @@ char* build_blocks_string(char** bloques_actuales, int count_actual, int count_n
 void chequear_y_liberar_bloque_fisico(int query_id, char* nro_bloque_fisico_str);
 char* array_to_blocks_string(char** bloques_array, int count); //seria como un string_join
 
-void escribir_en_bloque_fisico(char* path_bloque_fisico, void* contenido, int tamano_contenido, int block_size);
+void escribir_en_bloque_fisico(int nro_bloque_fisico, void* contenido, int tamano_contenido, int block_size);
 int encontrar_bloque_libre_mock(int query_id);
 int reservar_bloque_real(int query_id);
 // ... (Aquí irían las de READ y WRITE) ...
 
 t_codigo_operacion storage_op_write(t_op_storage* op);
-// Esta función devuelve el contenido leído por un "out-parameter" (char**)
-t_codigo_operacion storage_op_read(t_op_storage* op, char** contenido_leido);
+// Esta función devuelve el contenido leído por un "out-parameter" (char**) y su tamaño:
+// op->tamano bytes desde op->desplazamiento del bloque op->direccion_base (puede cruzar bloques),
+// o el bloque entero si op->tamano es 0
+t_codigo_operacion storage_op_read(t_op_storage* op, char** contenido_leido, int* tamanio_leido);
 
 #endif
\ No newline at end of file
@@ -246,11 +246,12 @@ uint32_t deserializar_worker(t_buffer* buffer) {
 
 
 t_buffer* serializar_query_ejecucion(t_query_ejecucion* query){
-    uint32_t tamanio = 3 * sizeof(uint32_t) + strlen(query->archivo_query);
+    uint32_t tamanio = 4 * sizeof(uint32_t) + strlen(query->archivo_query);
     t_buffer* buffer = buffer_create(tamanio);
     buffer_add_string(buffer, strlen(query->archivo_query), query->archivo_query);
     buffer_add_uint32(buffer, query->id_query);
     buffer_add_uint32(buffer, query->program_counter);    
+    buffer_add_uint32(buffer, query->prioridad);
     return buffer;
 }
 
@@ -260,6 +261,7 @@ t_query_ejecucion* deserializar_query_ejecucion(t_buffer* buffer){
     query->archivo_query = buffer_read_string(buffer, &length);
     query->id_query = buffer_read_uint32(buffer);
     query->program_counter = buffer_read_uint32(buffer);
+    query->prioridad = buffer_read_uint32(buffer);
     return query;
 }
 
@@ -302,26 +304,29 @@ t_buffer* serializar_op_storage(t_op_storage* op, t_codigo_operacion codigo_oper
 
     switch (codigo_operacion) {
         
-        case CREATE: // [query_id, file, tag]
-            buffer = buffer_create(sizeof(uint32_t) * 3 + len_file + len_tag);
+        case CREATE: // [query_id, prioridad, file, tag]
+            buffer = buffer_create(sizeof(uint32_t) * 4 + len_file + len_tag);
             buffer_add_uint32(buffer, op->query_id);
+            buffer_add_uint32(buffer, op->prioridad);
             buffer_add_string(buffer, len_file, op->nombre_file);
             buffer_add_string(buffer, len_tag, op->nombre_tag);
             break;
 
-        case TRUNCATE: // [query_id, file, tag, tamano]
-            buffer = buffer_create(sizeof(uint32_t) * 4 + len_file + len_tag);
+        case TRUNCATE: // [query_id, prioridad, file, tag, tamano]
+            buffer = buffer_create(sizeof(uint32_t) * 5 + len_file + len_tag);
             buffer_add_uint32(buffer, op->query_id);
+            buffer_add_uint32(buffer, op->prioridad);
             buffer_add_string(buffer, len_file, op->nombre_file);
             buffer_add_string(buffer, len_tag, op->nombre_tag);
             buffer_add_uint32(buffer, op->tamano);
             break;
 
-        case WRITE: // [query_id, file, tag, dir_base, tamano_contenido, contenido]
+        case WRITE: // [query_id, prioridad, file, tag, dir_base, tamano_contenido, contenido]
             // PErr
-            buffer = buffer_create(sizeof(uint32_t) * 5 + len_file + len_tag + op->tamano_contenido);
+            buffer = buffer_create(sizeof(uint32_t) * 6 + len_file + len_tag + op->tamano_contenido);
             
             buffer_add_uint32(buffer, op->query_id);
+            buffer_add_uint32(buffer, op->prioridad);
             buffer_add_string(buffer, len_file, op->nombre_file);
             buffer_add_string(buffer, len_tag, op->nombre_tag);
             buffer_add_uint32(buffer, op->direccion_base);
@@ -331,18 +336,21 @@ t_buffer* serializar_op_storage(t_op_storage* op, t_codigo_operacion codigo_oper
             buffer_add(buffer, op->contenido, op->tamano_contenido); // Enviamos los bytes
             break;
 
-        case READ: // [query_id, file, tag, dir_base, tamano]
-            buffer = buffer_create(sizeof(uint32_t) * 5 + len_file + len_tag);
+        case READ: // [query_id, prioridad, file, tag, dir_base, tamano, desplazamiento]
+            buffer = buffer_create(sizeof(uint32_t) * 7 + len_file + len_tag);
             buffer_add_uint32(buffer, op->query_id);
+            buffer_add_uint32(buffer, op->prioridad);
             buffer_add_string(buffer, len_file, op->nombre_file);
             buffer_add_string(buffer, len_tag, op->nombre_tag);
             buffer_add_uint32(buffer, op->direccion_base);
             buffer_add_uint32(buffer, op->tamano);
+            buffer_add_uint32(buffer, op->desplazamiento);
             break;
 
         case TAG: 
-            buffer = buffer_create(sizeof(uint32_t) * 5 + len_file + len_tag + len_file_dest + len_tag_dest);
+            buffer = buffer_create(sizeof(uint32_t) * 6 + len_file + len_tag + len_file_dest + len_tag_dest);
             buffer_add_uint32(buffer, op->query_id);
+            buffer_add_uint32(buffer, op->prioridad);
             buffer_add_string(buffer, len_file, op->nombre_file);
             buffer_add_string(buffer, len_tag, op->nombre_tag);
             buffer_add_string(buffer, len_file_dest, op->nombre_file_destino);
@@ -351,8 +359,9 @@ t_buffer* serializar_op_storage(t_op_storage* op, t_codigo_operacion codigo_oper
 
         case COMMIT: 
         case DELETE: 
-            buffer = buffer_create(sizeof(uint32_t) * 3 + len_file + len_tag);
+            buffer = buffer_create(sizeof(uint32_t) * 4 + len_file + len_tag);
             buffer_add_uint32(buffer, op->query_id);
+            buffer_add_uint32(buffer, op->prioridad);
             buffer_add_string(buffer, len_file, op->nombre_file);
             buffer_add_string(buffer, len_tag, op->nombre_tag);
             break;
@@ -380,12 +389,14 @@ t_op_storage* deserializar_op_storage(t_buffer* buffer, t_codigo_operacion codig
 
         case CREATE: 
             op->query_id = buffer_read_uint32(buffer);
+            op->prioridad = buffer_read_uint32(buffer);
             op->nombre_file = buffer_read_string(buffer, &len);
             op->nombre_tag = buffer_read_string(buffer, &len);
             break;
         
         case TRUNCATE: 
             op->query_id = buffer_read_uint32(buffer);
+            op->prioridad = buffer_read_uint32(buffer);
             op->nombre_file = buffer_read_string(buffer, &len);
             op->nombre_tag = buffer_read_string(buffer, &len);
             op->tamano = buffer_read_uint32(buffer);
@@ -393,6 +404,7 @@ t_op_storage* deserializar_op_storage(t_buffer* buffer, t_codigo_operacion codig
 
         case WRITE: 
             op->query_id = buffer_read_uint32(buffer);
+            op->prioridad = buffer_read_uint32(buffer);
             op->nombre_file = buffer_read_string(buffer, &len);
             op->nombre_tag = buffer_read_string(buffer, &len);
             op->direccion_base = buffer_read_uint32(buffer);
@@ -405,14 +417,17 @@ t_op_storage* deserializar_op_storage(t_buffer* buffer, t_codigo_operacion codig
 
         case READ: 
             op->query_id = buffer_read_uint32(buffer);
+            op->prioridad = buffer_read_uint32(buffer);
             op->nombre_file = buffer_read_string(buffer, &len);
             op->nombre_tag = buffer_read_string(buffer, &len);
             op->direccion_base = buffer_read_uint32(buffer);
             op->tamano = buffer_read_uint32(buffer);
+            op->desplazamiento = buffer_read_uint32(buffer);
             break;
 
         case TAG: 
             op->query_id = buffer_read_uint32(buffer);
+            op->prioridad = buffer_read_uint32(buffer);
             op->nombre_file = buffer_read_string(buffer, &len);
             op->nombre_tag = buffer_read_string(buffer, &len);
             op->nombre_file_destino = buffer_read_string(buffer, &len);
@@ -422,6 +437,7 @@ t_op_storage* deserializar_op_storage(t_buffer* buffer, t_codigo_operacion codig
         case COMMIT: 
         case DELETE: 
             op->query_id = buffer_read_uint32(buffer);
+            op->prioridad = buffer_read_uint32(buffer);
             op->nombre_file = buffer_read_string(buffer, &len);
             op->nombre_tag = buffer_read_string(buffer, &len);
             break;
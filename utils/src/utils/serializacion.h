@@ -49,6 +49,7 @@ typedef enum {
     OP_OK = 21,
     OP_ERROR = 22,
     READ_RTA = 23,
+    HANDSHAKE_REPLICACION = 24, // Storage primario -> réplica de solo lectura
 } t_codigo_operacion;
 
 
@@ -129,11 +130,13 @@ typedef enum {
  * @param archivo_query: path del archivo de la query
  * @param id_query: id de la query
  * @param program_counter: program counter de la query
+ * @param prioridad: prioridad de la query al asignarla (con el aging ya aplicado)
  */
 typedef struct {
     char* archivo_query;
     uint32_t id_query;
     uint32_t program_counter; 
+    uint32_t prioridad;
 } t_query_ejecucion;
 
 
@@ -356,14 +359,17 @@ void destruir_operacion_query(t_operacion_query* op);
  */
 typedef struct {
     uint32_t query_id;
+    uint32_t prioridad;        // Prioridad de la Query (menor = más prioritaria), para ordenar en Storage
     char* nombre_file;
     char* nombre_tag;
-    uint32_t tamano; // Para TRUNCATE y READ (solicitud)
+    uint32_t tamano; // Para TRUNCATE y READ (solicitud; en READ 0 = el bloque entero)
     uint32_t direccion_base; // Para WRITE y READ
+    uint32_t desplazamiento; // Para READ: bytes desde el inicio del bloque direccion_base
     uint32_t tamano_contenido; // Tamaño exacto en bytes del contenido
     void* contenido;           // void* para soportar bytes 
     char* nombre_file_destino; // Para TAG
     char* nombre_tag_destino; // Para TAG
+    uint32_t worker_id;        // Lo completa Storage al recibir la op (no se serializa)
 } t_op_storage;
 
 
@@ -21,9 +21,19 @@ int inicializar_configs(char* path_config){
     configcargado.puertomaster = cargar_variable_int(worker_tconfig, "PUERTO_MASTER");
     configcargado.ipstorage = cargar_variable_string(worker_tconfig, "IP_STORAGE");
     configcargado.puertostorage = cargar_variable_int(worker_tconfig, "PUERTO_STORAGE");
+    configcargado.storages = config_has_property(worker_tconfig, "STORAGES") ?
+                             config_get_array_value(worker_tconfig, "STORAGES") : NULL;
+    configcargado.replicasstorage = config_has_property(worker_tconfig, "REPLICAS_STORAGE") ?
+                                    config_get_array_value(worker_tconfig, "REPLICAS_STORAGE") : NULL;
     configcargado.tammemoria = cargar_variable_int(worker_tconfig, "TAM_MEMORIA");
     configcargado.retardomemoria = cargar_variable_int(worker_tconfig, "RETARDO_MEMORIA");
     configcargado.algoritmoreemplazo = cargar_variable_string(worker_tconfig, "ALGORITMO_REEMPLAZO");
+    //Lecturas directas al Storage (solo los bytes pedidos) cuando no hay nada en memoria (opcional)
+    configcargado.lecturadirecta = config_has_property(worker_tconfig, "LECTURA_DIRECTA") ?
+                                   cargar_variable_bool(worker_tconfig, "LECTURA_DIRECTA") : false;
+    //Write-back en vez de write-through en cada WRITE (opcional)
+    configcargado.escrituradiferida = config_has_property(worker_tconfig, "ESCRITURA_DIFERIDA") ?
+                                      cargar_variable_bool(worker_tconfig, "ESCRITURA_DIFERIDA") : false;
     configcargado.pathqueries = cargar_variable_string(worker_tconfig, "PATH_QUERIES");
     configcargado.loglevel = cargar_variable_string(worker_tconfig, "LOG_LEVEL");
 
@@ -38,6 +48,8 @@ void destruir_configs() {
     //Libero memoria
     free(worker_configs.ipmaster);
     free(worker_configs.ipstorage);
+    if (worker_configs.storages != NULL) string_array_destroy(worker_configs.storages);
+    if (worker_configs.replicasstorage != NULL) string_array_destroy(worker_configs.replicasstorage);
     free(worker_configs.algoritmoreemplazo);
     free(worker_configs.pathqueries);
     free(worker_configs.loglevel);
@@ -4,6 +4,7 @@
 #include <utils/configs.h>
 #include <utils/sockets.h>
 #include <utils/hello.h>
+#include <commons/string.h>
 
 extern t_config* worker_tconfig;
 
@@ -15,9 +16,13 @@ extern t_config* worker_tconfig;
  * @param puertomaster
  * @param ipstorage
  * @param puertostorage
+ * @param storages STORAGES: [ip:puerto,...] de un cluster de Storage (NULL = solo IP_STORAGE / PUERTO_STORAGE)
+ * @param replicasstorage REPLICAS_STORAGE: [ip:puerto,...] de las réplicas de solo lectura del Storage (NULL = ninguna)
  * @param tammemoria
  * @param retardomemoria
- * @param algoritmoreemplazo
+ * @param algoritmoreemplazo LRU, CLOCK-M, ARC, 2Q o CLOCK-PRO
+ * @param lecturadirecta LECTURA_DIRECTA: un READ sin ninguna página en memoria pide solo sus bytes al Storage, sin cargar páginas
+ * @param escrituradiferida ESCRITURA_DIFERIDA: write-back; un WRITE solo modifica la página y se manda al Storage al desalojarla o en FLUSH, COMMIT, TAG, TRUNCATE, desalojo o END
  * @param pathqueries
  * @param loglevel
  * 
@@ -29,9 +34,13 @@ typedef struct workerconfigs {
     int puertomaster;
     char* ipstorage;
     int puertostorage;
+    char** storages;
+    char** replicasstorage;
     int tammemoria;
     int retardomemoria;
     char* algoritmoreemplazo;
+    bool lecturadirecta;
+    bool escrituradiferida;
     char* pathqueries;
     char* loglevel;
 } workerconfigs;
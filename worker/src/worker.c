@@ -1,5 +1,6 @@
 #include "worker.h"
 #include "worker_memoria.h"
+#include "worker_shards.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,38 +22,14 @@ int main(int argc, char* argv[]){
 
     inicializar_estructuras_globales();
 
-    // ===== Conexión con Storage =====
-    char* puerto_storage_str = string_itoa(worker_configs.puertostorage);
-    int socket_storage = crear_conexion(worker_configs.ipstorage, puerto_storage_str);
-    free(puerto_storage_str);
-    if (socket_storage < 0) {
-        log_error(logger_worker, "Error al conectar con Storage");
+    // ===== Conexión con Storage (uno o varios, ver worker_shards) =====
+    uint32_t block_size = 0;
+    if (!conectar_shards(id_worker, &block_size)) {
+        desconectar_shards();
         destruir_estructuras_globales();
         return EXIT_FAILURE;
     }
-    log_info(logger_worker, "Conectado a Storage. Realizando handshake...");
-
-    // 1. Enviar ID de Worker a Storage
-    t_buffer* buffer_id_storage = serializar_worker(id_worker);
-    t_paquete* paquete_handshake_storage = empaquetar_buffer(HANDSHAKE_WORKER, buffer_id_storage);
-    enviar_paquete(socket_storage, paquete_handshake_storage);
-
-    // 2. Recibir BLOCK_SIZE de Storage
-    t_paquete* rta_handshake_storage = recibir_paquete(socket_storage);
-
-    if (rta_handshake_storage == NULL || rta_handshake_storage->codigo_operacion != HANDSAHKE_STORAGE_RTA) {
-        log_error(logger_worker, "Error en handshake con Storage. Storage desconectado.");
-        if(rta_handshake_storage) liberar_paquete(rta_handshake_storage);
-        close(socket_storage);
-        destruir_estructuras_globales();
-        return EXIT_FAILURE;
-    }
-    
-    // 3. Deserializar el BLOCK_SIZE y liberar paquete
-    uint32_t block_size = buffer_read_uint32(rta_handshake_storage->buffer);
-    liberar_paquete(rta_handshake_storage);
-
-    log_info(logger_worker, "Handshake con Storage OK. BLOCK_SIZE recibido: %d", block_size);
+    int socket_storage = shards_socket_principal();
     
     // 4. Inicializar memoria AHORA con el block_size
     inicializar_memoria(worker_configs.tammemoria, block_size);
@@ -63,7 +40,7 @@ int main(int argc, char* argv[]){
     free(puerto_master_str);
     if (socket_master < 0) {
         log_error(logger_worker, "Error al conectar con Master");
-        close(socket_storage);
+        desconectar_shards();
         destruir_estructuras_globales();
         return EXIT_FAILURE;
     }
@@ -97,7 +74,7 @@ int main(int argc, char* argv[]){
 
     liberar_memoria();
     close(socket_master);
-    close(socket_storage);
+    desconectar_shards();
     destruir_estructuras_globales();
     log_info(logger_worker, "Worker %d finalizado.", id_worker);
     return 0;
@@ -138,6 +115,7 @@ void* atender_master(void* arg){
             ejecutar_query(query_recibida->id_query,
                             query_recibida->archivo_query,
                             query_recibida->program_counter, // Pasamos el PC
+                            query_recibida->prioridad,
                             socket_master,
                             socket_storage);
 
@@ -1,15 +1,18 @@
 #include "worker_interpreter.h"
 #include "worker_memoria.h"
 #include "worker.h"
+#include "worker_shards.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <time.h>
 
 // --- Variables Globales --- 
 uint32_t query_actual_id = 0; 
 uint32_t query_actual_pc = 0; 
+uint32_t query_actual_prioridad = 0; // La manda el Master (con aging); va en cada operación a Storage
 bool ejecutando_query = false; 
 bool desalojar_actual = false; 
 bool desconexion_actual = false; 
@@ -38,8 +41,18 @@ void destruir_estructuras_globales() {
 
 /**
  * @brief Envía una operación simple (CREATE, WRITE, TRUNCATE, etc.) y espera una respuesta OK/ERROR.
+ * Va al Storage dueño del File (con un solo Storage, socket_storage).
  */
 t_codigo_operacion enviar_op_simple_storage(int socket_storage, int socket_master, t_codigo_operacion op_code, t_op_storage* op) {
+    if (op->nombre_file != NULL) socket_storage = shards_socket_de_file(op->nombre_file);
+    op->prioridad = query_actual_prioridad;
+
+    // Un File:Tag recién commiteado ya puede estar en las réplicas
+    if (op_code == COMMIT) shards_replica_puede_tener(op->nombre_file, op->nombre_tag);
+    // Borrado, recreado o pisado por un TAG: la réplica puede seguir sirviendo la versión vieja
+    if (op_code == DELETE || op_code == CREATE) shards_replica_no_tiene(op->nombre_file, op->nombre_tag);
+    if (op_code == TAG) shards_replica_no_tiene(op->nombre_file_destino, op->nombre_tag_destino);
+
     t_buffer* buffer = serializar_op_storage(op, op_code);
     t_paquete* paquete = empaquetar_buffer(op_code, buffer);
     enviar_paquete(socket_storage, paquete);
@@ -105,11 +118,76 @@ t_codigo_operacion enviar_op_simple_storage(int socket_storage, int socket_maste
     return rta_code;
 }
 
+/**
+ * @brief Manda un READ y espera el READ_RTA, sin avisarle nada al Master si falla.
+ * @param codigo Se completa con la respuesta del Storage si no se pudo leer (OP_ERROR si se desconectó)
+ * @return El contenido (tamanio bytes), o NULL.
+ */
+static char* leer_bloque_sin_avisar(int socket_storage, t_op_storage* op, int* tamanio, t_codigo_operacion* codigo) {
+    op->prioridad = query_actual_prioridad;
+    t_buffer* buffer = serializar_op_storage(op, READ);
+    enviar_paquete(socket_storage, empaquetar_buffer(READ, buffer));
+
+    t_paquete* paquete_rta = recibir_paquete(socket_storage);
+    if (paquete_rta == NULL) {
+        *codigo = OP_ERROR;
+        return NULL;
+    }
+    if (paquete_rta->codigo_operacion != READ_RTA) {
+        *codigo = paquete_rta->codigo_operacion;
+        liberar_paquete(paquete_rta);
+        return NULL;
+    }
+    t_op_storage* op_rta = deserializar_op_storage(paquete_rta->buffer, READ_RTA);
+    char* contenido = malloc(op_rta->tamano_contenido);
+    memcpy(contenido, op_rta->contenido, op_rta->tamano_contenido);
+    *tamanio = op_rta->tamano_contenido;
+    destruir_op_storage(op_rta);
+    liberar_paquete(paquete_rta);
+    return contenido;
+}
+
+/**
+ * @brief READ a una réplica de solo lectura (solo tiene los File:Tags COMMITED).
+ * @return El contenido, o NULL si hay que leer del Storage primario.
+ */
+static char* leer_de_replica(int replica, t_op_storage* op) {
+    struct timespec inicio, fin;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    int tamanio;
+    t_codigo_operacion codigo = OP_OK;
+    char* contenido = leer_bloque_sin_avisar(shards_socket_replica(replica), op, &tamanio, &codigo);
+
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    if (contenido != NULL) {
+        shards_replica_respondio(replica, (fin.tv_sec - inicio.tv_sec) * 1000.0 + (fin.tv_nsec - inicio.tv_nsec) / 1000000.0);
+    } else if (codigo == OP_ERROR) {
+        shards_replica_caida(replica);
+    } else if (codigo == FILE_TAG_INEXISTENTE) {
+        shards_replica_no_tiene(op->nombre_file, op->nombre_tag);
+    }
+    return contenido;
+}
+
 /**
  * @brief Envía una operación READ al Storage y espera un paquete READ_RTA con el contenido.
+ * Si hay réplicas, prueba primero en la menos cargada.
  * @return El contenido leído (char*), o NULL si falló.
  */
 char* enviar_op_read_storage(int socket_storage, int socket_master, t_op_storage* op) {
+    if (op->nombre_file != NULL) socket_storage = shards_socket_de_file(op->nombre_file);
+
+    int replica = op->nombre_file != NULL ? shards_elegir_replica(op->nombre_file, op->nombre_tag) : -1;
+    if (replica != -1) {
+        char* contenido = leer_de_replica(replica, op);
+        if (contenido != NULL) {
+            destruir_op_storage(op);
+            return contenido;
+        }
+    }
+
+    op->prioridad = query_actual_prioridad;
     t_buffer* buffer = serializar_op_storage(op, READ);
     t_paquete* paquete = empaquetar_buffer(READ, buffer);
     enviar_paquete(socket_storage, paquete);
@@ -137,7 +215,91 @@ char* enviar_op_read_storage(int socket_storage, int socket_master, t_op_storage
     return contenido;
 }
 
-void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
+/**
+ * @brief Lee un bloque de un File:Tag sin avisarle nada al Master (para copiarlo).
+ * @param codigo Se completa con la respuesta del Storage si no se pudo leer
+ * @return El contenido (tamanio bytes), o NULL.
+ */
+static char* leer_bloque_para_copia(int query_id, const char* file, const char* tag, int nro_bloque,
+                                    int* tamanio, t_codigo_operacion* codigo) {
+    t_op_storage* op_read = calloc(1, sizeof(t_op_storage));
+    op_read->query_id = query_id;
+    op_read->nombre_file = strdup(file);
+    op_read->nombre_tag = strdup(tag);
+    op_read->direccion_base = nro_bloque;
+
+    char* contenido = leer_bloque_sin_avisar(shards_socket_de_file(file), op_read, tamanio, codigo);
+    destruir_op_storage(op_read);
+    return contenido;
+}
+
+/**
+ * @brief TAG entre Files de Storage distintos: cada Storage solo ve sus Files, así que el
+ * Worker copia el origen (lee los bloques hasta el final) y lo crea en el Storage del destino.
+ * Los bloques en cero no se escriben: después del TRUNCATE ya apuntan al bloque 0.
+ */
+static void copiar_tag_entre_shards(int query_id, t_op_storage* op_tag, int socket_master) {
+    t_list* bloques = list_create();
+    int tamanio_bloque = 0;
+    t_codigo_operacion codigo = OP_OK;
+
+    // 1. Leer el origen entero (termina con LECTURA_O_ESCRITURA_FUERA_DE_LIMITE)
+    char* contenido;
+    while ((contenido = leer_bloque_para_copia(query_id, op_tag->nombre_file, op_tag->nombre_tag,
+                                               list_size(bloques), &tamanio_bloque, &codigo)) != NULL) {
+        list_add(bloques, contenido);
+    }
+
+    if (codigo != LECTURA_O_ESCRITURA_FUERA_DE_LIMITE) {
+        t_buffer* buffer_error = serializar_operacion_end("FILE / TAG INEXISTENTE");
+        enviar_paquete(socket_master, empaquetar_buffer(END, buffer_error));
+        error = true;
+        list_destroy_and_destroy_elements(bloques, free);
+        return;
+    }
+
+    log_info(logger_worker, "## Query %d: TAG entre Storage distintos: se copian %d bloques de %s:%s a %s:%s",
+             query_id, list_size(bloques), op_tag->nombre_file, op_tag->nombre_tag,
+             op_tag->nombre_file_destino, op_tag->nombre_tag_destino);
+
+    // 2. CREATE + TRUNCATE en el Storage del destino
+    t_op_storage* op_create = calloc(1, sizeof(t_op_storage));
+    op_create->query_id = query_id;
+    op_create->nombre_file = strdup(op_tag->nombre_file_destino);
+    op_create->nombre_tag = strdup(op_tag->nombre_tag_destino);
+    bool exito = enviar_op_simple_storage(-1, socket_master, CREATE, op_create) == OP_OK;
+
+    if (exito && list_size(bloques) > 0) {
+        t_op_storage* op_truncate = calloc(1, sizeof(t_op_storage));
+        op_truncate->query_id = query_id;
+        op_truncate->nombre_file = strdup(op_tag->nombre_file_destino);
+        op_truncate->nombre_tag = strdup(op_tag->nombre_tag_destino);
+        op_truncate->tamano = list_size(bloques) * tamanio_bloque;
+        exito = enviar_op_simple_storage(-1, socket_master, TRUNCATE, op_truncate) == OP_OK;
+    }
+
+    // 3. WRITE de los bloques con datos
+    for (int i = 0; exito && i < list_size(bloques); i++) {
+        char* bloque = list_get(bloques, i);
+        bool en_cero = true;
+        for (int b = 0; b < tamanio_bloque && en_cero; b++) en_cero = bloque[b] == 0;
+        if (en_cero) continue;
+
+        t_op_storage* op_write = calloc(1, sizeof(t_op_storage));
+        op_write->query_id = query_id;
+        op_write->nombre_file = strdup(op_tag->nombre_file_destino);
+        op_write->nombre_tag = strdup(op_tag->nombre_tag_destino);
+        op_write->direccion_base = i;
+        op_write->tamano_contenido = tamanio_bloque;
+        op_write->contenido = malloc(tamanio_bloque);
+        memcpy(op_write->contenido, bloque, tamanio_bloque);
+        exito = enviar_op_simple_storage(-1, socket_master, WRITE, op_write) == OP_OK;
+    }
+
+    list_destroy_and_destroy_elements(bloques, free);
+}
+
+void ejecutar_query(int query_id, char* path_query, uint32_t program_counter, uint32_t prioridad,
                     int socket_master, int socket_storage) {
     
     FILE* archivo = fopen(path_query, "r");
@@ -154,12 +316,16 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
     pthread_mutex_lock(&mutex_flags);
     query_actual_id = query_id;
     query_actual_pc = 0;
+    query_actual_prioridad = prioridad;
     ejecutando_query = true;
     desalojar_actual = false;
     desconexion_actual = false;
     error = false;
     pthread_mutex_unlock(&mutex_flags);
 
+    // Con ESCRITURA_DIFERIDA, el primer WRITE de esta Query a cada File:Tag se valida en el Storage
+    olvidar_escrituras_validadas(NULL, NULL);
+
 
     char linea[256];
     uint32_t pc_actual = 0;
@@ -182,14 +348,17 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
         if (hay_desalojar) {
             log_info(logger_worker, "## Query %d: Desalojo solicitado (PC=%d)", query_actual_id, pc_actual);
 
-            // Antes de irse, guarda todo lo que esté "sucio" en memoria
-            realizar_flush_file(query_actual_id, NULL, NULL, socket_storage, socket_master); 
-
-            // Paquete con el Program Counter actual
-            t_query_ejecucion query_actualizada = {path_query, query_id, pc_actual};
-            t_buffer* buffer_pc = serializar_query_ejecucion(&query_actualizada);
-            t_paquete* paquete_pc = empaquetar_buffer(DESALOJO_PRIORIDADES, buffer_pc);
-            enviar_paquete(socket_master, paquete_pc);
+            // Antes de irse, guarda todo lo que esté "sucio" en memoria. Si el Storage rechaza
+            // una página la Query ya terminó con error: lo que no llegó se descarta y no vuelve al Master
+            if (realizar_flush_file(query_actual_id, NULL, NULL, socket_storage, socket_master)) {
+                // Paquete con el Program Counter actual
+                t_query_ejecucion query_actualizada = {path_query, query_id, pc_actual, prioridad};
+                t_buffer* buffer_pc = serializar_query_ejecucion(&query_actualizada);
+                t_paquete* paquete_pc = empaquetar_buffer(DESALOJO_PRIORIDADES, buffer_pc);
+                enviar_paquete(socket_master, paquete_pc);
+            } else {
+                descartar_paginas_modificadas(query_id);
+            }
 
             pthread_mutex_lock(&mutex_flags);
             desalojar_actual = false;
@@ -207,6 +376,8 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
         if (hay_desconexion) {
 
             log_info(logger_worker, "Se desconectó la query, %d", query_actual_id);
+            // Lo que la Query dejó modificado (con write-back, sin mandar) no llega al Storage
+            descartar_paginas_modificadas(query_id);
             t_buffer* buffer = serializar_operacion_end("DESCONEXION QUERY");
             t_paquete* paquete = empaquetar_buffer(END, buffer);
             enviar_paquete(socket_master, paquete);
@@ -262,10 +433,19 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
                 t_op_storage* op_truncate = calloc(1, sizeof(t_op_storage));
                 op_truncate->query_id = query_id;
                 file_tag_copy = strdup(file_tag_str);
-                op_truncate->nombre_file = strdup(strtok(file_tag_copy, ":"));
-                op_truncate->nombre_tag  = strdup(strtok(NULL, ":"));
+                char* file_local = strtok(file_tag_copy, ":");
+                char* tag_local  = strtok(NULL, ":");
+                op_truncate->nombre_file = strdup(file_local);
+                op_truncate->nombre_tag  = strdup(tag_local);
                 op_truncate->tamano = atoi(tamanio_str);
-                enviar_op_simple_storage(socket_storage, socket_master, TRUNCATE, op_truncate);
+                // Con write-back, lo modificado llega al Storage antes de achicar o agrandar
+                if (worker_configs.escrituradiferida &&
+                    !realizar_flush_file(query_id, op_truncate->nombre_file, op_truncate->nombre_tag, socket_storage, socket_master)) {
+                    destruir_op_storage(op_truncate);
+                } else if (enviar_op_simple_storage(socket_storage, socket_master, TRUNCATE, op_truncate) == OP_OK) {
+                    // Lo que quedó afuera no se puede seguir leyendo ni escribiendo desde memoria
+                    descartar_paginas_fuera_de_tamanio(query_id, file_local, tag_local, atoi(tamanio_str));
+                }
                 free(file_tag_copy);
             }
         }
@@ -304,7 +484,12 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
                 // LLAMADA A LA MMU. Si hay Page Fault, mmu deberia encargarse
                 char* valor_leido = leer_de_memoria(query_id, file_local, tag_local, 
                                                     atoi(direccion), atoi(tamanio), socket_storage, socket_master);
-                
+
+                // Si algo falló en el camino (ej: el FLUSH de una víctima) el Master ya recibió el END
+                if (error) {
+                    free(valor_leido);
+                    valor_leido = NULL;
+                }
                 if (valor_leido != NULL) {
                     t_operacion_query op_read_rta;
                     op_read_rta.file = strdup(file_local); 
@@ -340,7 +525,16 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
                 op_tag->nombre_file_destino = strdup(strtok(file_tag_copy, ":"));
                 op_tag->nombre_tag_destino  = strdup(strtok(NULL, ":"));
                 free(file_tag_copy);
-                enviar_op_simple_storage(socket_storage, socket_master, TAG, op_tag);
+                // Con write-back, el Storage tiene que copiar el origen con lo modificado en memoria
+                if (worker_configs.escrituradiferida &&
+                    !realizar_flush_file(query_id, op_tag->nombre_file, op_tag->nombre_tag, socket_storage, socket_master)) {
+                    destruir_op_storage(op_tag);
+                } else if (shards_mismo_shard(op_tag->nombre_file, op_tag->nombre_file_destino)) {
+                    enviar_op_simple_storage(socket_storage, socket_master, TAG, op_tag);
+                } else {
+                    copiar_tag_entre_shards(query_id, op_tag, socket_master);
+                    destruir_op_storage(op_tag);
+                }
             }
         }
 
@@ -352,16 +546,18 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
                 char* file_local = strdup(strtok(file_tag_copy, ":"));
                 char* tag_local  = strdup(strtok(NULL, ":"));
                 
-                // 1. FLUSH de páginas sucias de ESTE archivo
-                realizar_flush_file(query_id, file_local, tag_local, socket_storage, socket_master);
-                
-                // 2. Enviar instrucción COMMIT
-                t_op_storage* op_commit = calloc(1, sizeof(t_op_storage));
-                op_commit->query_id = query_id;
-                op_commit->nombre_file = strdup(file_local);
-                op_commit->nombre_tag  = strdup(tag_local);
-                
-                enviar_op_simple_storage(socket_storage, socket_master, COMMIT, op_commit);
+                // 1. FLUSH de páginas sucias de ESTE archivo (si el Storage rechaza una, no se commitea)
+                if (realizar_flush_file(query_id, file_local, tag_local, socket_storage, socket_master)) {
+                    // 2. Enviar instrucción COMMIT
+                    t_op_storage* op_commit = calloc(1, sizeof(t_op_storage));
+                    op_commit->query_id = query_id;
+                    op_commit->nombre_file = strdup(file_local);
+                    op_commit->nombre_tag  = strdup(tag_local);
+                    
+                    enviar_op_simple_storage(socket_storage, socket_master, COMMIT, op_commit);
+                    // Commiteado ya no se puede escribir: el próximo WRITE va al Storage para que lo rechace
+                    olvidar_escrituras_validadas(file_local, tag_local);
+                }
                 
                 free(file_local);
                 free(tag_local);
@@ -389,10 +585,17 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
                 t_op_storage* op_delete = calloc(1, sizeof(t_op_storage));
                 op_delete->query_id = query_id;
                 file_tag_copy = strdup(file_tag_str);
-                op_delete->nombre_file = strdup(strtok(file_tag_copy, ":"));
-                op_delete->nombre_tag  = strdup(strtok(NULL, ":"));
+                char* file_local = strtok(file_tag_copy, ":");
+                char* tag_local  = strtok(NULL, ":");
+                op_delete->nombre_file = strdup(file_local);
+                op_delete->nombre_tag  = strdup(tag_local);
+                // Borrado en el Storage, sus páginas ya no sirven (y no hay que mandarlas si estaban modificadas).
+                // OP_ERROR: se borró en el primario pero alguna réplica no confirmó el borrado
+                t_codigo_operacion rta_delete = enviar_op_simple_storage(socket_storage, socket_master, DELETE, op_delete);
+                if (rta_delete == OP_OK || rta_delete == OP_ERROR) {
+                    descartar_paginas_file(query_id, file_local, tag_local);
+                }
                 free(file_tag_copy);
-                enviar_op_simple_storage(socket_storage, socket_master, DELETE, op_delete);
             }
         }
         // ==== END ====
@@ -401,11 +604,17 @@ void ejecutar_query(int query_id, char* path_query, uint32_t program_counter,
             t_buffer* buffer_end = serializar_operacion_end(motivo);
             t_paquete* paquete_end = empaquetar_buffer(END, buffer_end);
             enviar_paquete(socket_master, paquete_end);*/
+            // Con write-back, lo modificado llega al Storage antes de terminar la Query
+            if (worker_configs.escrituradiferida) {
+                realizar_flush_file(query_id, NULL, NULL, socket_storage, socket_master);
+            }
             enviar_end_al_final = true;
             fin = true;
         }
 
         if (error){
+            // Lo que quedó modificado sin llegar al Storage no vale (el Master ya sabe que falló)
+            descartar_paginas_modificadas(query_id);
             
             pthread_mutex_lock(&mutex_flags);
             desalojar_actual = false;
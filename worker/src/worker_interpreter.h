@@ -8,6 +8,7 @@
 
 extern uint32_t query_actual_id;
 extern uint32_t query_actual_pc;
+extern uint32_t query_actual_prioridad;
 extern bool ejecutando_query;
 extern bool desalojar_actual;
 extern bool desconexion_actual;
@@ -20,7 +21,7 @@ void destruir_estructuras_globales();
 
 /**
  * @brief Envía una operación simple (CREATE, WRITE, TRUNCATE, etc.)
- * y espera una respuesta OK/ERROR.
+ * y espera una respuesta OK/ERROR. La operación lleva la prioridad de la Query actual.
  */
 t_codigo_operacion enviar_op_simple_storage(int socket_storage, int socket_master, t_codigo_operacion op_code, t_op_storage* op);
 
@@ -31,6 +32,6 @@ t_codigo_operacion enviar_op_simple_storage(int socket_storage, int socket_maste
  */
 char* enviar_op_read_storage(int socket_storage, int socket_master, t_op_storage* op);
 
-void ejecutar_query(int query_id, char* path_query, uint32_t program_counter, int socket_master, int socket_storage);
+void ejecutar_query(int query_id, char* path_query, uint32_t program_counter, uint32_t prioridad, int socket_master, int socket_storage);
 
 #endif
\ No newline at end of file
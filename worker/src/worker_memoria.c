@@ -1,4 +1,5 @@
 #include "worker_memoria.h"
+#include "worker_reemplazo.h"
 #include "worker-configs.h"
 #include "worker-log.h"
 #include "worker.h"
@@ -11,11 +12,158 @@
 
 // --- Variables estáticas del módulo de memoria ---
 static void* memoria_principal;
-static PaginaMemoria* tabla_de_marcos;
 static int cantidad_marcos;
 static int tam_pagina;
-static int puntero_clock = 0;
-static unsigned long long contador_lru = 0;
+
+// Algoritmo de reemplazo (ALGORITMO_REEMPLAZO), elegido al inicializar
+static const t_algoritmo_reemplazo* algoritmo;
+
+// Tabla de marcos como arrays paralelos (índice = marco) y bitsets de 64 marcos por palabra
+static int* marco_file_tag;                   // ID del File:Tag dueño de la página
+static int* marco_pagina;                     // Número de página
+static uint64_t* bits_ocupado;
+static uint64_t* bits_modificado;
+static int cantidad_palabras;
+
+// Lista intrusiva de marcos libres (enlazada por marco_siguiente_libre)
+static int* marco_siguiente_libre;
+static int primer_marco_libre = -1;
+
+// File:Tags internados ("FILE:TAG" -> t_file_tag*) y su acceso por ID
+static t_dictionary* ids_file_tag;
+static t_file_tag** file_tags;
+static int capacidad_file_tags;
+static int* ids_libres;
+static int cantidad_ids_libres;
+
+// ESCRITURA_DIFERIDA: un File:Tag con escritura_validada == epoca_escrituras ya tuvo un WRITE aceptado por el Storage en esta Query
+static uint32_t epoca_escrituras = 1;
+
+static inline bool bit_leer(const uint64_t* bits, int marco) {
+    return (bits[marco / 64] >> (marco % 64)) & 1;
+}
+
+static inline void bit_poner(uint64_t* bits, int marco) {
+    bits[marco / 64] |= (uint64_t) 1 << (marco % 64);
+}
+
+static inline void bit_sacar(uint64_t* bits, int marco) {
+    bits[marco / 64] &= ~((uint64_t) 1 << (marco % 64));
+}
+
+// Arma la clave "FILE:TAG" del File:Tag en clave (de 2 * MAX_FILETAG)
+static void clave_file_tag(char* clave, const char* file, const char* tag) {
+    snprintf(clave, 2 * MAX_FILETAG, "%s:%s", file, tag);
+}
+
+static t_file_tag* buscar_file_tag(const char* file, const char* tag) {
+    char clave[2 * MAX_FILETAG];
+    clave_file_tag(clave, file, tag);
+    return dictionary_get(ids_file_tag, clave);
+}
+
+// Devuelve el File:Tag internado (le da un ID libre si todavía no tiene páginas en memoria)
+static t_file_tag* internar_file_tag(const char* file, const char* tag) {
+    t_file_tag* file_tag = buscar_file_tag(file, tag);
+    if (file_tag != NULL) return file_tag;
+
+    int id;
+    if (cantidad_ids_libres > 0) {
+        id = ids_libres[--cantidad_ids_libres];
+    } else {
+        id = capacidad_file_tags;
+        capacidad_file_tags = capacidad_file_tags > 0 ? capacidad_file_tags * 2 : 8;
+        file_tags = realloc(file_tags, capacidad_file_tags * sizeof(t_file_tag*));
+        ids_libres = realloc(ids_libres, capacidad_file_tags * sizeof(int));
+        // Los IDs nuevos (menos el que se usa ahora) quedan libres, los más bajos arriba de la pila
+        for (int i = capacidad_file_tags - 1; i > id; i--) ids_libres[cantidad_ids_libres++] = i;
+    }
+
+    file_tag = calloc(1, sizeof(t_file_tag));
+    file_tag->id = id;
+    file_tag->file = strdup(file);
+    file_tag->tag = strdup(tag);
+    file_tags[id] = file_tag;
+
+    char clave[2 * MAX_FILETAG];
+    clave_file_tag(clave, file, tag);
+    dictionary_put(ids_file_tag, clave, file_tag);
+    return file_tag;
+}
+
+static void destruir_file_tag(void* arg) {
+    t_file_tag* file_tag = arg;
+    free(file_tag->paginas.marcos);
+    free(file_tag->file);
+    free(file_tag->tag);
+    free(file_tag);
+}
+
+// Registra que la página num_pagina del File:Tag quedó en el marco
+static void tabla_paginas_asignar(t_file_tag* file_tag, int num_pagina, int marco) {
+    t_tabla_paginas* tabla = &file_tag->paginas;
+    if (num_pagina >= tabla->capacidad) {
+        int nueva_capacidad = tabla->capacidad > 0 ? tabla->capacidad : 8;
+        while (nueva_capacidad <= num_pagina) nueva_capacidad *= 2;
+        tabla->marcos = realloc(tabla->marcos, nueva_capacidad * sizeof(int));
+        for (int i = tabla->capacidad; i < nueva_capacidad; i++) tabla->marcos[i] = -1;
+        tabla->capacidad = nueva_capacidad;
+    }
+
+    if (tabla->marcos[num_pagina] == -1) tabla->cargadas++;
+    tabla->marcos[num_pagina] = marco;
+}
+
+// Saca la página del marco de la tabla de su File:Tag (sin páginas, el File:Tag libera su ID)
+static void tabla_paginas_quitar(int marco) {
+    t_file_tag* file_tag = file_tags[marco_file_tag[marco]];
+    t_tabla_paginas* tabla = &file_tag->paginas;
+    int num_pagina = marco_pagina[marco];
+    if (num_pagina < 0 || num_pagina >= tabla->capacidad || tabla->marcos[num_pagina] == -1) return;
+
+    tabla->marcos[num_pagina] = -1;
+    if (--tabla->cargadas == 0) {
+        char clave[2 * MAX_FILETAG];
+        clave_file_tag(clave, file_tag->file, file_tag->tag);
+        dictionary_remove(ids_file_tag, clave);
+        file_tags[file_tag->id] = NULL;
+        ids_libres[cantidad_ids_libres++] = file_tag->id;
+        destruir_file_tag(file_tag);
+    }
+}
+
+// Clave de 64 bits de la página para el algoritmo de reemplazo: FNV-1a de "FILE:TAG" mezclado con la página
+static uint64_t clave_pagina(const char* file, const char* tag, int num_pagina) {
+    char clave[2 * MAX_FILETAG];
+    clave_file_tag(clave, file, tag);
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char* c = (const unsigned char*) clave; *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    }
+    return hash ^ ((uint64_t) num_pagina * 0x9E3779B97F4A7C15ULL);
+}
+
+// Devuelve a la lista de libres un marco que se sacó y al final no se ocupó
+static void devolver_marco_libre(int marco) {
+    marco_siguiente_libre[marco] = primer_marco_libre;
+    primer_marco_libre = marco;
+}
+
+// Carga la página num_pagina del File:Tag en el marco y se la avisa al algoritmo de reemplazo
+static void ocupar_marco(int marco, const char* file, const char* tag, int num_pagina) {
+    if (bit_leer(bits_ocupado, marco)) {
+        algoritmo->al_acceder(marco); // Ya era suya (WRITE con hit)
+        return;
+    }
+
+    t_file_tag* file_tag = internar_file_tag(file, tag);
+    marco_file_tag[marco] = file_tag->id;
+    marco_pagina[marco] = num_pagina;
+    bit_poner(bits_ocupado, marco);
+    tabla_paginas_asignar(file_tag, num_pagina, marco);
+    algoritmo->al_cargar(marco, clave_pagina(file, tag, num_pagina));
+}
 
 void inicializar_memoria(int tam_mem, int tam_pag) {
     memoria_principal = calloc(1, tam_mem);
@@ -25,28 +173,60 @@ void inicializar_memoria(int tam_mem, int tam_pag) {
     }
     cantidad_marcos = tam_mem / tam_pag;
     tam_pagina = tam_pag;
-    tabla_de_marcos = calloc(cantidad_marcos, sizeof(PaginaMemoria));
-    if (tabla_de_marcos == NULL) {
-        log_error(logger_worker, "Error fatal: calloc falló para tabla_de_marcos");
+    cantidad_palabras = (cantidad_marcos + 63) / 64;
+
+    marco_file_tag = malloc(cantidad_marcos * sizeof(int));
+    marco_pagina = malloc(cantidad_marcos * sizeof(int));
+    bits_ocupado = calloc(cantidad_palabras, sizeof(uint64_t));
+    bits_modificado = calloc(cantidad_palabras, sizeof(uint64_t));
+    marco_siguiente_libre = malloc(cantidad_marcos * sizeof(int));
+    if (marco_file_tag == NULL || marco_pagina == NULL || bits_ocupado == NULL ||
+        bits_modificado == NULL || marco_siguiente_libre == NULL) {
+        log_error(logger_worker, "Error fatal: calloc falló para la tabla de marcos");
         free(memoria_principal);
         exit(EXIT_FAILURE);
     }
+    for (int i = 0; i < cantidad_marcos; i++) {
+        marco_file_tag[i] = -1;
+        marco_pagina[i] = -1;
+        // Al principio todos libres, en orden
+        marco_siguiente_libre[i] = i + 1 < cantidad_marcos ? i + 1 : -1;
+    }
+    primer_marco_libre = cantidad_marcos > 0 ? 0 : -1;
+    ids_file_tag = dictionary_create();
 
-    log_info(logger_worker, "Memoria inicializada: %d bytes (%d marcos de %d bytes)", tam_mem, cantidad_marcos, tam_pag);
+    // El algoritmo se elige una sola vez
+    algoritmo = algoritmo_reemplazo_por_nombre(worker_configs.algoritmoreemplazo);
+    if (algoritmo == NULL) {
+        log_warning(logger_worker, "Algoritmo de reemplazo desconocido. Usando LRU por defecto.");
+        algoritmo = algoritmo_reemplazo_por_nombre("LRU");
+    }
+    algoritmo->inicializar(cantidad_marcos, bits_modificado);
+
+    log_info(logger_worker, "Memoria inicializada: %d bytes (%d marcos de %d bytes), reemplazo %s", tam_mem, cantidad_marcos, tam_pag, algoritmo->nombre);
 }
 
 void liberar_memoria() {
     free(memoria_principal);
-    free(tabla_de_marcos);
+    free(marco_file_tag);
+    free(marco_pagina);
+    free(bits_ocupado);
+    free(bits_modificado);
+    free(marco_siguiente_libre);
+    algoritmo->destruir();
+    dictionary_destroy_and_destroy_elements(ids_file_tag, destruir_file_tag);
+    free(file_tags);
+    free(ids_libres);
 }
 
 static int obtener_marco_libre() {
-    for (int i = 0; i < cantidad_marcos; i++) {
-        if (!tabla_de_marcos[i].ocupado) {
-            return i;
-        }
+    if (primer_marco_libre == -1) {
+        return -1; // No hay marcos libres
     }
-    return -1; // No hay marcos libres
+    int marco = primer_marco_libre;
+    primer_marco_libre = marco_siguiente_libre[marco];
+    marco_siguiente_libre[marco] = -1;
+    return marco;
 }
 
 static int reemplazar_pagina(int query_id, int socket_storage,
@@ -54,126 +234,59 @@ static int reemplazar_pagina(int query_id, int socket_storage,
                              const char* nuevo_file,
                              const char* nuevo_tag,
                              int nuevo_num_pagina) {
-    int marco_victima = -1;
-    
-    if (strcasecmp(worker_configs.algoritmoreemplazo, "LRU") == 0) {
-        // LRU
-        unsigned long long mas_antiguo = ULLONG_MAX;
-        
-        for (int i = 0; i < cantidad_marcos; i++) {
-            if (tabla_de_marcos[i].ocupado && tabla_de_marcos[i].timestamp < mas_antiguo) {
-                mas_antiguo = tabla_de_marcos[i].timestamp;
-                marco_victima = i;
-            }
-        }
-
-        log_info(logger_worker, "## LRU Marco víctima: %d (timestamp más antiguo: %llu)", 
-                 marco_victima, mas_antiguo);
+    int marco_victima = algoritmo->elegir_victima(clave_pagina(nuevo_file, nuevo_tag, nuevo_num_pagina));
 
+    if (!bit_leer(bits_ocupado, marco_victima)) {
+        return marco_victima;
     }
 
-    else if (strcasecmp(worker_configs.algoritmoreemplazo, "CLOCK-M") == 0) {
-        // CLOCK-M: Algoritmo de 4 pasos 
-        // Paso 1: Buscar (U=0, M=0). No tocar nada.
-        // Paso 2: Buscar (U=0, M=1). Poner U=0 a los que pasemos.
-        
-        int start_pointer = puntero_clock;
-        int pasos = 0;
+    t_file_tag* victima = file_tags[marco_file_tag[marco_victima]];
 
-        // Maximo 2 iteraciones completas sobre la memoria para cubrir los 4 pasos logicos
-        while (marco_victima == -1 && pasos < 4) { 
-            
-            for (int i = 0; i < cantidad_marcos; i++) {
-                int idx = (start_pointer + i) % cantidad_marcos;
-                PaginaMemoria* pag = &tabla_de_marcos[idx];
-
-                if (!pag->ocupado) { // Si esta libre, uso directo
-                    marco_victima = idx;
-                    break;
-                }
-
-                // Pasos 1 y 3: Buscamos U=0, M=0
-                if (pasos == 0 || pasos == 2) {
-                    if (!pag->usado && !pag->modificado) {
-                        marco_victima = idx;
-                        break;
-                    }
-                }
-                
-                // Pasos 2 y 4: Buscamos U=0, M=1. bajamos el bit de uso (U=0)
-                if (pasos == 1 || pasos == 3) {
-                    if (!pag->usado && pag->modificado) {
-                        marco_victima = idx;
-                        break;
-                    }
-                    // Efecto colateral del paso 2 (y 4): bajar bandera de uso
-                    pag->usado = false; 
-                }
-            }
-            
-            if (marco_victima != -1) {
-                puntero_clock = (marco_victima + 1) % cantidad_marcos; // Avanzar puntero para la proxima
-                break;
-            }
-            pasos++;
-        }
-        log_info(logger_worker, "## CLOCK-M Marco víctima: %d", marco_victima);
-    }
-    else {
-        log_warning(logger_worker, "Algoritmo de reemplazo desconocido. Usando LRU por defecto.");
-        marco_victima = 0;
-    }
-    
-    
-    PaginaMemoria* victima = &tabla_de_marcos[marco_victima];
-
-    log_info(logger_worker, "## Query %d: Se reemplaza la página %s:%s/%d por la %s:%s/%d", 
-             query_id, victima->file, victima->tag, victima->num_pagina, nuevo_file, nuevo_tag, nuevo_num_pagina);
+    log_info(logger_worker, "## Query %d: Se reemplaza la página %s:%s/%d por la %s:%s/%d",
+             query_id, victima->file, victima->tag, marco_pagina[marco_victima], nuevo_file, nuevo_tag, nuevo_num_pagina);
 
-    if (victima->modificado) {
+    if (bit_leer(bits_modificado, marco_victima)) {
         log_info(logger_worker, "La página víctima (Marco %d) está modificada. FLUSH a Storage.", marco_victima);
-        
+
         t_op_storage* op_flush = calloc(1, sizeof(t_op_storage));
         op_flush->query_id = query_id;
         op_flush->nombre_file = strdup(victima->file);
         op_flush->nombre_tag = strdup(victima->tag);
-        op_flush->direccion_base = victima->num_pagina;
-        
+        op_flush->direccion_base = marco_pagina[marco_victima];
+
         // cambio bin
-        op_flush->tamano_contenido = tam_pagina; 
+        op_flush->tamano_contenido = tam_pagina;
         op_flush->contenido = malloc(tam_pagina);
         memcpy(op_flush->contenido, memoria_principal + (marco_victima * tam_pagina), tam_pagina);
 
-        enviar_op_simple_storage(socket_storage, socket_master, WRITE, op_flush);
+        // Si el Storage no la aceptó, la página se queda en memoria y modificada (no se pierde)
+        if (enviar_op_simple_storage(socket_storage, socket_master, WRITE, op_flush) != OP_OK) {
+            log_error(logger_worker, "## Query %d: No se pudo desalojar el Marco %d: falló el FLUSH", query_id, marco_victima);
+            return -1;
+        }
     }
 
-    // Liberar marco para su reutilización
-    victima->ocupado = false;
-    victima->modificado = false;
-    victima->usado = false;
-    victima->timestamp = 0;
-    victima->file[0] = '\0';
-    victima->tag[0] = '\0';
-    victima->num_pagina = -1;
-
     log_info(logger_worker, "Query %d: Se libera el Marco: %d perteneciente al - File: %s - Tag: %s",
              query_id, marco_victima, victima->file, victima->tag);
 
+    // Liberar marco para su reutilización (victima deja de valer si era la última página del File:Tag)
+    algoritmo->al_desalojar(marco_victima);
+    tabla_paginas_quitar(marco_victima);
+    bit_sacar(bits_ocupado, marco_victima);
+    bit_sacar(bits_modificado, marco_victima);
+    marco_file_tag[marco_victima] = -1;
+    marco_pagina[marco_victima] = -1;
+
     return marco_victima;
 }
 
-// Busca si una página ya está en memoria
+// Busca si una página ya está en memoria (en la tabla de páginas de su File:Tag)
 static int buscar_pagina_en_memoria(const char* file, const char* tag, int num_pagina) {
-    for (int i = 0; i < cantidad_marcos; i++) {
-        if (tabla_de_marcos[i].ocupado &&
-            tabla_de_marcos[i].num_pagina == num_pagina &&
-            strcmp(tabla_de_marcos[i].file, file) == 0 &&
-            strcmp(tabla_de_marcos[i].tag, tag) == 0) 
-        {
-            return i; // Page Hit
-        }
+    t_file_tag* file_tag = buscar_file_tag(file, tag);
+    if (file_tag == NULL || num_pagina < 0 || num_pagina >= file_tag->paginas.capacidad) {
+        return -1; // Page Fault
     }
-    return -1; // Page Fault
+    return file_tag->paginas.marcos[num_pagina]; // Page Hit (o -1 si no está)
 }
 
 void escribir_en_memoria(int query_id, const char* file, const char* tag, int direccion_logica, const char* contenido, int socket_storage, int socket_master) {
@@ -182,6 +295,12 @@ void escribir_en_memoria(int query_id, const char* file, const char* tag, int di
     int bytes_escritos = 0;
     int dir_logica_actual = direccion_logica;
 
+    // Con ESCRITURA_DIFERIDA el primer WRITE de la Query a cada File:Tag va al Storage, que así valida
+    // que se pueda escribir (existe, no está COMMITED); el límite lo valida la lectura de cada page fault
+    t_file_tag* file_tag_escrito = buscar_file_tag(file, tag);
+    bool diferir = worker_configs.escrituradiferida && file_tag_escrito != NULL &&
+                   file_tag_escrito->escritura_validada == epoca_escrituras;
+
     // BUCLE PARA ESCRIBIR EN MÚLTIPLES PÁGINAS SI ES NECESARIO
     while (bytes_escritos < bytes_totales) {
         
@@ -199,6 +318,7 @@ void escribir_en_memoria(int query_id, const char* file, const char* tag, int di
             marco = obtener_marco_libre();
             if (marco == -1) {
                 marco = reemplazar_pagina(query_id, socket_storage, socket_master, file, tag, num_pagina);
+                if (marco == -1) return; // No se pudo mandar la víctima al Storage
             }
             
             // Traer contenido original de Storage (para no romper el resto de la página)
@@ -214,6 +334,10 @@ void escribir_en_memoria(int query_id, const char* file, const char* tag, int di
             if (contenido_bloque != NULL) {
                 memcpy(memoria_principal + (marco * tam_pagina), contenido_bloque, tam_pagina);
                 free(contenido_bloque);
+            } else if (error) {
+                // El Storage rechazó la página (ya se le avisó al Master): no se escribe nada
+                devolver_marco_libre(marco);
+                return;
             } else {
                 memset(memoria_principal + (marco * tam_pagina), 0, tam_pagina);
             }
@@ -242,31 +366,35 @@ void escribir_en_memoria(int query_id, const char* file, const char* tag, int di
         // log_info(logger_worker, "## Query %d: Escribiendo en DirFisica: %d (%d bytes)", query_id, direccion_fisica, bytes_a_escribir_ahora);
 
         // 5. Actualizar Metadata de la Página
-        PaginaMemoria* pagina_info = &tabla_de_marcos[marco];
-        pagina_info->ocupado = true;
-        pagina_info->modificado = true; 
-        pagina_info->usado = true;
-        //pagina_info->timestamp = (unsigned long long)time(NULL); 
-        pagina_info->timestamp = ++contador_lru;
-        pagina_info->num_pagina = num_pagina;
-        strncpy(pagina_info->file, file, MAX_FILETAG - 1);
-        strncpy(pagina_info->tag, tag, MAX_FILETAG - 1);
+        ocupar_marco(marco, file, tag, num_pagina);
+        bit_poner(bits_modificado, marco);
 
         log_info(logger_worker, "Query %d: Acción: ESCRIBIR - DirFisica: %d - Pagina: %d", query_id, direccion_fisica, num_pagina);
         
         // 6. Write-Through (Enviar inmediatamente al Storage)
         // OJO: Esto manda UN bloque al storage. Como el Storage ya soporta recibir el bloque
         // y actualizarlo, esto está bien.
-        t_op_storage* op_write = calloc(1, sizeof(t_op_storage));
-        op_write->query_id = query_id;
-        op_write->nombre_file = strdup(file);
-        op_write->nombre_tag  = strdup(tag);
-        op_write->direccion_base = num_pagina; 
-        op_write->tamano_contenido = tam_pagina;
-        op_write->contenido = malloc(tam_pagina);
-        memcpy(op_write->contenido, memoria_principal + (marco * tam_pagina), tam_pagina);
-        
-        enviar_op_simple_storage(socket_storage, socket_master, WRITE, op_write);
+        // Con ESCRITURA_DIFERIDA la página queda modificada y se manda cuando se desaloje o haya un FLUSH
+        if (!diferir) {
+            t_op_storage* op_write = calloc(1, sizeof(t_op_storage));
+            op_write->query_id = query_id;
+            op_write->nombre_file = strdup(file);
+            op_write->nombre_tag  = strdup(tag);
+            op_write->direccion_base = num_pagina; 
+            op_write->tamano_contenido = tam_pagina;
+            op_write->contenido = malloc(tam_pagina);
+            memcpy(op_write->contenido, memoria_principal + (marco * tam_pagina), tam_pagina);
+            
+            // Si el Storage no lo aceptó no se sigue con las otras páginas (la Query termina con error)
+            if (enviar_op_simple_storage(socket_storage, socket_master, WRITE, op_write) != OP_OK) return;
+
+            // La página ya está en el Storage: lo que siga se queda en memoria
+            if (worker_configs.escrituradiferida) {
+                buscar_file_tag(file, tag)->escritura_validada = epoca_escrituras;
+                bit_sacar(bits_modificado, marco);
+                diferir = true;
+            }
+        }
 
         // 7. Avanzar punteros
         bytes_escritos += bytes_a_escribir_ahora;
@@ -274,10 +402,56 @@ void escribir_en_memoria(int query_id, const char* file, const char* tag, int di
     }
 }
 
+// true si ninguna página de [direccion_logica, direccion_logica + tamanio) está en memoria
+static bool rango_fuera_de_memoria(const char* file, const char* tag, int direccion_logica, int tamanio) {
+    int ultima_pagina = (direccion_logica + (tamanio > 0 ? tamanio : 1) - 1) / tam_pagina;
+    for (int num_pagina = direccion_logica / tam_pagina; num_pagina <= ultima_pagina; num_pagina++) {
+        if (buscar_pagina_en_memoria(file, tag, num_pagina) != -1) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief LECTURA_DIRECTA: pide al Storage solo los bytes del rango (en un único READ, aunque
+ * cruce bloques) sin ocupar marcos. Solo se usa si nada del rango está en memoria, así nunca
+ * se saltea una página modificada que todavía no llegó al Storage.
+ */
+static char* leer_directo_de_storage(int query_id, const char* file, const char* tag, int direccion_logica, int tamanio, int socket_storage, int socket_master) {
+    log_info(logger_worker, "## Query %d: (READ) Lectura directa - File: %s - Tag: %s - Dirección: %d - Tamaño: %d",
+             query_id, file, tag, direccion_logica, tamanio);
+
+    t_op_storage* op_read_req = calloc(1, sizeof(t_op_storage));
+    op_read_req->query_id = query_id;
+    op_read_req->nombre_file = strdup(file);
+    op_read_req->nombre_tag  = strdup(tag);
+    op_read_req->direccion_base = direccion_logica / tam_pagina;
+    op_read_req->desplazamiento = direccion_logica % tam_pagina;
+    op_read_req->tamano = tamanio;
+
+    char* contenido = enviar_op_read_storage(socket_storage, socket_master, op_read_req);
+    if (contenido == NULL) {
+        log_error(logger_worker, "## Query %d: (READ) Lectura directa falló. Storage no devolvió datos.", query_id);
+        return NULL;
+    }
+
+    char* valor_leido = malloc(tamanio + 1);
+    memcpy(valor_leido, contenido, tamanio);
+    valor_leido[tamanio] = '\0';
+    free(contenido);
+
+    log_info(logger_worker, "## Query %d: Acción: LEER - Lectura directa - Valor: %s", query_id, valor_leido);
+    return valor_leido;
+}
+
 char* leer_de_memoria(int query_id, const char* file, const char* tag, int direccion_logica, int tamanio, int socket_storage, int socket_master) {
     int num_pagina = direccion_logica / tam_pagina;
     int offset = direccion_logica % tam_pagina;
 
+    // 0. Con LECTURA_DIRECTA, si no hay nada del rango en memoria no se cargan páginas
+    if (worker_configs.lecturadirecta && tamanio > 0 && rango_fuera_de_memoria(file, tag, direccion_logica, tamanio)) {
+        return leer_directo_de_storage(query_id, file, tag, direccion_logica, tamanio, socket_storage, socket_master);
+    }
+
     // 1. Buscar si la página ya está en memoria
     int marco = buscar_pagina_en_memoria(file, tag, num_pagina);
 
@@ -289,6 +463,7 @@ char* leer_de_memoria(int query_id, const char* file, const char* tag, int direc
         marco = obtener_marco_libre();
         if (marco == -1) { // No hay marcos libres, hay que reemplazar
              marco = reemplazar_pagina(query_id, socket_storage, socket_master, file, tag, num_pagina);
+             if (marco == -1) return NULL; // No se pudo mandar la víctima al Storage
         }
 
         // 2. Pedir el bloque al Storage
@@ -304,6 +479,7 @@ char* leer_de_memoria(int query_id, const char* file, const char* tag, int direc
 
         if (contenido_bloque == NULL) {
             log_error(logger_worker, "## Query %d: (READ) Page Fault falló. Storage no devolvió datos.", query_id);
+            devolver_marco_libre(marco);
             return NULL;
         }
 
@@ -314,26 +490,16 @@ char* leer_de_memoria(int query_id, const char* file, const char* tag, int direc
         log_info(logger_worker, "## Query %d: Memoria Add - File: %s - Tag: %s Pagina: %d Marco: %d",
                  query_id, file, tag, num_pagina, marco);
 
-        // 4. Actualizar flags de la nueva página
-        PaginaMemoria* pagina_info = &tabla_de_marcos[marco];
-        pagina_info->ocupado = true;
-        pagina_info->modificado = false; // Acaba de ser cargada
-        pagina_info->usado = true;       // Se va a usar
-        //pagina_info->timestamp = (unsigned long long)time(NULL); // Para LRU
-        pagina_info->timestamp = ++contador_lru;
-        pagina_info->num_pagina = num_pagina;
-        strncpy(pagina_info->file, file, MAX_FILETAG - 1);
-        strncpy(pagina_info->tag, tag, MAX_FILETAG - 1);
+        // 4. Actualizar flags de la nueva página (usada y sin modificar: acaba de ser cargada)
+        ocupar_marco(marco, file, tag, num_pagina);
+        bit_sacar(bits_modificado, marco);
     
     } else {
          log_info(logger_worker, "## Query %d: (READ) Memoria Hit - File: %s - Tag: %s Pagina: %d Marco: %d",
                  query_id, file, tag, num_pagina, marco);
         
          // Actualizar flags de la página existente
-         PaginaMemoria* pagina_info = &tabla_de_marcos[marco];
-         pagina_info->usado = true;
-         //pagina_info->timestamp = (unsigned long long)time(NULL); // Actualizar para LRU
-         pagina_info->timestamp = ++contador_lru;
+         algoritmo->al_acceder(marco);
     }
 
     // 5. Leer de la memoria (ahora sí está)
@@ -352,34 +518,115 @@ char* leer_de_memoria(int query_id, const char* file, const char* tag, int direc
 }
 
 // 1. Nueva función auxiliar para hacer FLUSH de páginas 
-void realizar_flush_file(int query_id, const char* file, const char* tag, int socket_storage, int socket_master) {
+bool realizar_flush_file(int query_id, const char* file, const char* tag, int socket_storage, int socket_master) {
+    // Si file/tag son NULL, flushea TODO (útil para desalojo)
+    // Si tienen valor, solo flushea las páginas de ese archivo (útil para COMMIT)
+    int id_file_tag = -1;
+    if (file != NULL || tag != NULL) {
+        t_file_tag* file_tag = buscar_file_tag(file, tag);
+        if (file_tag == NULL) return true; // Sin páginas en memoria
+        id_file_tag = file_tag->id;
+    }
+
     for (int i = 0; i < cantidad_marcos; i++) {
-        // Si file/tag son NULL, flushea TODO (útil para desalojo)
-        // Si tienen valor, solo flushea las páginas de ese archivo (útil para COMMIT)
-        bool es_el_archivo = (file == NULL && tag == NULL) || 
-                             (tabla_de_marcos[i].ocupado && 
-                              strcmp(tabla_de_marcos[i].file, file) == 0 && 
-                              strcmp(tabla_de_marcos[i].tag, tag) == 0);
-
-        if (es_el_archivo && tabla_de_marcos[i].modificado) {
+        bool es_el_archivo = id_file_tag == -1 || marco_file_tag[i] == id_file_tag;
+
+        if (es_el_archivo && bit_leer(bits_modificado, i)) {
+            t_file_tag* dueno = file_tags[marco_file_tag[i]];
             log_info(logger_worker, "## Query %d: FLUSH Implícito Marco %d (File: %s Pagina: %d)", 
-                     query_id, i, tabla_de_marcos[i].file, tabla_de_marcos[i].num_pagina);
+                     query_id, i, dueno->file, marco_pagina[i]);
             
             t_op_storage* op_flush = calloc(1, sizeof(t_op_storage));
             op_flush->query_id = query_id;
-            op_flush->nombre_file = strdup(tabla_de_marcos[i].file);
-            op_flush->nombre_tag = strdup(tabla_de_marcos[i].tag);
-            op_flush->direccion_base = tabla_de_marcos[i].num_pagina;
+            op_flush->nombre_file = strdup(dueno->file);
+            op_flush->nombre_tag = strdup(dueno->tag);
+            op_flush->direccion_base = marco_pagina[i];
             
             // bin
             op_flush->tamano_contenido = tam_pagina; // Escribimos toda la página
             op_flush->contenido = malloc(tam_pagina);
             memcpy(op_flush->contenido, memoria_principal + (i * tam_pagina), tam_pagina);
 
-            enviar_op_simple_storage(socket_storage, socket_master, WRITE, op_flush);
+            // Con la primera que falla se corta: las demás siguen modificadas
+            if (enviar_op_simple_storage(socket_storage, socket_master, WRITE, op_flush) != OP_OK) {
+                log_error(logger_worker, "## Query %d: FLUSH interrumpido en el Marco %d", query_id, i);
+                return false;
+            }
             
             // Marcamos como limpio
-            tabla_de_marcos[i].modificado = false; 
+            bit_sacar(bits_modificado, i); 
+        }
+    }
+    return true;
+}
+
+// Saca la página del marco de memoria sin mandarla al Storage (el marco vuelve a la lista de libres)
+static void descartar_marco(int marco) {
+    algoritmo->al_descartar(marco);
+    tabla_paginas_quitar(marco);
+    bit_sacar(bits_ocupado, marco);
+    bit_sacar(bits_modificado, marco);
+    marco_file_tag[marco] = -1;
+    marco_pagina[marco] = -1;
+    devolver_marco_libre(marco);
+}
+
+// Descarta las páginas del File:Tag desde primera_pagina (con la última página se libera file_tag)
+static int descartar_paginas_desde(t_file_tag* file_tag, int primera_pagina) {
+    int descartadas = 0;
+    int capacidad = file_tag->paginas.capacidad;
+    int* marcos = file_tag->paginas.marcos;
+    for (int num_pagina = primera_pagina; num_pagina < capacidad; num_pagina++) {
+        int marco = marcos[num_pagina];
+        if (marco == -1) continue;
+
+        bool ultima = file_tag->paginas.cargadas == 1;
+        descartar_marco(marco);
+        descartadas++;
+        if (ultima) break;
+    }
+    return descartadas;
+}
+
+void descartar_paginas_file(int query_id, const char* file, const char* tag) {
+    t_file_tag* file_tag = buscar_file_tag(file, tag);
+    if (file_tag == NULL) return; // Sin páginas en memoria
+
+    log_info(logger_worker, "## Query %d: Se descartan de memoria las %d páginas de %s:%s",
+             query_id, file_tag->paginas.cargadas, file, tag);
+    descartar_paginas_desde(file_tag, 0);
+}
+
+void descartar_paginas_fuera_de_tamanio(int query_id, const char* file, const char* tag, int tamanio) {
+    t_file_tag* file_tag = buscar_file_tag(file, tag);
+    if (file_tag == NULL) return;
+
+    int primera_pagina = (tamanio + tam_pagina - 1) / tam_pagina;
+    int descartadas = descartar_paginas_desde(file_tag, primera_pagina);
+    if (descartadas > 0) {
+        log_info(logger_worker, "## Query %d: Se descartan de memoria %d páginas de %s:%s desde la %d (TRUNCATE)",
+                 query_id, descartadas, file, tag, primera_pagina);
+    }
+}
+
+void olvidar_escrituras_validadas(const char* file, const char* tag) {
+    if (file == NULL) {
+        epoca_escrituras++;
+        return;
+    }
+    t_file_tag* file_tag = buscar_file_tag(file, tag);
+    if (file_tag != NULL) file_tag->escritura_validada = 0;
+}
+
+void descartar_paginas_modificadas(int query_id) {
+    int descartadas = 0;
+    for (int marco = 0; marco < cantidad_marcos; marco++) {
+        if (bit_leer(bits_ocupado, marco) && bit_leer(bits_modificado, marco)) {
+            descartar_marco(marco);
+            descartadas++;
         }
     }
+    if (descartadas > 0) {
+        log_info(logger_worker, "## Query %d: Se descartan de memoria %d páginas modificadas", query_id, descartadas);
+    }
 }
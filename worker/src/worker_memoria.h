@@ -4,19 +4,38 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <utils/serializacion.h>
+#include <commons/collections/dictionary.h>
 
 #define MAX_FILETAG 128
 
+/**
+ * @struct t_tabla_paginas
+ * @brief Tabla de páginas de un File:Tag: marcos[num_pagina] es el marco de esa página (-1 = no está)
+ *
+ * @param capacidad Páginas que entran en marcos (crece al cargar una página más alta)
+ * @param cargadas Páginas del File:Tag en memoria (sin ninguna se borra la tabla)
+ */
 typedef struct {
-    bool ocupado;
-    bool modificado;
-    bool usado;
-    unsigned long long timestamp; // Para LRU
-    char file[MAX_FILETAG];
-    char tag[MAX_FILETAG];
-    int num_pagina;
-    bool bit_clock; // Para CLOCK-M
-} PaginaMemoria;
+    int* marcos;
+    int capacidad;
+    int cargadas;
+} t_tabla_paginas;
+
+/**
+ * @struct t_file_tag
+ * @brief File:Tag con páginas en memoria, internado a un ID chico (lo que guardan los marcos)
+ *
+ * El ID se libera cuando la última página del File:Tag sale de memoria.
+ *
+ * @param escritura_validada Con ESCRITURA_DIFERIDA, época en la que el Storage aceptó un WRITE de la Query actual
+ */
+typedef struct {
+    int id;
+    char* file;
+    char* tag;
+    t_tabla_paginas paginas;
+    uint32_t escritura_validada;
+} t_file_tag;
 
 void inicializar_memoria(int tam_memoria, int tam_pagina);
 void liberar_memoria();
@@ -24,6 +43,31 @@ void liberar_memoria();
 // Funciones principales de acceso
 void escribir_en_memoria(int query_id, const char* file, const char* tag, int direccion_logica, const char* contenido, int socket_storage, int socket_master);
 char* leer_de_memoria(int query_id, const char* file, const char* tag, int direccion_logica, int tamanio, int socket_storage, int socket_master);
-void realizar_flush_file(int query_id, const char* file, const char* tag, int socket_storage, int socket_master);
+/**
+ * @brief Manda al Storage las páginas modificadas del File:Tag (todas si file y tag son NULL).
+ * @return false si el Storage rechazó una (se corta ahí y las que faltan siguen modificadas).
+ */
+bool realizar_flush_file(int query_id, const char* file, const char* tag, int socket_storage, int socket_master);
+
+/**
+ * @brief Saca de memoria las páginas del File:Tag sin mandarlas al Storage (después de un DELETE).
+ */
+void descartar_paginas_file(int query_id, const char* file, const char* tag);
+
+/**
+ * @brief Saca de memoria las páginas del File:Tag que quedaron afuera de tamanio bytes (después de un TRUNCATE).
+ */
+void descartar_paginas_fuera_de_tamanio(int query_id, const char* file, const char* tag, int tamanio);
+
+/**
+ * @brief Con ESCRITURA_DIFERIDA, el próximo WRITE al File:Tag (a todos si file es NULL) vuelve a ir al
+ * Storage antes de quedarse en memoria. Al empezar una Query y después de un COMMIT.
+ */
+void olvidar_escrituras_validadas(const char* file, const char* tag);
+
+/**
+ * @brief Saca de memoria las páginas modificadas sin mandarlas al Storage (la Query terminó con error o se desconectó).
+ */
+void descartar_paginas_modificadas(int query_id);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,767 @@
+#include "worker_reemplazo.h"
+#include "worker-log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// --- Estado común: listas intrusivas sobre los marcos (cada marco está en a lo sumo una) ---
+
+/**
+ * @struct t_lista_marcos
+ * @brief Lista doblemente enlazada de marcos (enlaces en anterior/siguiente), del más viejo al más nuevo
+ */
+typedef struct {
+    int primero;
+    int ultimo;
+    int cantidad;
+} t_lista_marcos;
+
+static int cantidad_marcos;
+static int* anterior;
+static int* siguiente;
+static uint8_t* lista_de_marco;   // En qué lista del algoritmo está cada marco (0 = ninguna)
+static uint64_t* clave_de_marco;  // Clave de la página cargada en cada marco
+
+static void inicializar_marcos(int marcos) {
+    cantidad_marcos = marcos;
+    anterior = malloc(marcos * sizeof(int));
+    siguiente = malloc(marcos * sizeof(int));
+    lista_de_marco = calloc(marcos, sizeof(uint8_t));
+    clave_de_marco = calloc(marcos, sizeof(uint64_t));
+    for (int i = 0; i < marcos; i++) anterior[i] = siguiente[i] = -1;
+}
+
+static void destruir_marcos() {
+    free(anterior);
+    free(siguiente);
+    free(lista_de_marco);
+    free(clave_de_marco);
+}
+
+static void lista_vaciar(t_lista_marcos* lista) {
+    lista->primero = lista->ultimo = -1;
+    lista->cantidad = 0;
+}
+
+static void lista_agregar_al_final(t_lista_marcos* lista, int marco) {
+    anterior[marco] = lista->ultimo;
+    siguiente[marco] = -1;
+    if (lista->ultimo != -1) siguiente[lista->ultimo] = marco;
+    else lista->primero = marco;
+    lista->ultimo = marco;
+    lista->cantidad++;
+}
+
+static void lista_sacar(t_lista_marcos* lista, int marco) {
+    if (anterior[marco] != -1) siguiente[anterior[marco]] = siguiente[marco];
+    else lista->primero = siguiente[marco];
+    if (siguiente[marco] != -1) anterior[siguiente[marco]] = anterior[marco];
+    else lista->ultimo = anterior[marco];
+    anterior[marco] = siguiente[marco] = -1;
+    lista->cantidad--;
+}
+
+// --- Índice clave -> entero (hash abierto con sondeo lineal) ---
+
+/**
+ * @struct t_indice_claves
+ * @brief Tabla hash de claves de página a enteros (valor -1 = posición vacía)
+ */
+typedef struct {
+    uint64_t* claves;
+    int* valores;
+    int mascara;
+} t_indice_claves;
+
+static uint64_t mezclar_clave(uint64_t clave) {
+    clave ^= clave >> 33;
+    clave *= 0xff51afd7ed558ccdULL;
+    clave ^= clave >> 33;
+    return clave;
+}
+
+// Lugar para al menos 2 * elementos (potencia de 2)
+static void indice_crear(t_indice_claves* indice, int elementos) {
+    int capacidad = 16;
+    while (capacidad < 2 * elementos) capacidad *= 2;
+    indice->claves = malloc(capacidad * sizeof(uint64_t));
+    indice->valores = malloc(capacidad * sizeof(int));
+    indice->mascara = capacidad - 1;
+    for (int i = 0; i < capacidad; i++) indice->valores[i] = -1;
+}
+
+static void indice_destruir(t_indice_claves* indice) {
+    free(indice->claves);
+    free(indice->valores);
+}
+
+static int indice_posicion(t_indice_claves* indice, uint64_t clave) {
+    int posicion = mezclar_clave(clave) & indice->mascara;
+    while (indice->valores[posicion] != -1 && indice->claves[posicion] != clave) {
+        posicion = (posicion + 1) & indice->mascara;
+    }
+    return posicion;
+}
+
+static int indice_buscar(t_indice_claves* indice, uint64_t clave) {
+    return indice->valores[indice_posicion(indice, clave)];
+}
+
+static void indice_poner(t_indice_claves* indice, uint64_t clave, int valor) {
+    int posicion = indice_posicion(indice, clave);
+    indice->claves[posicion] = clave;
+    indice->valores[posicion] = valor;
+}
+
+// Borrado con corrimiento hacia atrás (sin marcas de borrado)
+static void indice_sacar(t_indice_claves* indice, uint64_t clave) {
+    int hueco = indice_posicion(indice, clave);
+    if (indice->valores[hueco] == -1) return;
+    indice->valores[hueco] = -1;
+
+    int posicion = hueco;
+    while (1) {
+        posicion = (posicion + 1) & indice->mascara;
+        if (indice->valores[posicion] == -1) return;
+        int inicial = mezclar_clave(indice->claves[posicion]) & indice->mascara;
+        // Se queda si su posición inicial está entre el hueco (excluido) y donde está
+        bool se_queda = hueco <= posicion ? (inicial > hueco && inicial <= posicion)
+                                          : (inicial > hueco || inicial <= posicion);
+        if (!se_queda) {
+            indice->claves[hueco] = indice->claves[posicion];
+            indice->valores[hueco] = indice->valores[posicion];
+            indice->valores[posicion] = -1;
+            hueco = posicion;
+        }
+    }
+}
+
+// --- Historial: claves de páginas que ya salieron de memoria, del más viejo al más nuevo ---
+
+/**
+ * @struct t_historial
+ * @brief Lista acotada de claves (páginas fantasma) con su índice; llena, pierde la más vieja
+ */
+typedef struct {
+    int capacidad;
+    int cantidad;
+    int primero;
+    int ultimo;
+    uint64_t* claves;
+    int* anterior;
+    int* siguiente;
+    int* libres;
+    int cantidad_libres;
+    t_indice_claves indice;
+} t_historial;
+
+static void historial_crear(t_historial* historial, int capacidad) {
+    historial->capacidad = capacidad > 0 ? capacidad : 1;
+    historial->cantidad = 0;
+    historial->primero = historial->ultimo = -1;
+    historial->claves = malloc(historial->capacidad * sizeof(uint64_t));
+    historial->anterior = malloc(historial->capacidad * sizeof(int));
+    historial->siguiente = malloc(historial->capacidad * sizeof(int));
+    historial->libres = malloc(historial->capacidad * sizeof(int));
+    historial->cantidad_libres = historial->capacidad;
+    for (int i = 0; i < historial->capacidad; i++) historial->libres[i] = historial->capacidad - 1 - i;
+    indice_crear(&historial->indice, historial->capacidad);
+}
+
+static void historial_destruir(t_historial* historial) {
+    free(historial->claves);
+    free(historial->anterior);
+    free(historial->siguiente);
+    free(historial->libres);
+    indice_destruir(&historial->indice);
+}
+
+static bool historial_contiene(t_historial* historial, uint64_t clave) {
+    return indice_buscar(&historial->indice, clave) != -1;
+}
+
+static void historial_sacar_nodo(t_historial* historial, int nodo) {
+    if (historial->anterior[nodo] != -1) historial->siguiente[historial->anterior[nodo]] = historial->siguiente[nodo];
+    else historial->primero = historial->siguiente[nodo];
+    if (historial->siguiente[nodo] != -1) historial->anterior[historial->siguiente[nodo]] = historial->anterior[nodo];
+    else historial->ultimo = historial->anterior[nodo];
+    indice_sacar(&historial->indice, historial->claves[nodo]);
+    historial->libres[historial->cantidad_libres++] = nodo;
+    historial->cantidad--;
+}
+
+// Saca la clave si está; devuelve si estaba
+static bool historial_sacar(t_historial* historial, uint64_t clave) {
+    int nodo = indice_buscar(&historial->indice, clave);
+    if (nodo == -1) return false;
+    historial_sacar_nodo(historial, nodo);
+    return true;
+}
+
+static void historial_sacar_mas_viejo(t_historial* historial) {
+    if (historial->primero != -1) historial_sacar_nodo(historial, historial->primero);
+}
+
+static void historial_agregar(t_historial* historial, uint64_t clave) {
+    historial_sacar(historial, clave);
+    if (historial->cantidad == historial->capacidad) historial_sacar_mas_viejo(historial);
+
+    int nodo = historial->libres[--historial->cantidad_libres];
+    historial->claves[nodo] = clave;
+    historial->anterior[nodo] = historial->ultimo;
+    historial->siguiente[nodo] = -1;
+    if (historial->ultimo != -1) historial->siguiente[historial->ultimo] = nodo;
+    else historial->primero = nodo;
+    historial->ultimo = nodo;
+    historial->cantidad++;
+    indice_poner(&historial->indice, clave, nodo);
+}
+
+// ============================== LRU ==============================
+// La víctima es la primera de la lista de recencia (se mueve al final en cada acceso)
+
+static t_lista_marcos recencia;
+static unsigned long long* timestamp;
+static unsigned long long contador_lru;
+
+static void lru_inicializar(int marcos, const uint64_t* bits_modificado) {
+    inicializar_marcos(marcos);
+    lista_vaciar(&recencia);
+    timestamp = calloc(marcos, sizeof(unsigned long long));
+    contador_lru = 0;
+}
+
+static void lru_destruir() {
+    destruir_marcos();
+    free(timestamp);
+}
+
+static void lru_al_acceder(int marco) {
+    timestamp[marco] = ++contador_lru;
+    lista_sacar(&recencia, marco);
+    lista_agregar_al_final(&recencia, marco);
+}
+
+static void lru_al_cargar(int marco, uint64_t clave) {
+    timestamp[marco] = ++contador_lru;
+    lista_agregar_al_final(&recencia, marco);
+}
+
+static int lru_elegir_victima(uint64_t clave_nueva) {
+    int marco_victima = recencia.primero;
+    log_info(logger_worker, "## LRU Marco víctima: %d (timestamp más antiguo: %llu)",
+             marco_victima, marco_victima != -1 ? timestamp[marco_victima] : 0);
+    return marco_victima;
+}
+
+static void lru_al_desalojar(int marco) {
+    lista_sacar(&recencia, marco);
+}
+
+// ============================== CLOCK-M ==============================
+// 4 pasadas sobre bitsets de 64 marcos por palabra: (U=0, M=0), después (U=0, M=1) bajando U
+
+static uint64_t* bits_usado;
+static uint64_t* bits_presente;
+static const uint64_t* bits_modificado_memoria;
+static int puntero_clock;
+
+static void clock_m_inicializar(int marcos, const uint64_t* bits_modificado) {
+    cantidad_marcos = marcos;
+    int palabras = (marcos + 63) / 64;
+    bits_usado = calloc(palabras, sizeof(uint64_t));
+    bits_presente = calloc(palabras, sizeof(uint64_t));
+    bits_modificado_memoria = bits_modificado;
+    puntero_clock = 0;
+}
+
+static void clock_m_destruir() {
+    free(bits_usado);
+    free(bits_presente);
+}
+
+static void clock_m_al_acceder(int marco) {
+    bits_usado[marco / 64] |= (uint64_t) 1 << (marco % 64);
+}
+
+static void clock_m_al_cargar(int marco, uint64_t clave) {
+    bits_usado[marco / 64] |= (uint64_t) 1 << (marco % 64);
+    bits_presente[marco / 64] |= (uint64_t) 1 << (marco % 64);
+}
+
+static void clock_m_al_desalojar(int marco) {
+    bits_usado[marco / 64] &= ~((uint64_t) 1 << (marco % 64));
+    bits_presente[marco / 64] &= ~((uint64_t) 1 << (marco % 64));
+}
+
+// Marcos de [desde, hasta) dentro de la palabra (la última palabra puede estar incompleta)
+static inline uint64_t mascara_rango(int palabra, int desde, int hasta) {
+    int marcos_en_palabra = cantidad_marcos - palabra * 64;
+    uint64_t mascara = marcos_en_palabra >= 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << marcos_en_palabra) - 1;
+    if (desde > palabra * 64) mascara &= ~(uint64_t) 0 << (desde - palabra * 64);
+    if (hasta < (palabra + 1) * 64) mascara &= ((uint64_t) 1 << (hasta - palabra * 64)) - 1;
+    return mascara;
+}
+
+/**
+ * @brief Primer marco de [desde, hasta) libre o con U=0 y M igual a modificados. Los candidatos
+ * de cada palabra salen de los bitsets y el primero con ctz.
+ * @return El marco, o -1 si no hay.
+ */
+static int primer_candidato_clock(int desde, int hasta, bool modificados) {
+    if (desde >= hasta) return -1;
+    for (int palabra = desde / 64; palabra * 64 < hasta; palabra++) {
+        uint64_t bits_m = modificados ? bits_modificado_memoria[palabra] : ~bits_modificado_memoria[palabra];
+        uint64_t candidatos = (~bits_presente[palabra] | (~bits_usado[palabra] & bits_m))
+                              & mascara_rango(palabra, desde, hasta);
+        if (candidatos != 0) {
+            return palabra * 64 + __builtin_ctzll(candidatos);
+        }
+    }
+    return -1;
+}
+
+// Baja el bit de uso de los marcos de [desde, hasta), una palabra por vez
+static void bajar_bits_usado(int desde, int hasta) {
+    if (desde >= hasta) return;
+    for (int palabra = desde / 64; palabra * 64 < hasta; palabra++) {
+        bits_usado[palabra] &= ~mascara_rango(palabra, desde, hasta);
+    }
+}
+
+static int clock_m_elegir_victima(uint64_t clave_nueva) {
+    // CLOCK-M: Algoritmo de 4 pasos
+    // Paso 1: Buscar (U=0, M=0). No tocar nada.
+    // Paso 2: Buscar (U=0, M=1). Poner U=0 a los que pasemos.
+    int marco_victima = -1;
+    int start_pointer = puntero_clock;
+
+    for (int pasos = 0; pasos < 4 && marco_victima == -1; pasos++) {
+        // Pasos 1 y 3 buscan U=0, M=0; pasos 2 y 4 buscan U=0, M=1 (un marco libre sirve siempre)
+        bool buscar_modificados = (pasos == 1 || pasos == 3);
+
+        // Desde el puntero hasta el final y, si no hay, desde el principio hasta el puntero
+        marco_victima = primer_candidato_clock(start_pointer, cantidad_marcos, buscar_modificados);
+        if (marco_victima == -1) {
+            marco_victima = primer_candidato_clock(0, start_pointer, buscar_modificados);
+        }
+
+        // Efecto colateral del paso 2 (y 4): bajar bandera de uso a los que pasamos
+        if (buscar_modificados) {
+            if (marco_victima == -1) {
+                bajar_bits_usado(0, cantidad_marcos);
+            } else if (marco_victima >= start_pointer) {
+                bajar_bits_usado(start_pointer, marco_victima);
+            } else {
+                bajar_bits_usado(start_pointer, cantidad_marcos);
+                bajar_bits_usado(0, marco_victima);
+            }
+        }
+    }
+
+    if (marco_victima != -1) {
+        puntero_clock = (marco_victima + 1) % cantidad_marcos; // Avanzar puntero para la proxima
+    }
+    log_info(logger_worker, "## CLOCK-M Marco víctima: %d", marco_victima);
+    return marco_victima;
+}
+
+// ============================== ARC ==============================
+// T1 (vistas una vez) y T2 (vistas más de una vez) en memoria; B1 y B2 recuerdan lo que salió
+// de cada una. Un fault sobre B1 agranda el objetivo p de T1 y uno sobre B2 lo achica.
+
+#define ARC_T1 1
+#define ARC_T2 2
+
+static t_lista_marcos arc_t1;
+static t_lista_marcos arc_t2;
+static t_historial arc_b1;
+static t_historial arc_b2;
+static int arc_p;
+// Página que vuelve de B1/B2 y cuyo fantasma ya se sacó al elegir la víctima (la carga la pasa a T2)
+static uint64_t arc_clave_que_vuelve;
+static bool arc_hay_clave_que_vuelve;
+
+static void arc_inicializar(int marcos, const uint64_t* bits_modificado) {
+    inicializar_marcos(marcos);
+    lista_vaciar(&arc_t1);
+    lista_vaciar(&arc_t2);
+    historial_crear(&arc_b1, marcos);
+    historial_crear(&arc_b2, 2 * marcos);
+    arc_p = 0;
+    arc_hay_clave_que_vuelve = false;
+}
+
+static void arc_destruir() {
+    destruir_marcos();
+    historial_destruir(&arc_b1);
+    historial_destruir(&arc_b2);
+}
+
+static void arc_al_acceder(int marco) {
+    lista_sacar(lista_de_marco[marco] == ARC_T1 ? &arc_t1 : &arc_t2, marco);
+    lista_agregar_al_final(&arc_t2, marco);
+    lista_de_marco[marco] = ARC_T2;
+}
+
+static void arc_al_cargar(int marco, uint64_t clave) {
+    clave_de_marco[marco] = clave;
+
+    // Vuelve una página que ya había salido: pasa directo a T2
+    bool vuelve = arc_hay_clave_que_vuelve && arc_clave_que_vuelve == clave;
+    arc_hay_clave_que_vuelve = false;
+    if (vuelve || historial_sacar(&arc_b1, clave) || historial_sacar(&arc_b2, clave)) {
+        lista_agregar_al_final(&arc_t2, marco);
+        lista_de_marco[marco] = ARC_T2;
+        return;
+    }
+
+    lista_agregar_al_final(&arc_t1, marco);
+    lista_de_marco[marco] = ARC_T1;
+
+    // El directorio se mantiene en |T1| + |B1| <= c y |T1| + |T2| + |B1| + |B2| <= 2c
+    while (arc_t1.cantidad + arc_b1.cantidad > cantidad_marcos && arc_b1.cantidad > 0) {
+        historial_sacar_mas_viejo(&arc_b1);
+    }
+    while (arc_t1.cantidad + arc_t2.cantidad + arc_b1.cantidad + arc_b2.cantidad > 2 * cantidad_marcos && arc_b2.cantidad > 0) {
+        historial_sacar_mas_viejo(&arc_b2);
+    }
+}
+
+static int arc_elegir_victima(uint64_t clave_nueva) {
+    bool en_b1 = historial_contiene(&arc_b1, clave_nueva);
+    bool en_b2 = historial_contiene(&arc_b2, clave_nueva);
+
+    // Adaptación: la página que vuelve dice qué lista se quedó corta
+    if (en_b1) {
+        int delta = arc_b2.cantidad > arc_b1.cantidad ? arc_b2.cantidad / arc_b1.cantidad : 1;
+        arc_p = arc_p + delta < cantidad_marcos ? arc_p + delta : cantidad_marcos;
+    } else if (en_b2) {
+        int delta = arc_b1.cantidad > arc_b2.cantidad ? arc_b1.cantidad / arc_b2.cantidad : 1;
+        arc_p = arc_p - delta > 0 ? arc_p - delta : 0;
+    }
+
+    // Su fantasma sale antes de que entre el de la víctima: con B1 o B2 llenos, historial_agregar
+    // podría descartarlo por ser el más viejo y la página entraría a T1 como si fuera nueva
+    arc_hay_clave_que_vuelve = en_b1 || en_b2;
+    if (arc_hay_clave_que_vuelve) {
+        arc_clave_que_vuelve = clave_nueva;
+        historial_sacar(en_b1 ? &arc_b1 : &arc_b2, clave_nueva);
+    }
+
+    // REPLACE: sale de T1 si está por encima de su objetivo, si no de T2
+    bool desde_t1 = arc_t1.cantidad > 0 &&
+                    (arc_t1.cantidad > arc_p || (en_b2 && arc_t1.cantidad == arc_p) || arc_t2.cantidad == 0);
+    int marco_victima = desde_t1 ? arc_t1.primero : arc_t2.primero;
+
+    log_info(logger_worker, "## ARC Marco víctima: %d (de %s, |T1|=%d |T2|=%d p=%d)",
+             marco_victima, desde_t1 ? "T1" : "T2", arc_t1.cantidad, arc_t2.cantidad, arc_p);
+    return marco_victima;
+}
+
+static void arc_al_desalojar(int marco) {
+    if (lista_de_marco[marco] == ARC_T1) {
+        lista_sacar(&arc_t1, marco);
+        historial_agregar(&arc_b1, clave_de_marco[marco]);
+    } else {
+        lista_sacar(&arc_t2, marco);
+        historial_agregar(&arc_b2, clave_de_marco[marco]);
+    }
+    lista_de_marco[marco] = 0;
+}
+
+static void arc_al_descartar(int marco) {
+    lista_sacar(lista_de_marco[marco] == ARC_T1 ? &arc_t1 : &arc_t2, marco);
+    lista_de_marco[marco] = 0;
+}
+
+// ============================== 2Q ==============================
+// A1in: FIFO de páginas nuevas (un recorrido secuencial no pasa de acá); Am: LRU de las que
+// se volvieron a pedir después de salir de A1in (las recuerda A1out)
+
+#define Q2_A1IN 1
+#define Q2_AM 2
+
+static t_lista_marcos q2_a1in;
+static t_lista_marcos q2_am;
+static t_historial q2_a1out;
+static int q2_kin;
+
+static void q2_inicializar(int marcos, const uint64_t* bits_modificado) {
+    inicializar_marcos(marcos);
+    lista_vaciar(&q2_a1in);
+    lista_vaciar(&q2_am);
+    // Los tamaños que recomiendan Johnson y Shasha: Kin = 25% de la memoria, Kout = 50%
+    q2_kin = marcos / 4 > 0 ? marcos / 4 : 1;
+    historial_crear(&q2_a1out, marcos / 2);
+}
+
+static void q2_destruir() {
+    destruir_marcos();
+    historial_destruir(&q2_a1out);
+}
+
+static void q2_al_acceder(int marco) {
+    // En A1in no se mueve: los accesos seguidos a una página nueva cuentan como uno
+    if (lista_de_marco[marco] == Q2_AM) {
+        lista_sacar(&q2_am, marco);
+        lista_agregar_al_final(&q2_am, marco);
+    }
+}
+
+static void q2_al_cargar(int marco, uint64_t clave) {
+    clave_de_marco[marco] = clave;
+    if (historial_sacar(&q2_a1out, clave)) {
+        lista_agregar_al_final(&q2_am, marco);
+        lista_de_marco[marco] = Q2_AM;
+    } else {
+        lista_agregar_al_final(&q2_a1in, marco);
+        lista_de_marco[marco] = Q2_A1IN;
+    }
+}
+
+static int q2_elegir_victima(uint64_t clave_nueva) {
+    bool desde_a1in = q2_a1in.cantidad > q2_kin || q2_am.cantidad == 0;
+    int marco_victima = desde_a1in ? q2_a1in.primero : q2_am.primero;
+    log_info(logger_worker, "## 2Q Marco víctima: %d (de %s, |A1in|=%d |Am|=%d)",
+             marco_victima, desde_a1in ? "A1in" : "Am", q2_a1in.cantidad, q2_am.cantidad);
+    return marco_victima;
+}
+
+static void q2_al_desalojar(int marco) {
+    if (lista_de_marco[marco] == Q2_A1IN) {
+        lista_sacar(&q2_a1in, marco);
+        historial_agregar(&q2_a1out, clave_de_marco[marco]);
+    } else {
+        lista_sacar(&q2_am, marco);
+    }
+    lista_de_marco[marco] = 0;
+}
+
+static void q2_al_descartar(int marco) {
+    lista_sacar(lista_de_marco[marco] == Q2_A1IN ? &q2_a1in : &q2_am, marco);
+    lista_de_marco[marco] = 0;
+}
+
+// ============================== CLOCK-PRO ==============================
+// Un reloj con páginas calientes, frías y frías ya desalojadas que siguen en período de
+// prueba. Una página fría que se vuelve a pedir durante su prueba pasa a caliente; el objetivo
+// de páginas frías crece cuando eso pasa y se achica cuando una prueba termina sin uso.
+// Tres manecillas: la fría elige víctimas, la caliente enfría y la de prueba poda el historial.
+
+/**
+ * @struct t_nodo_clock_pro
+ * @brief Página en el reloj de CLOCK-PRO
+ *
+ * @param marco Marco de la página (-1 = ya no está en memoria, sigue en período de prueba)
+ */
+typedef struct {
+    uint64_t clave;
+    int marco;
+    bool caliente;
+    bool en_prueba;
+    bool referenciada;
+    int anterior;
+    int siguiente;
+} t_nodo_clock_pro;
+
+static t_nodo_clock_pro* nodos;
+static int* nodos_libres;
+static int cantidad_nodos_libres;
+static int* nodo_de_marco;
+static t_indice_claves no_residentes;   // clave -> nodo de las páginas desalojadas en prueba
+static int mano_fria, mano_caliente, mano_prueba;
+static int cantidad_calientes, cantidad_no_residentes;
+static int objetivo_frias, minimo_frias, maximo_frias;
+
+static void clock_pro_inicializar(int marcos, const uint64_t* bits_modificado) {
+    cantidad_marcos = marcos;
+    int capacidad = 2 * marcos + 1;
+    nodos = malloc(capacidad * sizeof(t_nodo_clock_pro));
+    nodos_libres = malloc(capacidad * sizeof(int));
+    cantidad_nodos_libres = capacidad;
+    for (int i = 0; i < capacidad; i++) nodos_libres[i] = capacidad - 1 - i;
+    nodo_de_marco = malloc(marcos * sizeof(int));
+    for (int i = 0; i < marcos; i++) nodo_de_marco[i] = -1;
+    indice_crear(&no_residentes, marcos + 1);
+
+    mano_fria = mano_caliente = mano_prueba = -1;
+    cantidad_calientes = cantidad_no_residentes = 0;
+    minimo_frias = 1;
+    maximo_frias = marcos > 1 ? marcos - 1 : 1;
+    objetivo_frias = marcos / 2 > minimo_frias ? marcos / 2 : minimo_frias;
+}
+
+static void clock_pro_destruir() {
+    free(nodos);
+    free(nodos_libres);
+    free(nodo_de_marco);
+    indice_destruir(&no_residentes);
+}
+
+// Agrega el nodo en la cabeza del reloj: justo antes de la manecilla caliente (lo último que recorre)
+static void reloj_agregar(int nodo) {
+    if (mano_caliente == -1) {
+        nodos[nodo].anterior = nodos[nodo].siguiente = nodo;
+        mano_fria = mano_caliente = mano_prueba = nodo;
+        return;
+    }
+    int despues = mano_caliente;
+    int antes = nodos[despues].anterior;
+    nodos[nodo].anterior = antes;
+    nodos[nodo].siguiente = despues;
+    nodos[antes].siguiente = nodo;
+    nodos[despues].anterior = nodo;
+}
+
+static void reloj_sacar(int nodo) {
+    int proximo = nodos[nodo].siguiente;
+    if (proximo == nodo) {
+        mano_fria = mano_caliente = mano_prueba = -1;
+        return;
+    }
+    if (mano_fria == nodo) mano_fria = proximo;
+    if (mano_caliente == nodo) mano_caliente = proximo;
+    if (mano_prueba == nodo) mano_prueba = proximo;
+    nodos[nodos[nodo].anterior].siguiente = proximo;
+    nodos[proximo].anterior = nodos[nodo].anterior;
+}
+
+static void liberar_nodo(int nodo) {
+    reloj_sacar(nodo);
+    nodos_libres[cantidad_nodos_libres++] = nodo;
+}
+
+// Una prueba terminó sin que la página se volviera a pedir
+static void terminar_prueba(int nodo) {
+    nodos[nodo].en_prueba = false;
+    if (objetivo_frias > minimo_frias) objetivo_frias--;
+    if (nodos[nodo].marco == -1) {
+        indice_sacar(&no_residentes, nodos[nodo].clave);
+        liberar_nodo(nodo);
+        cantidad_no_residentes--;
+    }
+}
+
+// Manecilla caliente: enfría la primera página caliente sin uso (terminando las pruebas que pasa)
+static void correr_mano_caliente() {
+    while (cantidad_calientes > 0) {
+        int nodo = mano_caliente;
+        mano_caliente = nodos[nodo].siguiente;
+
+        if (nodos[nodo].caliente) {
+            if (nodos[nodo].referenciada) {
+                nodos[nodo].referenciada = false;
+            } else {
+                nodos[nodo].caliente = false;
+                cantidad_calientes--;
+                return;
+            }
+        } else if (nodos[nodo].en_prueba) {
+            terminar_prueba(nodo);
+        }
+    }
+}
+
+// Manecilla de prueba: poda páginas desalojadas hasta que haya a lo sumo una por marco
+static void correr_mano_prueba() {
+    while (cantidad_no_residentes > cantidad_marcos) {
+        int nodo = mano_prueba;
+        mano_prueba = nodos[nodo].siguiente;
+        if (!nodos[nodo].caliente && nodos[nodo].en_prueba) terminar_prueba(nodo);
+    }
+}
+
+static void pasar_a_caliente(int nodo) {
+    nodos[nodo].caliente = true;
+    nodos[nodo].en_prueba = false;
+    cantidad_calientes++;
+    if (objetivo_frias < maximo_frias) objetivo_frias++;
+    if (cantidad_calientes > cantidad_marcos - objetivo_frias) correr_mano_caliente();
+}
+
+static void clock_pro_al_acceder(int marco) {
+    nodos[nodo_de_marco[marco]].referenciada = true;
+}
+
+static void clock_pro_al_cargar(int marco, uint64_t clave) {
+    // Si estaba en prueba (desalojada hace poco) el nodo viejo se descarta y entra caliente
+    int nodo_previo = indice_buscar(&no_residentes, clave);
+    if (nodo_previo != -1) {
+        indice_sacar(&no_residentes, clave);
+        liberar_nodo(nodo_previo);
+        cantidad_no_residentes--;
+    }
+
+    int nodo = nodos_libres[--cantidad_nodos_libres];
+    nodos[nodo] = (t_nodo_clock_pro) { .clave = clave, .marco = marco, .caliente = false, .en_prueba = true, .referenciada = false };
+    nodo_de_marco[marco] = nodo;
+    reloj_agregar(nodo);
+
+    if (nodo_previo != -1) pasar_a_caliente(nodo);
+}
+
+static int clock_pro_elegir_victima(uint64_t clave_nueva) {
+    // Manecilla fría: la primera página fría en memoria sin uso
+    while (1) {
+        int nodo = mano_fria;
+        mano_fria = nodos[nodo].siguiente;
+        if (nodos[nodo].caliente || nodos[nodo].marco == -1) continue;
+
+        if (!nodos[nodo].referenciada) {
+            log_info(logger_worker, "## CLOCK-PRO Marco víctima: %d (calientes=%d, objetivo frías=%d)",
+                     nodos[nodo].marco, cantidad_calientes, objetivo_frias);
+            return nodos[nodo].marco;
+        }
+
+        // Usada: si estaba en prueba pasa a caliente; si no, empieza otra prueba. Va a la cabeza.
+        nodos[nodo].referenciada = false;
+        reloj_sacar(nodo);
+        reloj_agregar(nodo);
+        if (nodos[nodo].en_prueba) {
+            pasar_a_caliente(nodo);
+        } else {
+            nodos[nodo].en_prueba = true;
+        }
+    }
+}
+
+static void clock_pro_al_desalojar(int marco) {
+    int nodo = nodo_de_marco[marco];
+    nodo_de_marco[marco] = -1;
+    if (nodos[nodo].caliente) cantidad_calientes--;
+
+    // Una página fría en prueba se sigue recordando después de salir de memoria
+    if (!nodos[nodo].caliente && nodos[nodo].en_prueba) {
+        nodos[nodo].marco = -1;
+        indice_poner(&no_residentes, nodos[nodo].clave, nodo);
+        cantidad_no_residentes++;
+        correr_mano_prueba();
+    } else {
+        liberar_nodo(nodo);
+    }
+}
+
+static void clock_pro_al_descartar(int marco) {
+    int nodo = nodo_de_marco[marco];
+    nodo_de_marco[marco] = -1;
+    if (nodos[nodo].caliente) cantidad_calientes--;
+    liberar_nodo(nodo);
+}
+
+// ============================== Registro ==============================
+
+static const t_algoritmo_reemplazo algoritmos[] = {
+    { "LRU", lru_inicializar, lru_destruir, lru_al_acceder, lru_al_cargar, lru_elegir_victima, lru_al_desalojar, lru_al_desalojar },
+    { "CLOCK-M", clock_m_inicializar, clock_m_destruir, clock_m_al_acceder, clock_m_al_cargar, clock_m_elegir_victima, clock_m_al_desalojar, clock_m_al_desalojar },
+    { "ARC", arc_inicializar, arc_destruir, arc_al_acceder, arc_al_cargar, arc_elegir_victima, arc_al_desalojar, arc_al_descartar },
+    { "2Q", q2_inicializar, q2_destruir, q2_al_acceder, q2_al_cargar, q2_elegir_victima, q2_al_desalojar, q2_al_descartar },
+    { "CLOCK-PRO", clock_pro_inicializar, clock_pro_destruir, clock_pro_al_acceder, clock_pro_al_cargar, clock_pro_elegir_victima, clock_pro_al_desalojar, clock_pro_al_descartar },
+};
+
+const t_algoritmo_reemplazo* algoritmo_reemplazo_por_nombre(const char* nombre) {
+    for (size_t i = 0; i < sizeof(algoritmos) / sizeof(algoritmos[0]); i++) {
+        if (strcasecmp(algoritmos[i].nombre, nombre) == 0) return &algoritmos[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,39 @@
+#ifndef WORKER_REEMPLAZO_H
+#define WORKER_REEMPLAZO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @struct t_algoritmo_reemplazo
+ * @brief Algoritmo de reemplazo de páginas (ALGORITMO_REEMPLAZO), elegido una vez al inicializar la memoria
+ *
+ * La memoria avisa cada acceso, carga y desalojo; el algoritmo solo elige víctimas cuando no
+ * quedan marcos libres. Las páginas se identifican con una clave de 64 bits (File:Tag + página)
+ * para poder recordar páginas que ya no están en memoria (ARC, 2Q y CLOCK-PRO).
+ *
+ * @param inicializar Arma su estado para cantidad_marcos (bits_modificado es el bitset de la memoria)
+ * @param al_acceder Hit sobre la página del marco
+ * @param al_cargar La página con esa clave se cargó en el marco (después de un page fault)
+ * @param elegir_victima Marco a desalojar para cargar la página clave_nueva (todos los marcos ocupados)
+ * @param al_desalojar La página del marco sale de memoria (la recuerdan los algoritmos con historial)
+ * @param al_descartar La página del marco se descarta porque su File:Tag ya no existe (sin historial)
+ */
+typedef struct {
+    const char* nombre;
+    void (*inicializar)(int cantidad_marcos, const uint64_t* bits_modificado);
+    void (*destruir)();
+    void (*al_acceder)(int marco);
+    void (*al_cargar)(int marco, uint64_t clave);
+    int (*elegir_victima)(uint64_t clave_nueva);
+    void (*al_desalojar)(int marco);
+    void (*al_descartar)(int marco);
+} t_algoritmo_reemplazo;
+
+/**
+ * @brief Busca el algoritmo por nombre (LRU, CLOCK-M, ARC, 2Q o CLOCK-PRO, sin importar mayúsculas).
+ * @return El algoritmo, o NULL si no existe.
+ */
+const t_algoritmo_reemplazo* algoritmo_reemplazo_por_nombre(const char* nombre);
+
+#endif
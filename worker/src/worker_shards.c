@@ -0,0 +1,254 @@
+#include "worker_shards.h"
+#include "worker-configs.h"
+#include "worker-log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @struct t_punto_anillo
+ * @brief Punto del anillo: un File va al primer punto con hash >= al suyo (dando la vuelta)
+ */
+typedef struct {
+    uint32_t hash;
+    int shard;
+} t_punto_anillo;
+
+static t_shard* shards = NULL;
+static int cantidad_shards = 0;
+static t_punto_anillo* anillo = NULL;
+static int cantidad_puntos = 0;
+
+// Réplicas de solo lectura y los File:Tags ("FILE:TAG") que se sabe que no tienen
+static t_shard* replicas = NULL;
+static int cantidad_replicas = 0;
+static t_dictionary* ausentes_en_replicas = NULL;
+
+// FNV-1a de 32 bits
+static uint32_t hash_string(const char* str) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*) str; *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int comparar_puntos(const void* a, const void* b) {
+    uint32_t hash_a = ((const t_punto_anillo*) a)->hash;
+    uint32_t hash_b = ((const t_punto_anillo*) b)->hash;
+    return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+/**
+ * @brief Conexión y handshake con un Storage (envía el ID del Worker, recibe el BLOCK_SIZE).
+ * @return El socket, o -1 si falló.
+ */
+static int conectar_storage(t_shard* shard, uint32_t id_worker, uint32_t* block_size) {
+    int socket_storage = crear_conexion(shard->ip, shard->puerto);
+    if (socket_storage < 0) {
+        log_error(logger_worker, "Error al conectar con Storage %s:%s", shard->ip, shard->puerto);
+        return -1;
+    }
+    log_info(logger_worker, "Conectado a Storage %s:%s. Realizando handshake...", shard->ip, shard->puerto);
+
+    // 1. Enviar ID de Worker a Storage
+    t_buffer* buffer_id_storage = serializar_worker(id_worker);
+    t_paquete* paquete_handshake_storage = empaquetar_buffer(HANDSHAKE_WORKER, buffer_id_storage);
+    enviar_paquete(socket_storage, paquete_handshake_storage);
+
+    // 2. Recibir BLOCK_SIZE de Storage
+    t_paquete* rta_handshake_storage = recibir_paquete(socket_storage);
+    if (rta_handshake_storage == NULL || rta_handshake_storage->codigo_operacion != HANDSAHKE_STORAGE_RTA) {
+        log_error(logger_worker, "Error en handshake con Storage %s:%s. Storage desconectado.", shard->ip, shard->puerto);
+        if (rta_handshake_storage) liberar_paquete(rta_handshake_storage);
+        close(socket_storage);
+        return -1;
+    }
+    *block_size = buffer_read_uint32(rta_handshake_storage->buffer);
+    liberar_paquete(rta_handshake_storage);
+
+    log_info(logger_worker, "Handshake con Storage %s:%s OK. BLOCK_SIZE recibido: %d", shard->ip, shard->puerto, *block_size);
+    return socket_storage;
+}
+
+// "ip:puerto" -> t_shard sin conexión
+static void cargar_direccion(t_shard* shard, char* direccion) {
+    char** ip_puerto = string_split(direccion, ":");
+    shard->ip = strdup(ip_puerto[0]);
+    shard->puerto = strdup(ip_puerto[1] != NULL ? ip_puerto[1] : "");
+    shard->socket = -1;
+    shard->latenciams = 0;
+    string_array_destroy(ip_puerto);
+}
+
+// STORAGES=[ip:puerto,...]; sin la clave, un solo Storage (IP_STORAGE / PUERTO_STORAGE)
+static void cargar_shards() {
+    if (worker_configs.storages == NULL || string_array_size(worker_configs.storages) == 0) {
+        cantidad_shards = 1;
+        shards = calloc(1, sizeof(t_shard));
+        shards[0].ip = strdup(worker_configs.ipstorage);
+        shards[0].puerto = string_itoa(worker_configs.puertostorage);
+        shards[0].socket = -1;
+        return;
+    }
+
+    cantidad_shards = string_array_size(worker_configs.storages);
+    shards = calloc(cantidad_shards, sizeof(t_shard));
+    for (int i = 0; i < cantidad_shards; i++) cargar_direccion(&shards[i], worker_configs.storages[i]);
+}
+
+// REPLICAS_STORAGE=[ip:puerto,...]: réplicas del único Storage (con un cluster no se usan)
+static void conectar_replicas(uint32_t id_worker, uint32_t block_size) {
+    if (worker_configs.replicasstorage == NULL || string_array_size(worker_configs.replicasstorage) == 0) return;
+    if (cantidad_shards > 1) {
+        log_warning(logger_worker, "REPLICAS_STORAGE no se usa con un cluster de Storage (STORAGES).");
+        return;
+    }
+
+    cantidad_replicas = string_array_size(worker_configs.replicasstorage);
+    replicas = calloc(cantidad_replicas, sizeof(t_shard));
+    ausentes_en_replicas = dictionary_create();
+    for (int i = 0; i < cantidad_replicas; i++) {
+        cargar_direccion(&replicas[i], worker_configs.replicasstorage[i]);
+
+        uint32_t block_size_replica = 0;
+        replicas[i].socket = conectar_storage(&replicas[i], id_worker, &block_size_replica);
+        if (replicas[i].socket >= 0 && block_size_replica != block_size) {
+            log_warning(logger_worker, "Réplica %s:%s con BLOCK_SIZE %d (el Storage tiene %d): no se usa.", replicas[i].ip, replicas[i].puerto, block_size_replica, block_size);
+            shards_replica_caida(i);
+        } else if (replicas[i].socket < 0) {
+            log_warning(logger_worker, "Réplica %s:%s no disponible: se sigue sin ella.", replicas[i].ip, replicas[i].puerto);
+        }
+    }
+}
+
+// Los puntos salen de "ip:puerto#n": agregar o sacar un Storage solo mueve los Files de ese Storage
+static void armar_anillo() {
+    cantidad_puntos = cantidad_shards * NODOS_VIRTUALES_POR_SHARD;
+    anillo = malloc(sizeof(t_punto_anillo) * cantidad_puntos);
+    for (int s = 0; s < cantidad_shards; s++) {
+        for (int v = 0; v < NODOS_VIRTUALES_POR_SHARD; v++) {
+            char* nombre_punto = string_from_format("%s:%s#%d", shards[s].ip, shards[s].puerto, v);
+            anillo[s * NODOS_VIRTUALES_POR_SHARD + v] = (t_punto_anillo) { hash_string(nombre_punto), s };
+            free(nombre_punto);
+        }
+    }
+    qsort(anillo, cantidad_puntos, sizeof(t_punto_anillo), comparar_puntos);
+}
+
+static int shard_de_file(const char* nombre_file) {
+    if (cantidad_shards == 1) return 0;
+
+    // Búsqueda binaria del primer punto con hash >= hash del File
+    uint32_t hash = hash_string(nombre_file);
+    int desde = 0, hasta = cantidad_puntos;
+    while (desde < hasta) {
+        int medio = (desde + hasta) / 2;
+        if (anillo[medio].hash < hash) desde = medio + 1;
+        else hasta = medio;
+    }
+    return anillo[desde == cantidad_puntos ? 0 : desde].shard;
+}
+
+bool conectar_shards(uint32_t id_worker, uint32_t* block_size) {
+    cargar_shards();
+    for (int i = 0; i < cantidad_shards; i++) {
+        uint32_t block_size_shard = 0;
+        shards[i].socket = conectar_storage(&shards[i], id_worker, &block_size_shard);
+        if (shards[i].socket < 0) return false;
+
+        if (i > 0 && block_size_shard != *block_size) {
+            log_error(logger_worker, "Storage %s:%s tiene BLOCK_SIZE %d y el resto %d.", shards[i].ip, shards[i].puerto, block_size_shard, *block_size);
+            return false;
+        }
+        *block_size = block_size_shard;
+    }
+
+    armar_anillo();
+    if (cantidad_shards > 1) log_info(logger_worker, "Cluster de %d Storage: los Files se reparten por hashing consistente", cantidad_shards);
+    conectar_replicas(id_worker, *block_size);
+    return true;
+}
+
+void desconectar_shards() {
+    for (int i = 0; i < cantidad_shards; i++) {
+        if (shards[i].socket >= 0) close(shards[i].socket);
+        free(shards[i].ip);
+        free(shards[i].puerto);
+    }
+    free(shards);
+    free(anillo);
+    shards = NULL;
+    anillo = NULL;
+    cantidad_shards = 0;
+
+    for (int i = 0; i < cantidad_replicas; i++) {
+        if (replicas[i].socket >= 0) close(replicas[i].socket);
+        free(replicas[i].ip);
+        free(replicas[i].puerto);
+    }
+    free(replicas);
+    replicas = NULL;
+    cantidad_replicas = 0;
+    if (ausentes_en_replicas != NULL) dictionary_destroy(ausentes_en_replicas);
+    ausentes_en_replicas = NULL;
+}
+
+int shards_socket_de_file(const char* nombre_file) {
+    return shards[shard_de_file(nombre_file)].socket;
+}
+
+int shards_socket_principal() {
+    return shards[0].socket;
+}
+
+bool shards_mismo_shard(const char* nombre_file_a, const char* nombre_file_b) {
+    return shard_de_file(nombre_file_a) == shard_de_file(nombre_file_b);
+}
+
+int shards_elegir_replica(const char* nombre_file, const char* nombre_tag) {
+    if (cantidad_replicas == 0) return -1;
+
+    char* file_tag = string_from_format("%s:%s", nombre_file, nombre_tag);
+    bool ausente = dictionary_has_key(ausentes_en_replicas, file_tag);
+    free(file_tag);
+    if (ausente) return -1;
+
+    // La menos cargada: la de menor latencia promedio (las que todavía no se midieron van primero)
+    int elegida = -1;
+    for (int i = 0; i < cantidad_replicas; i++) {
+        if (replicas[i].socket < 0) continue;
+        if (elegida == -1 || replicas[i].latenciams < replicas[elegida].latenciams) elegida = i;
+    }
+    return elegida;
+}
+
+int shards_socket_replica(int replica) {
+    return replicas[replica].socket;
+}
+
+void shards_replica_respondio(int replica, double latencia_ms) {
+    replicas[replica].latenciams = replicas[replica].latenciams == 0 ? latencia_ms :
+        PESO_LATENCIA_REPLICA * latencia_ms + (1 - PESO_LATENCIA_REPLICA) * replicas[replica].latenciams;
+}
+
+void shards_replica_no_tiene(const char* nombre_file, const char* nombre_tag) {
+    if (ausentes_en_replicas == NULL) return;
+    char* file_tag = string_from_format("%s:%s", nombre_file, nombre_tag);
+    dictionary_put(ausentes_en_replicas, file_tag, NULL);
+    free(file_tag);
+}
+
+void shards_replica_puede_tener(const char* nombre_file, const char* nombre_tag) {
+    if (ausentes_en_replicas == NULL) return;
+    char* file_tag = string_from_format("%s:%s", nombre_file, nombre_tag);
+    if (dictionary_has_key(ausentes_en_replicas, file_tag)) dictionary_remove(ausentes_en_replicas, file_tag);
+    free(file_tag);
+}
+
+void shards_replica_caida(int replica) {
+    log_warning(logger_worker, "Réplica %s:%s desconectada: sus lecturas van al Storage.", replicas[replica].ip, replicas[replica].puerto);
+    close(replicas[replica].socket);
+    replicas[replica].socket = -1;
+}
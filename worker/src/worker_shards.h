@@ -0,0 +1,92 @@
+#ifndef WORKER_SHARDS_H
+#define WORKER_SHARDS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <commons/string.h>
+#include <commons/collections/dictionary.h>
+#include <utils/sockets.h>
+#include <utils/serializacion.h>
+
+// Puntos de cada Storage en el anillo de hashing consistente
+#define NODOS_VIRTUALES_POR_SHARD 64
+
+// Peso de la última lectura en la latencia promedio de una réplica
+#define PESO_LATENCIA_REPLICA 0.2
+
+/**
+ * @struct t_shard
+ * @brief Un proceso Storage del cluster (o una réplica) y la conexión del Worker con él
+ *
+ * @param socket -1 si no hay conexión
+ * @param latenciams Solo réplicas: promedio móvil de lo que tarda un READ (mide la carga)
+ */
+typedef struct {
+    char* ip;
+    char* puerto;
+    int socket;
+    double latenciams;
+} t_shard;
+
+/**
+ * @brief Se conecta y hace el handshake con cada Storage (STORAGES, o IP_STORAGE /
+ * PUERTO_STORAGE si no está) y arma el anillo de hashing consistente.
+ * Todos los Storage tienen que tener el mismo BLOCK_SIZE.
+ * También se conecta a las réplicas de REPLICAS_STORAGE (si alguna no responde, se sigue sin ella).
+ * @param block_size Se completa con el BLOCK_SIZE de los Storage
+ * @return false si alguno no respondió.
+ */
+bool conectar_shards(uint32_t id_worker, uint32_t* block_size);
+
+/**
+ * @brief Cierra las conexiones con los Storage.
+ */
+void desconectar_shards();
+
+/**
+ * @brief Socket del Storage dueño del File (cada File vive entero en un solo Storage).
+ */
+int shards_socket_de_file(const char* nombre_file);
+
+/**
+ * @brief Socket del primer Storage (con uno solo, el de siempre).
+ */
+int shards_socket_principal();
+
+/**
+ * @brief true si los dos Files caen en el mismo Storage.
+ */
+bool shards_mismo_shard(const char* nombre_file_a, const char* nombre_file_b);
+
+/**
+ * @brief Réplica a la que mandar un READ de ese File:Tag: la de menor latencia promedio.
+ * @return El índice de la réplica, o -1 si no hay réplicas o ya se sabe que no lo tienen.
+ */
+int shards_elegir_replica(const char* nombre_file, const char* nombre_tag);
+
+/**
+ * @brief Socket de la réplica.
+ */
+int shards_socket_replica(int replica);
+
+/**
+ * @brief Suma una lectura a la latencia promedio de la réplica.
+ */
+void shards_replica_respondio(int replica, double latencia_ms);
+
+/**
+ * @brief La réplica no tiene el File:Tag (no está COMMITED): sus READ van al Storage primario.
+ */
+void shards_replica_no_tiene(const char* nombre_file, const char* nombre_tag);
+
+/**
+ * @brief El File:Tag se commiteó: se vuelve a probar en las réplicas.
+ */
+void shards_replica_puede_tener(const char* nombre_file, const char* nombre_tag);
+
+/**
+ * @brief La réplica se desconectó: no se usa más.
+ */
+void shards_replica_caida(int replica);
+
+#endif